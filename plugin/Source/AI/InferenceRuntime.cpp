@@ -0,0 +1,158 @@
+#include "InferenceRuntime.h"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+#ifdef ONNX_RUNTIME_AVAILABLE
+#include <onnxruntime_cxx_api.h>
+#else
+namespace Ort {
+    // Placeholders so the runtime still builds (and schedules) without ONNX Runtime
+    class Env {};
+    class SessionOptions {};
+}
+#endif
+
+namespace blink {
+
+namespace {
+
+std::mutex sharedLock;
+std::weak_ptr<InferenceRuntime> sharedRuntime;
+InferenceRuntime::Options sharedOptions;
+
+} // namespace
+
+InferenceRuntime::InferenceRuntime(const Options& options)
+    : hasGlobalThreadPools(false), nextTicket(0), activeRuns(0),
+      maxConcurrentRuns(std::max(1, options.maxConcurrentRuns)) {
+    #ifdef ONNX_RUNTIME_AVAILABLE
+    const int cores = (int)std::max(1u, std::thread::hardware_concurrency());
+    const int intraOpThreads = options.intraOpThreads > 0 ? options.intraOpThreads
+                                                          : std::max(1, cores / 2);
+    
+    try {
+        // One set of worker threads for every session in the process
+        Ort::ThreadingOptions threadingOptions;
+        threadingOptions.SetGlobalIntraOpNumThreads(intraOpThreads);
+        threadingOptions.SetGlobalInterOpNumThreads(1);
+        
+        env = std::make_unique<Ort::Env>(threadingOptions, ORT_LOGGING_LEVEL_WARNING, "VocalSuiteAI");
+        hasGlobalThreadPools = true;
+    } catch (const Ort::Exception& e) {
+        // Fall back to per-session pools rather than no inference at all
+        std::cerr << "ONNX Runtime global thread pools unavailable: " << e.what() << std::endl;
+        env = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "VocalSuiteAI");
+    }
+    #endif
+}
+
+InferenceRuntime::~InferenceRuntime() = default;
+
+std::shared_ptr<InferenceRuntime> InferenceRuntime::getShared() {
+    std::lock_guard<std::mutex> guard(sharedLock);
+    
+    std::shared_ptr<InferenceRuntime> runtime = sharedRuntime.lock();
+    if (runtime == nullptr) {
+        runtime.reset(new InferenceRuntime(sharedOptions));
+        sharedRuntime = runtime;
+    }
+    return runtime;
+}
+
+void InferenceRuntime::configure(const Options& options) {
+    std::shared_ptr<InferenceRuntime> runtime;
+    
+    {
+        std::lock_guard<std::mutex> guard(sharedLock);
+        sharedOptions = options;
+        runtime = sharedRuntime.lock();
+    }
+    
+    if (runtime != nullptr) {
+        runtime->setMaxConcurrentRuns(options.maxConcurrentRuns);
+    }
+}
+
+void InferenceRuntime::applySessionOptions(Ort::SessionOptions& sessionOptions) const {
+    #ifdef ONNX_RUNTIME_AVAILABLE
+    if (hasGlobalThreadPools) {
+        sessionOptions.DisablePerSessionThreads();
+    } else {
+        sessionOptions.SetIntraOpNumThreads(4);
+    }
+    #else
+    (void)sessionOptions;
+    #endif
+}
+
+void InferenceRuntime::setMaxConcurrentRuns(int maxRuns) {
+    {
+        std::lock_guard<std::mutex> guard(schedulerLock);
+        maxConcurrentRuns = std::max(1, maxRuns);
+    }
+    slotFreed.notify_all();
+}
+
+int InferenceRuntime::getMaxConcurrentRuns() const {
+    std::lock_guard<std::mutex> guard(schedulerLock);
+    return maxConcurrentRuns;
+}
+
+int InferenceRuntime::getNumActiveRuns() const {
+    std::lock_guard<std::mutex> guard(schedulerLock);
+    return activeRuns;
+}
+
+int InferenceRuntime::getNumWaitingRuns() const {
+    std::lock_guard<std::mutex> guard(schedulerLock);
+    return (int)waiting.size();
+}
+
+bool InferenceRuntime::isNextInLine(uint64_t ticket) const {
+    // Highest priority first, then first come first served
+    auto best = std::min_element(waiting.begin(), waiting.end(), [](const Waiter& a, const Waiter& b) {
+        if (a.priority != b.priority) {
+            return a.priority < b.priority;
+        }
+        return a.ticket < b.ticket;
+    });
+    return best != waiting.end() && best->ticket == ticket;
+}
+
+void InferenceRuntime::acquireSlot(Priority priority) {
+    std::unique_lock<std::mutex> guard(schedulerLock);
+    
+    const uint64_t ticket = nextTicket++;
+    waiting.push_back({ priority, ticket });
+    
+    slotFreed.wait(guard, [&] {
+        return activeRuns < maxConcurrentRuns && isNextInLine(ticket);
+    });
+    
+    waiting.erase(std::find_if(waiting.begin(), waiting.end(),
+                               [ticket](const Waiter& w) { return w.ticket == ticket; }));
+    activeRuns++;
+    
+    // More slots may be free for whoever is next
+    slotFreed.notify_all();
+}
+
+void InferenceRuntime::releaseSlot() {
+    {
+        std::lock_guard<std::mutex> guard(schedulerLock);
+        activeRuns--;
+    }
+    slotFreed.notify_all();
+}
+
+InferenceRuntime::ScopedRunSlot::ScopedRunSlot(InferenceRuntime& runtime, Priority priority)
+    : runtime(runtime) {
+    runtime.acquireSlot(priority);
+}
+
+InferenceRuntime::ScopedRunSlot::~ScopedRunSlot() {
+    runtime.releaseSlot();
+}
+
+} // namespace blink
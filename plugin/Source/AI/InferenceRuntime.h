@@ -0,0 +1,105 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Ort {
+    class Env;
+    class SessionOptions;
+}
+
+namespace blink {
+
+/**
+ * Process-wide ONNX Runtime state shared by every plugin instance.
+ *
+ * Owns the single Ort::Env, created with global intra/inter-op thread pools
+ * that all sessions use instead of spinning up their own, and schedules Run
+ * calls across instances: at most a configurable number run at once, and
+ * interactive work (previews, live processing) is admitted ahead of batch
+ * renders.
+ *
+ * The runtime lives as long as anything holds the pointer returned by
+ * getShared(). Loaded models hold it, so it is created with the first model
+ * in the process and goes with the last one.
+ */
+class InferenceRuntime {
+public:
+    enum class Priority {
+        Interactive, // Someone is waiting to hear it
+        Batch        // Offline renders, benchmarks
+    };
+
+    struct Options {
+        int intraOpThreads = 0;     // Global pool size; 0 = half the cores
+        int maxConcurrentRuns = 2;  // Runs admitted at once across all instances
+    };
+
+    /**
+     * Holds one run slot for its lifetime; construct it around Session::Run.
+     */
+    class ScopedRunSlot {
+    public:
+        ScopedRunSlot(InferenceRuntime& runtime, Priority priority);
+        ~ScopedRunSlot();
+
+        ScopedRunSlot(const ScopedRunSlot&) = delete;
+        ScopedRunSlot& operator=(const ScopedRunSlot&) = delete;
+
+    private:
+        InferenceRuntime& runtime;
+    };
+
+    ~InferenceRuntime();
+
+    /** The shared runtime, created on first use. */
+    static std::shared_ptr<InferenceRuntime> getShared();
+
+    /**
+     * Options for the runtime. Thread pool settings take effect when the
+     * runtime is (re)created; the concurrency limit applies immediately.
+     */
+    static void configure(const Options& options);
+
+    /** Null when ONNX Runtime isn't available in this build. */
+    Ort::Env* getEnv() const { return env.get(); }
+
+    /** Point a session at the shared thread pools. */
+    void applySessionOptions(Ort::SessionOptions& sessionOptions) const;
+
+    void setMaxConcurrentRuns(int maxRuns);
+    int getMaxConcurrentRuns() const;
+
+    /** Runs in progress and waiting, for diagnostics. */
+    int getNumActiveRuns() const;
+    int getNumWaitingRuns() const;
+
+private:
+    InferenceRuntime(const Options& options);
+
+    void acquireSlot(Priority priority);
+    void releaseSlot();
+
+    std::unique_ptr<Ort::Env> env;
+    bool hasGlobalThreadPools;
+
+    // Scheduler: waiters are admitted in (priority, arrival) order
+    struct Waiter {
+        Priority priority;
+        uint64_t ticket;
+    };
+
+    mutable std::mutex schedulerLock;
+    std::condition_variable slotFreed;
+    std::vector<Waiter> waiting;
+    uint64_t nextTicket;
+    int activeRuns;
+    int maxConcurrentRuns;
+
+    bool isNextInLine(uint64_t ticket) const;
+};
+
+} // namespace blink
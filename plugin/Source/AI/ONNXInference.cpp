@@ -1,6 +1,13 @@
 #include "ONNXInference.h"
+#include "InferenceRuntime.h"
+#include "../Core/ModelCatalog.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <sys/stat.h>
 
 // NOTE: To compile this, you need to:
 // 1. Download ONNX Runtime from https://github.com/microsoft/onnxruntime/releases
@@ -19,151 +26,525 @@
 
 namespace blink {
 
-ONNXInference::ONNXInference() 
-    : session(nullptr), env(nullptr), isModelLoaded(false), expectedMelBands(80) {
+namespace {
+
+#ifdef ONNX_RUNTIME_AVAILABLE
+// Bound tensors for one (batch size, frames) shape, reused run after run
+struct BindingContext {
+    std::unique_ptr<Ort::IoBinding> binding;
+    
+    int64_t f0Shape[2] = {};
+    int64_t melShape[3] = {};
+    std::vector<int64_t> outputShape;
+    size_t outputLength = 0; // Samples per item, learned on the first run
+    
+    Ort::Value f0Tensor { nullptr };
+    Ort::Value melTensor { nullptr };
+    Ort::Value outputTensor { nullptr };
+    
+    // What the tensors currently wrap, so rebinding only happens when buffers move
+    const float* boundF0 = nullptr;
+    const float* boundMel = nullptr;
+    float* boundOutput = nullptr;
+    
+    // Used when the caller's layout doesn't match the model's output
+    std::vector<float> outputBuffer;
+};
+
+// One engine's contexts on a model, per (batch size, frames); runLock serialises their use
+struct EngineContexts {
+    std::mutex runLock;
+    std::map<std::pair<int, int>, std::unique_ptr<BindingContext>> contexts;
+};
+#endif
+
+} // namespace
+
+struct ONNXInference::LoadedModel {
+    // Keeps the shared environment alive for as long as the session exists
+    std::shared_ptr<InferenceRuntime> runtime;
+    
     #ifdef ONNX_RUNTIME_AVAILABLE
-    env = new Ort::Env(ORT_LOGGING_LEVEL_WARNING, "VocalSuiteAI");
-    std::cout << "ONNX Runtime initialized" << std::endl;
-    #else
-    std::cout << "ONNX Runtime not available - AI voice cloning disabled" << std::endl;
-    std::cout << "To enable: Download ONNX Runtime and update CMakeLists.txt" << std::endl;
+    std::unique_ptr<Ort::Session> session;
+    Ort::MemoryInfo memoryInfo { nullptr };
+    
+    // The session is shared between instances, but each engine binds its own
+    // tensors, so one instance's runs never queue behind another's
+    std::mutex engineLock;
+    std::map<const ONNXInference*, std::shared_ptr<EngineContexts>> engines;
+    
+    std::shared_ptr<EngineContexts> getEngineContexts(const ONNXInference* engine) {
+        std::lock_guard<std::mutex> guard(engineLock);
+        auto& contexts = engines[engine];
+        if (contexts == nullptr) {
+            contexts = std::make_shared<EngineContexts>();
+        }
+        return contexts;
+    }
     #endif
+    
+    // Drop an engine's contexts; a run in progress keeps its own reference
+    void forgetEngine(const ONNXInference* engine) {
+        #ifdef ONNX_RUNTIME_AVAILABLE
+        std::lock_guard<std::mutex> guard(engineLock);
+        engines.erase(engine);
+        #else
+        (void)engine;
+        #endif
+    }
+    
+    std::vector<std::string> inputNames;
+    std::vector<std::string> outputNames;
+    std::vector<const char*> inputNamePtrs;  // Point into inputNames
+    std::vector<const char*> outputNamePtrs; // Point into outputNames
+    std::string modelPath;
+    bool hasDynamicBatch = false;
+    int sampleRate = 0; // Native rate of the audio it produces, 0 if unknown
+    
+    // Benchmarked batch size per (sequence length in frames, largest size tried)
+    std::mutex benchmarkLock;
+    std::map<std::pair<int, int>, int> bestBatchSizes;
+};
+
+ONNXInference::ONNXInference() 
+    : expectedMelBands(80),
+      priority(InferenceRuntime::Priority::Batch), poolCapacity(3),
+      hasPendingLoad(false), stopLoader(false) {
+    // The shared runtime (and its Ort::Env) is only created when a model loads,
+    // so instances that never use a model don't pay for it
 }
 
 ONNXInference::~ONNXInference() {
-    #ifdef ONNX_RUNTIME_AVAILABLE
-    delete session;
-    delete env;
-    #endif
+    {
+        std::lock_guard<std::mutex> guard(loaderLock);
+        stopLoader = true;
+    }
+    loaderCondition.notify_all();
+    if (loaderThread.joinable()) {
+        loaderThread.join();
+    }
+    
+    // Each model holds the runtime, so sessions always go before the shared environment
+    setActiveModel(nullptr);
+    for (auto& model : sessionPool) {
+        model->forgetEngine(this);
+    }
+    sessionPool.clear();
+}
+
+std::shared_ptr<ONNXInference::LoadedModel> ONNXInference::getActiveModel() const {
+    const juce::SpinLock::ScopedLockType guard(activeModelLock);
+    return activeModel;
+}
+
+void ONNXInference::setActiveModel(std::shared_ptr<LoadedModel> model) {
+    {
+        const juce::SpinLock::ScopedLockType guard(activeModelLock);
+        activeModel.swap(model);
+    }
+    
+    // model now holds the previous one, released here outside the lock
 }
 
 bool ONNXInference::loadModel(const std::string& modelPath) {
+    // Already pooled: promote it and swap it in
+    {
+        std::lock_guard<std::mutex> guard(poolLock);
+        for (auto it = sessionPool.begin(); it != sessionPool.end(); ++it) {
+            if ((*it)->modelPath == modelPath) {
+                sessionPool.splice(sessionPool.begin(), sessionPool, it);
+                setActiveModel(sessionPool.front());
+                return true;
+            }
+        }
+    }
+    
+    // Build and warm up outside any lock; the current model keeps serving meanwhile
+    std::shared_ptr<LoadedModel> model = acquireModel(modelPath);
+    if (model == nullptr) {
+        return false;
+    }
+    
+    std::shared_ptr<LoadedModel> evicted;
+    {
+        std::lock_guard<std::mutex> guard(poolLock);
+        sessionPool.push_front(model);
+        if (sessionPool.size() > poolCapacity) {
+            // Destroyed below, after the lock; any Run still using it holds its own reference
+            evicted = sessionPool.back();
+            sessionPool.pop_back();
+        }
+        setActiveModel(model);
+    }
+    
+    if (evicted != nullptr) {
+        evicted->forgetEngine(this);
+    }
+    
+    return true;
+}
+
+void ONNXInference::loadModelAsync(const std::string& modelPath, LoadCallback onLoaded) {
+    LoadCallback superseded;
+    std::string supersededPath;
+    
+    {
+        std::lock_guard<std::mutex> guard(loaderLock);
+        
+        if (hasPendingLoad) {
+            superseded = std::move(pendingCallback);
+            supersededPath = std::move(pendingPath);
+        }
+        
+        pendingPath = modelPath;
+        pendingCallback = std::move(onLoaded);
+        hasPendingLoad = true;
+        
+        if (!loaderThread.joinable()) {
+            loaderThread = std::thread([this] { runLoader(); });
+        }
+    }
+    
+    loaderCondition.notify_one();
+    
+    if (superseded) {
+        superseded(false, supersededPath);
+    }
+}
+
+void ONNXInference::runLoader() {
+    for (;;) {
+        std::string path;
+        LoadCallback callback;
+        
+        {
+            std::unique_lock<std::mutex> guard(loaderLock);
+            loaderCondition.wait(guard, [this] { return stopLoader || hasPendingLoad; });
+            
+            if (stopLoader) {
+                return;
+            }
+            
+            path = std::move(pendingPath);
+            callback = std::move(pendingCallback);
+            hasPendingLoad = false;
+        }
+        
+        const bool success = loadModel(path);
+        
+        if (callback) {
+            callback(success, path);
+        }
+    }
+}
+
+void ONNXInference::setPoolCapacity(int numSessions) {
+    std::list<std::shared_ptr<LoadedModel>> evicted;
+    
+    std::lock_guard<std::mutex> guard(poolLock);
+    poolCapacity = (size_t)std::max(1, numSessions);
+    while (sessionPool.size() > poolCapacity) {
+        sessionPool.back()->forgetEngine(this);
+        evicted.push_back(sessionPool.back());
+        sessionPool.pop_back();
+    }
+}
+
+void ONNXInference::releaseModel(const std::string& modelPath) {
+    std::shared_ptr<LoadedModel> released;
+    
+    std::lock_guard<std::mutex> guard(poolLock);
+    std::shared_ptr<LoadedModel> active = getActiveModel();
+    for (auto it = sessionPool.begin(); it != sessionPool.end(); ++it) {
+        if ((*it)->modelPath == modelPath && *it != active) {
+            released = *it;
+            released->forgetEngine(this);
+            sessionPool.erase(it);
+            break;
+        }
+    }
+}
+
+std::shared_ptr<ONNXInference::LoadedModel> ONNXInference::acquireModel(const std::string& modelPath) {
+    // Sessions are shared between plugin instances, per model file version
+    static std::mutex registryLock;
+    static std::map<std::string, std::weak_ptr<LoadedModel>> registry;
+    
+    std::string key = modelPath;
+    struct stat info;
+    if (stat(modelPath.c_str(), &info) == 0) {
+        key += "@" + std::to_string((long long)info.st_size) + ":" + std::to_string((long long)info.st_mtime);
+    }
+    
+    {
+        std::lock_guard<std::mutex> guard(registryLock);
+        if (auto existing = registry[key].lock()) {
+            return existing;
+        }
+    }
+    
+    // Built outside the lock so loading one model doesn't hold up another
+    std::shared_ptr<LoadedModel> model = createModel(modelPath);
+    if (model == nullptr) {
+        return nullptr;
+    }
+    
+    std::lock_guard<std::mutex> guard(registryLock);
+    
+    // Another instance may have finished the same model meanwhile; keep theirs
+    if (auto existing = registry[key].lock()) {
+        return existing;
+    }
+    
+    // Drop entries whose sessions are gone
+    for (auto it = registry.begin(); it != registry.end();) {
+        it = it->second.expired() ? registry.erase(it) : std::next(it);
+    }
+    
+    registry[key] = model;
+    return model;
+}
+
+std::shared_ptr<ONNXInference::LoadedModel> ONNXInference::createModel(const std::string& modelPath) {
     #ifdef ONNX_RUNTIME_AVAILABLE
+    std::shared_ptr<InferenceRuntime> runtime = InferenceRuntime::getShared();
+    if (runtime->getEnv() == nullptr) {
+        return nullptr;
+    }
+    
     try {
         // Check if file exists
         std::ifstream file(modelPath);
         if (!file.good()) {
             std::cerr << "Model file not found: " << modelPath << std::endl;
-            return false;
+            return nullptr;
         }
         file.close();
         
-        // Configure session options
+        // Configure session options; threads come from the shared pools
         Ort::SessionOptions sessionOptions;
-        sessionOptions.SetIntraOpNumThreads(4); // Use 4 threads for inference
+        runtime->applySessionOptions(sessionOptions);
         sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
         
         // Enable CPU optimizations
         sessionOptions.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
         
+        auto model = std::make_shared<LoadedModel>();
+        model->runtime = runtime;
+        
         // Create session
-        session = new Ort::Session(*env, modelPath.c_str(), sessionOptions);
+        model->session = std::make_unique<Ort::Session>(*runtime->getEnv(), modelPath.c_str(), sessionOptions);
         
         // Get input/output names and shapes
         Ort::AllocatorWithDefaultOptions allocator;
         
         // Input info
-        size_t numInputNodes = session->GetInputCount();
-        inputNames.clear();
+        size_t numInputNodes = model->session->GetInputCount();
         for (size_t i = 0; i < numInputNodes; i++) {
-            auto inputName = session->GetInputNameAllocated(i, allocator);
-            inputNames.push_back(inputName.get());
+            auto inputName = model->session->GetInputNameAllocated(i, allocator);
+            model->inputNames.push_back(inputName.get());
             std::cout << "Input " << i << ": " << inputName.get() << std::endl;
         }
         
         // Output info
-        size_t numOutputNodes = session->GetOutputCount();
-        outputNames.clear();
+        size_t numOutputNodes = model->session->GetOutputCount();
         for (size_t i = 0; i < numOutputNodes; i++) {
-            auto outputName = session->GetOutputNameAllocated(i, allocator);
-            outputNames.push_back(outputName.get());
+            auto outputName = model->session->GetOutputNameAllocated(i, allocator);
+            model->outputNames.push_back(outputName.get());
             std::cout << "Output " << i << ": " << outputName.get() << std::endl;
         }
         
-        this->modelPath = modelPath;
-        isModelLoaded = true;
+        // A symbolic or -1 leading dimension means the model takes any batch size
+        auto firstInputShape = model->session->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        model->hasDynamicBatch = !firstInputShape.empty() && firstInputShape[0] < 0;
+        if (model->inputNames.size() < 2 || model->outputNames.empty()) {
+            std::cerr << "Model needs F0 and mel inputs and an audio output: " << modelPath << std::endl;
+            return nullptr;
+        }
+        
+        // Everything a run needs is built here once, not per call
+        for (const auto& name : model->inputNames) {
+            model->inputNamePtrs.push_back(name.c_str());
+        }
+        for (const auto& name : model->outputNames) {
+            model->outputNamePtrs.push_back(name.c_str());
+        }
+        model->memoryInfo = Ort::MemoryInfo::CreateCpu(
+            OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
+        
+        model->modelPath = modelPath;
+        
+        // Native rate from the model's metadata, else from its file name
+        Ort::ModelMetadata metadata = model->session->GetModelMetadata();
+        for (const char* key : { "sample_rate", "sampling_rate", "sr" }) {
+            auto value = metadata.LookupCustomMetadataMapAllocated(key, allocator);
+            if (value != nullptr) {
+                model->sampleRate = std::max(0, std::atoi(value.get()));
+                break;
+            }
+        }
+        if (model->sampleRate == 0) {
+            model->sampleRate = ModelCatalog::getSampleRateFromFileName(modelPath);
+        }
+        
+        warmUp(*model);
         
         std::cout << "AI Model loaded successfully: " << modelPath << std::endl;
         std::cout << "Inputs: " << numInputNodes << ", Outputs: " << numOutputNodes << std::endl;
         
-        return true;
+        return model;
         
     } catch (const Ort::Exception& e) {
         std::cerr << "ONNX Runtime error: " << e.what() << std::endl;
-        isModelLoaded = false;
-        return false;
+        return nullptr;
     }
     #else
     std::cerr << "ONNX Runtime not available - cannot load model" << std::endl;
-    return false;
+    std::cerr << "To enable: Download ONNX Runtime and update CMakeLists.txt" << std::endl;
+    (void)modelPath;
+    return nullptr;
     #endif
 }
 
+void ONNXInference::warmUp(LoadedModel& model) {
+    // One short run builds kernels and grows the arena before the model goes live,
+    // so the first real conversion doesn't pay for it
+    const int numFrames = 32;
+    std::vector<float> f0(numFrames, 220.0f);
+    std::vector<float> mel((size_t)numFrames * expectedMelBands, -4.0f);
+    std::vector<float> out((size_t)numFrames * 512);
+    
+    runBatch(model, f0.data(), mel.data(), 1, numFrames, expectedMelBands, out.data(), (int)out.size());
+}
+
 int ONNXInference::processOffline(const float* f0, const float* melSpec,
                                   int numFrames, int numMelBands,
                                   float* output, int outputSize) {
-    #ifdef ONNX_RUNTIME_AVAILABLE
-    if (!isModelLoaded) {
+    return processBatch(f0, melSpec, 1, numFrames, numMelBands, output, outputSize);
+}
+
+int ONNXInference::processBatch(const float* f0, const float* melSpec,
+                                int batchSize, int numFrames, int numMelBands,
+                                float* output, int outputStride) {
+    // Hold our own reference: a concurrent swap can't pull the session out from under this run
+    std::shared_ptr<LoadedModel> model = getActiveModel();
+    if (model == nullptr) {
         std::cerr << "No model loaded" << std::endl;
         // Pass through unchanged
         return 0;
     }
     
+    return runBatch(*model, f0, melSpec, batchSize, numFrames, numMelBands, output, outputStride);
+}
+
+int ONNXInference::runBatch(LoadedModel& model, const float* f0, const float* melSpec,
+                            int batchSize, int numFrames, int numMelBands,
+                            float* output, int outputStride) {
+    #ifdef ONNX_RUNTIME_AVAILABLE
+    if (batchSize > 1 && !model.hasDynamicBatch) {
+        // Fixed batch dimension: one run per item
+        int generated = outputStride;
+        for (int b = 0; b < batchSize; b++) {
+            int samples = runBatch(model, f0 + (size_t)b * numFrames,
+                                   melSpec + (size_t)b * numFrames * numMelBands,
+                                   1, numFrames, numMelBands,
+                                   output + (size_t)b * outputStride, outputStride);
+            if (samples <= 0) {
+                return 0;
+            }
+            generated = std::min(generated, samples);
+        }
+        return generated;
+    }
+    
     try {
-        // Create ONNX tensors
-        Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(
-            OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
-        
-        // Input 1: F0 curve (shape: [1, numFrames])
-        std::vector<int64_t> f0Shape = {1, numFrames};
-        Ort::Value f0Tensor = Ort::Value::CreateTensor<float>(
-            memoryInfo, const_cast<float*>(f0), numFrames, f0Shape.data(), f0Shape.size());
+        // This engine's contexts first, then admission across all instances, so a
+        // run never holds a scheduler slot while it waits for its contexts
+        std::shared_ptr<EngineContexts> engine = model.getEngineContexts(this);
+        std::lock_guard<std::mutex> guard(engine->runLock);
+        InferenceRuntime::ScopedRunSlot runSlot(*model.runtime, priority.load());
         
-        // Input 2: Mel-spectrogram (shape: [1, numMelBands, numFrames])
-        std::vector<int64_t> melShape = {1, numMelBands, numFrames};
-        Ort::Value melTensor = Ort::Value::CreateTensor<float>(
-            memoryInfo, const_cast<float*>(melSpec), numFrames * numMelBands,
-            melShape.data(), melShape.size());
-        
-        // Prepare inputs
-        std::vector<Ort::Value> inputTensors;
-        inputTensors.push_back(std::move(f0Tensor));
-        inputTensors.push_back(std::move(melTensor));
+        auto& contexts = engine->contexts;
+        auto& slot = contexts[{ batchSize, numFrames }];
+        if (slot == nullptr) {
+            // Bounded: chunked conversion only ever uses a couple of shapes
+            if (contexts.size() > maxContextsPerModel) {
+                contexts.clear();
+            }
+            
+            auto context = std::make_unique<BindingContext>();
+            context->binding = std::make_unique<Ort::IoBinding>(*model.session);
+            context->f0Shape[0] = batchSize;
+            context->f0Shape[1] = numFrames;
+            context->melShape[0] = batchSize;
+            context->melShape[melBandsAxis] = numMelBands;
+            context->melShape[melFramesAxis] = numFrames;
+            contexts[{ batchSize, numFrames }] = std::move(context);
+        }
+        BindingContext& context = *contexts[{ batchSize, numFrames }];
         
-        // Prepare input/output names
-        std::vector<const char*> inputNamesCStr;
-        for (const auto& name : inputNames) {
-            inputNamesCStr.push_back(name.c_str());
+        // Inputs wrap the caller's buffers (no copy); rebind only when they move
+        if (context.boundF0 != f0) {
+            // Input 1: F0 curves (shape: [batchSize, numFrames])
+            context.f0Tensor = Ort::Value::CreateTensor<float>(
+                model.memoryInfo, const_cast<float*>(f0), (size_t)batchSize * numFrames,
+                context.f0Shape, 2);
+            context.binding->BindInput(model.inputNamePtrs[0], context.f0Tensor);
+            context.boundF0 = f0;
         }
         
-        std::vector<const char*> outputNamesCStr;
-        for (const auto& name : outputNames) {
-            outputNamesCStr.push_back(name.c_str());
+        if (context.boundMel != melSpec) {
+            // Input 2: Mel-spectrograms (shape: [batchSize, numMelBands, numFrames])
+            context.melTensor = Ort::Value::CreateTensor<float>(
+                model.memoryInfo, const_cast<float*>(melSpec), (size_t)batchSize * numFrames * numMelBands,
+                context.melShape, 3);
+            context.binding->BindInput(model.inputNamePtrs[1], context.melTensor);
+            context.boundMel = melSpec;
         }
         
-        // Run inference
-        auto outputTensors = session->Run(
-            Ort::RunOptions{nullptr},
-            inputNamesCStr.data(), inputTensors.data(), inputTensors.size(),
-            outputNamesCStr.data(), outputNamesCStr.size()
-        );
+        if (context.outputLength == 0) {
+            // First run for this shape: let ONNX Runtime allocate, and learn the output size
+            context.binding->BindOutput(model.outputNamePtrs[0], model.memoryInfo);
+            model.session->Run(Ort::RunOptions{nullptr}, *context.binding);
+            
+            auto outputs = context.binding->GetOutputValues();
+            context.outputShape = outputs[0].GetTensorTypeAndShapeInfo().GetShape();
+            
+            size_t numOutputSamples = 1;
+            for (auto dim : context.outputShape) {
+                numOutputSamples *= (size_t)dim;
+            }
+            context.outputLength = numOutputSamples / (size_t)batchSize;
+            context.boundOutput = nullptr;
+            
+            return scatterOutput(outputs[0].GetTensorData<float>(), (int)context.outputLength,
+                                 batchSize, output, outputStride);
+        }
         
-        // Extract output audio
-        float* outputData = outputTensors[0].GetTensorMutableData<float>();
-        auto outputShape = outputTensors[0].GetTensorTypeAndShapeInfo().GetShape();
+        // Matching layout: the model writes straight into the caller's memory.
+        // Otherwise it writes to a preallocated buffer that is scattered afterwards.
+        const bool writesInPlace = (size_t)outputStride == context.outputLength;
+        if (!writesInPlace && context.outputBuffer.empty()) {
+            context.outputBuffer.resize((size_t)batchSize * context.outputLength);
+        }
         
-        int numOutputSamples = 1;
-        for (auto dim : outputShape) {
-            numOutputSamples *= (int)dim;
+        float* target = writesInPlace ? output : context.outputBuffer.data();
+        if (context.boundOutput != target) {
+            context.outputTensor = Ort::Value::CreateTensor<float>(
+                model.memoryInfo, target, (size_t)batchSize * context.outputLength,
+                context.outputShape.data(), context.outputShape.size());
+            context.binding->BindOutput(model.outputNamePtrs[0], context.outputTensor);
+            context.boundOutput = target;
         }
         
-        // Copy to output buffer
-        int samplesToCopy = std::min(numOutputSamples, outputSize);
-        std::copy(outputData, outputData + samplesToCopy, output);
+        model.session->Run(Ort::RunOptions{nullptr}, *context.binding);
         
-        std::cout << "AI inference complete: " << samplesToCopy << " samples generated" << std::endl;
+        if (writesInPlace) {
+            return outputStride;
+        }
         
-        return samplesToCopy;
+        return scatterOutput(context.outputBuffer.data(), (int)context.outputLength,
+                             batchSize, output, outputStride);
         
     } catch (const Ort::Exception& e) {
         std::cerr << "ONNX inference error: " << e.what() << std::endl;
@@ -172,22 +553,140 @@ int ONNXInference::processOffline(const float* f0, const float* melSpec,
     #else
     // ONNX not available - pass through unchanged
     std::cerr << "ONNX Runtime not available" << std::endl;
+    (void)model; (void)f0; (void)melSpec; (void)batchSize; (void)numFrames;
+    (void)numMelBands; (void)output; (void)outputStride;
     return 0;
     #endif
 }
 
+int ONNXInference::scatterOutput(const float* modelOutput, int samplesPerItem, int batchSize,
+                                 float* output, int outputStride) {
+    // Copy each item's audio to its slot, zero-padding short items
+    const int samplesToCopy = std::min(samplesPerItem, outputStride);
+    
+    for (int b = 0; b < batchSize; b++) {
+        const float* src = modelOutput + (size_t)b * samplesPerItem;
+        float* dest = output + (size_t)b * outputStride;
+        std::copy(src, src + samplesToCopy, dest);
+        std::fill(dest + samplesToCopy, dest + outputStride, 0.0f);
+    }
+    
+    return samplesToCopy;
+}
+
+int ONNXInference::getOutputLength(int batchSize, int numFrames, int numMelBands) {
+    std::shared_ptr<LoadedModel> model = getActiveModel();
+    if (model == nullptr) {
+        return 0;
+    }
+    
+    // Fixed-batch models run item by item, so the single-item shape is the one to ask about
+    if (!model->hasDynamicBatch) {
+        batchSize = 1;
+    }
+    
+    #ifdef ONNX_RUNTIME_AVAILABLE
+    auto findLength = [&]() -> int {
+        std::shared_ptr<EngineContexts> engine = model->getEngineContexts(this);
+        std::lock_guard<std::mutex> guard(engine->runLock);
+        auto found = engine->contexts.find({ batchSize, numFrames });
+        return found != engine->contexts.end() ? (int)found->second->outputLength : 0;
+    };
+    
+    if (int length = findLength()) {
+        return length;
+    }
+    
+    // Unknown shape: one synthetic run sets up its context (and warms it up)
+    std::vector<float> f0((size_t)batchSize * numFrames, 220.0f);
+    std::vector<float> mel((size_t)batchSize * numFrames * numMelBands, -4.0f);
+    std::vector<float> out((size_t)batchSize * numFrames * 512);
+    runBatch(*model, f0.data(), mel.data(), batchSize, numFrames, numMelBands, out.data(), numFrames * 512);
+    
+    return findLength();
+    #else
+    (void)numFrames; (void)numMelBands;
+    return 0;
+    #endif
+}
+
+int ONNXInference::chooseBatchSize(int numFrames, int numMelBands, int maxBatchSize) {
+    std::shared_ptr<LoadedModel> model = getActiveModel();
+    if (model == nullptr || !model->hasDynamicBatch || maxBatchSize <= 1) {
+        return 1;
+    }
+    
+    // Results belong to the model, so they survive switching away and back
+    std::lock_guard<std::mutex> guard(model->benchmarkLock);
+    
+    const int largest = std::min(8, maxBatchSize);
+    auto cached = model->bestBatchSizes.find({ numFrames, largest });
+    if (cached != model->bestBatchSizes.end()) {
+        return cached->second;
+    }
+    
+    // Steady voiced input, so the timing reflects a typical chunk
+    const int outputStride = numFrames * 512;
+    std::vector<float> f0(largest * (size_t)numFrames, 220.0f);
+    std::vector<float> mel(largest * (size_t)numFrames * numMelBands, -4.0f);
+    std::vector<float> out(largest * (size_t)outputStride);
+    
+    int bestSize = 1;
+    double bestThroughput = 0.0;
+    
+    for (int size = 1; size <= largest; size *= 2) {
+        // Warm-up run absorbs allocator growth and kernel selection for this shape
+        if (runBatch(*model, f0.data(), mel.data(), size, numFrames, numMelBands, out.data(), outputStride) <= 0) {
+            break;
+        }
+        
+        const int timedRuns = 2;
+        auto start = std::chrono::steady_clock::now();
+        for (int run = 0; run < timedRuns; run++) {
+            runBatch(*model, f0.data(), mel.data(), size, numFrames, numMelBands, out.data(), outputStride);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const double throughput = (double)(size * timedRuns) / std::max(seconds, 1e-9);
+        
+        // Stop once doubling the batch no longer buys a clear gain
+        if (throughput < bestThroughput * 1.05) {
+            break;
+        }
+        bestThroughput = throughput;
+        bestSize = size;
+    }
+    
+    model->bestBatchSizes[{ numFrames, largest }] = bestSize;
+    return bestSize;
+}
+
+bool ONNXInference::supportsBatching() const {
+    std::shared_ptr<LoadedModel> model = getActiveModel();
+    return model != nullptr && model->hasDynamicBatch;
+}
+
+int ONNXInference::getModelSampleRate() const {
+    std::shared_ptr<LoadedModel> model = getActiveModel();
+    return (model != nullptr) ? model->sampleRate : 0;
+}
+
 bool ONNXInference::isLoaded() const {
-    return isModelLoaded;
+    const juce::SpinLock::ScopedLockType guard(activeModelLock);
+    return activeModel != nullptr;
 }
 
 std::string ONNXInference::getModelInfo() const {
-    if (!isModelLoaded) {
+    std::shared_ptr<LoadedModel> model = getActiveModel();
+    if (model == nullptr) {
         return "No model loaded";
     }
     
-    std::string info = "Model: " + modelPath + "\n";
-    info += "Inputs: " + std::to_string(inputNames.size()) + "\n";
-    info += "Outputs: " + std::to_string(outputNames.size()) + "\n";
+    std::string info = "Model: " + model->modelPath + "\n";
+    info += "Inputs: " + std::to_string(model->inputNames.size()) + "\n";
+    info += "Outputs: " + std::to_string(model->outputNames.size()) + "\n";
+    if (model->sampleRate > 0) {
+        info += "Sample rate: " + std::to_string(model->sampleRate) + "\n";
+    }
     
     return info;
 }
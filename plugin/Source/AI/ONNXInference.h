@@ -1,12 +1,20 @@
 #pragma once
 
+#include "InferenceRuntime.h"
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 // Forward declarations to avoid including ONNX headers in header file
 // Actual types will be used in the .cpp file
 namespace Ort {
-    class Env;
     class Session;
 }
 
@@ -24,16 +32,51 @@ namespace blink {
  */
 class ONNXInference {
 public:
+    /** Called on the loader thread when an asynchronous load finishes. */
+    using LoadCallback = std::function<void(bool success, const std::string& modelPath)>;
+    
+    /** Layout of the mel input models are fed: [batch, bands, frames]. */
+    static constexpr int melBandsAxis = 1;
+    static constexpr int melFramesAxis = 2;
+    
     ONNXInference();
     ~ONNXInference();
     
     /**
-     * Load an ONNX model from file.
+     * Load an ONNX model from file and make it the active model.
+     * Recently used models are kept ready in a small pool, so switching back
+     * to one is instant. The new session is warmed up before it goes live;
+     * runs already in flight finish on the session they started with.
      * @param modelPath Path to .onnx model file
      * @return true if loaded successfully
      */
     bool loadModel(const std::string& modelPath);
     
+    /**
+     * Load a model on the background loader thread; returns immediately.
+     * A newer request replaces one that hasn't started yet (its callback is
+     * called with success = false and its own path).
+     * @param modelPath Path to .onnx model file
+     * @param onLoaded Optional completion callback
+     */
+    void loadModelAsync(const std::string& modelPath, LoadCallback onLoaded = nullptr);
+    
+    /**
+     * Scheduling priority for this engine's runs (default Batch).
+     */
+    void setPriority(InferenceRuntime::Priority newPriority) { priority = newPriority; }
+    
+    /**
+     * Number of ready sessions kept for instant switching (at least 1).
+     */
+    void setPoolCapacity(int numSessions);
+    
+    /**
+     * Drop a pooled model that is no longer wanted (e.g. a benchmarked variant
+     * that lost). The active model is never dropped.
+     */
+    void releaseModel(const std::string& modelPath);
+    
     /**
      * Process audio through the AI model (offline mode).
      * @param f0 F0 (pitch) curve in Hz
@@ -49,7 +92,49 @@ public:
                       float* output, int outputSize);
     
     /**
-     * Check if a model is loaded.
+     * Process several equal-length sequences in one run.
+     * Inputs are packed item after item: f0 is [batchSize x numFrames] and melSpec
+     * is [batchSize x numFrames*numMelBands]. Item i's audio is written to
+     * output + i * outputStride, zero-padded to outputStride.
+     * Models with a fixed batch dimension of 1 are run once per item.
+     * @return Samples generated per item, or 0 on failure
+     */
+    int processBatch(const float* f0, const float* melSpec,
+                     int batchSize, int numFrames, int numMelBands,
+                     float* output, int outputStride);
+    
+    /**
+     * Samples per item the model produces for a batch of numFrames-long
+     * sequences (runs the model once if this shape hasn't been seen yet).
+     * Passing this as processBatch's outputStride lets the model write
+     * straight into the caller's buffer with no copy.
+     * @return Samples per item, or 0 if unknown
+     */
+    int getOutputLength(int batchSize, int numFrames, int numMelBands);
+    
+    /**
+     * Pick the batch size with the best throughput for sequences of numFrames,
+     * by timing runs of synthetic input on the loaded model. The result is cached
+     * per sequence length and limit until another model is loaded.
+     * @param maxBatchSize Largest batch size worth considering
+     */
+    int chooseBatchSize(int numFrames, int numMelBands, int maxBatchSize);
+    
+    /**
+     * True if the model's batch dimension is dynamic.
+     */
+    bool supportsBatching() const;
+    
+    /**
+     * Native sample rate of the active model's audio, from its "sample_rate"
+     * (or "sampling_rate"/"sr") metadata or a tag like "40k" in the file name.
+     * @return Rate in Hz, or 0 if unknown
+     */
+    int getModelSampleRate() const;
+    
+    /**
+     * Check if a model is loaded. Safe on any thread, the audio thread included:
+     * it takes no reference to the model, so it can never be the one to free it.
      */
     bool isLoaded() const;
     
@@ -59,16 +144,51 @@ public:
     std::string getModelInfo() const;
 
 private:
-    Ort::Session* session;
-    Ort::Env* env;
-    bool isModelLoaded;
+    // A ready session and its metadata (defined in the .cpp)
+    struct LoadedModel;
     
-    std::vector<std::string> inputNames;
-    std::vector<std::string> outputNames;
-    
-    // Model metadata
-    std::string modelPath;
     int expectedMelBands;
+    std::atomic<InferenceRuntime::Priority> priority;
+    
+    // Active model. The lock is only held to copy or swap the pointer, so a swap
+    // never blocks or invalidates a Run in progress, which holds its own copy.
+    juce::SpinLock activeModelLock;
+    std::shared_ptr<LoadedModel> activeModel;
+    
+    // Recently used models, most recent first
+    std::mutex poolLock;
+    std::list<std::shared_ptr<LoadedModel>> sessionPool;
+    size_t poolCapacity;
+    
+    // Background loader: one pending request, latest wins
+    std::mutex loaderLock;
+    std::condition_variable loaderCondition;
+    std::string pendingPath;
+    LoadCallback pendingCallback;
+    bool hasPendingLoad;
+    bool stopLoader;
+    std::thread loaderThread;
+    
+    // A reference to the active model, for a run or a metadata read. Any thread but
+    // the audio thread: dropping the copy may free a model evicted meanwhile.
+    std::shared_ptr<LoadedModel> getActiveModel() const;
+    
+    // Swap in a model (nullptr to clear). Called on the loading thread with the
+    // pool holding the model, so the previous one is never freed here.
+    void setActiveModel(std::shared_ptr<LoadedModel> model);
+    std::shared_ptr<LoadedModel> acquireModel(const std::string& modelPath);
+    std::shared_ptr<LoadedModel> createModel(const std::string& modelPath);
+    void warmUp(LoadedModel& model);
+    void runLoader();
+    
+    static constexpr size_t maxContextsPerModel = 8;
+    
+    static int scatterOutput(const float* modelOutput, int samplesPerItem, int batchSize,
+                             float* output, int outputStride);
+    
+    int runBatch(LoadedModel& model, const float* f0, const float* melSpec,
+                 int batchSize, int numFrames, int numMelBands,
+                 float* output, int outputStride);
 };
 
 } // namespace blink
@@ -0,0 +1,233 @@
+#include "ConversionCache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <juce_cryptography/juce_cryptography.h>
+
+namespace blink {
+
+namespace {
+
+constexpr char cacheMagic[4] = { 'V', 'S', 'P', 'C' };
+constexpr uint32_t cacheVersion = 1;
+constexpr const char* cacheExtension = ".vspc";
+
+struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t numArrays;
+    uint32_t reserved;
+    int32_t params[4];
+};
+
+static_assert(sizeof(CacheHeader) == 32, "Cache header layout must stay fixed");
+
+size_t alignTo16(size_t offset) {
+    return (offset + 15) & ~(size_t)15;
+}
+
+// True if count elements of elementSize bytes from offset lie within size bytes,
+// checked without any arithmetic that could wrap
+bool fitsIn(size_t offset, uint64_t count, size_t elementSize, size_t size) {
+    return offset <= size && count <= (size - offset) / elementSize;
+}
+
+} // namespace
+
+ConversionCache::ConversionCache(const juce::File& directory, int64_t maxSizeBytes)
+    : directory(directory), maxSize(maxSizeBytes) {
+}
+
+juce::File ConversionCache::getDefaultDirectory() {
+    return juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+        .getChildFile("VocalSuitePro")
+        .getChildFile("Cache");
+}
+
+std::string ConversionCache::hashAudio(const float* samples, int numSamples) {
+    return juce::SHA256(samples, (size_t)numSamples * sizeof(float)).toHexString().toStdString();
+}
+
+std::string ConversionCache::hashFile(const juce::File& file) {
+    const juce::String path = file.getFullPathName();
+    const juce::String stamp = juce::String(file.getSize()) + ":"
+                             + juce::String(file.getLastModificationTime().toMilliseconds());
+
+    {
+        const std::lock_guard<std::mutex> guard(hashLock);
+        auto found = fileHashes.find(path.toStdString());
+        if (found != fileHashes.end() && found->second.first == stamp) {
+            return found->second.second;
+        }
+    }
+
+    std::string hash = juce::SHA256(file).toHexString().toStdString();
+
+    const std::lock_guard<std::mutex> guard(hashLock);
+    fileHashes[path.toStdString()] = { stamp, hash };
+    return hash;
+}
+
+std::string ConversionCache::makeKey(const std::vector<std::string>& parts) {
+    juce::String combined;
+    for (const auto& part : parts) {
+        combined << part.c_str() << "|";
+    }
+    return juce::SHA256(combined.toUTF8()).toHexString().toStdString();
+}
+
+juce::File ConversionCache::getEntryFile(const std::string& key) const {
+    return directory.getChildFile(juce::String(key) + cacheExtension);
+}
+
+std::unique_ptr<ConversionCache::Entry> ConversionCache::open(const std::string& key) {
+    juce::File file = getEntryFile(key);
+    if (!file.existsAsFile()) {
+        return nullptr;
+    }
+
+    auto entry = std::make_unique<Entry>();
+    entry->mappedFile = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+
+    const auto* base = static_cast<const char*>(entry->mappedFile->getData());
+    const size_t size = entry->mappedFile->getSize();
+
+    if (base == nullptr || size < sizeof(CacheHeader)) {
+        return nullptr;
+    }
+
+    CacheHeader header;
+    std::memcpy(&header, base, sizeof(header));
+
+    if (std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0
+        || header.version != cacheVersion
+        || header.numArrays > 64) {
+        return nullptr;
+    }
+
+    const size_t lengthsOffset = sizeof(CacheHeader);
+    if (lengthsOffset + header.numArrays * sizeof(uint64_t) > size) {
+        return nullptr;
+    }
+
+    size_t offset = alignTo16(lengthsOffset + header.numArrays * sizeof(uint64_t));
+
+    for (uint32_t i = 0; i < header.numArrays; i++) {
+        uint64_t length;
+        std::memcpy(&length, base + lengthsOffset + i * sizeof(uint64_t), sizeof(length));
+
+        if (!fitsIn(offset, length, sizeof(float), size)) {
+            // Truncated or damaged: drop it, so it is rebuilt rather than read again
+            entry.reset();
+            file.deleteFile();
+            return nullptr;
+        }
+
+        entry->arrays.emplace_back(reinterpret_cast<const float*>(base + offset), (size_t)length);
+
+        // At most size + 15 here; the next array's check rejects anything past the end
+        offset = alignTo16(offset + (size_t)length * sizeof(float));
+    }
+
+    std::copy(header.params, header.params + 4, entry->params);
+
+    // Mark as recently used for LRU eviction
+    file.setLastModificationTime(juce::Time::getCurrentTime());
+
+    return entry;
+}
+
+bool ConversionCache::store(const std::string& key, const std::vector<ArrayData>& arrays,
+                            const int32_t (&params)[4]) {
+    if (!directory.isDirectory() && directory.createDirectory().failed()) {
+        return false;
+    }
+
+    CacheHeader header {};
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion;
+    header.numArrays = (uint32_t)arrays.size();
+    std::copy(params, params + 4, header.params);
+
+    juce::File target = getEntryFile(key);
+    juce::TemporaryFile temp(target);
+
+    {
+        std::unique_ptr<juce::FileOutputStream> stream(temp.getFile().createOutputStream());
+        if (stream == nullptr || stream->failedToOpen()) {
+            return false;
+        }
+
+        size_t offset = 0;
+        auto writeBytes = [&](const void* data, size_t numBytes) {
+            stream->write(data, numBytes);
+            offset += numBytes;
+        };
+        auto padTo16 = [&] {
+            const char zeros[16] = {};
+            writeBytes(zeros, alignTo16(offset) - offset);
+        };
+
+        writeBytes(&header, sizeof(header));
+        for (const auto& array : arrays) {
+            const uint64_t length = array.length;
+            writeBytes(&length, sizeof(length));
+        }
+
+        for (const auto& array : arrays) {
+            padTo16();
+            writeBytes(array.data, array.length * sizeof(float));
+        }
+
+        stream->flush();
+        if (stream->getStatus().failed()) {
+            return false;
+        }
+    }
+
+    if (!temp.overwriteTargetFileWithTemporary()) {
+        return false;
+    }
+
+    evict();
+    return true;
+}
+
+void ConversionCache::evict() {
+    auto files = directory.findChildFiles(juce::File::findFiles, false, juce::String("*") + cacheExtension);
+
+    int64_t total = 0;
+    for (const auto& file : files) {
+        total += file.getSize();
+    }
+
+    if (total <= maxSize) {
+        return;
+    }
+
+    // Oldest use first
+    std::sort(files.begin(), files.end(), [](const juce::File& a, const juce::File& b) {
+        return a.getLastModificationTime() < b.getLastModificationTime();
+    });
+
+    for (const auto& file : files) {
+        if (total <= maxSize) {
+            break;
+        }
+
+        const int64_t size = file.getSize();
+        if (file.deleteFile()) {
+            total -= size;
+        }
+    }
+}
+
+void ConversionCache::clear() {
+    for (const auto& file : directory.findChildFiles(juce::File::findFiles, false,
+                                                     juce::String("*") + cacheExtension)) {
+        file.deleteFile();
+    }
+}
+
+} // namespace blink
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace blink {
+
+/**
+ * Content-addressed disk cache for offline conversion.
+ *
+ * Entries are keyed by a SHA-256 of whatever determines their contents (the
+ * audio, the analysis settings, the model, the render settings), so a changed
+ * input simply misses rather than needing invalidation.
+ *
+ * Each entry is one file in a memory-mappable format:
+ *   - 32-byte header: magic "VSPC", version, array count, four int32 params
+ *   - uint64 length (in floats) of each array
+ *   - the float32 arrays, each starting on a 16-byte boundary
+ *
+ * Hits refresh the file's modification time; once the cache grows past its
+ * size limit the least recently used entries are deleted.
+ */
+class ConversionCache {
+public:
+    /**
+     * Read-only view of a cached entry, backed by a memory-mapped file.
+     */
+    class Entry {
+    public:
+        int getNumArrays() const { return (int)arrays.size(); }
+        const float* getArray(int index) const { return arrays[(size_t)index].first; }
+        size_t getArrayLength(int index) const { return arrays[(size_t)index].second; }
+        int getParam(int index) const { return params[index]; }
+
+    private:
+        friend class ConversionCache;
+
+        std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+        std::vector<std::pair<const float*, size_t>> arrays;
+        int32_t params[4] = {};
+    };
+
+    /** One float array to store. */
+    struct ArrayData {
+        const float* data;
+        size_t length;
+    };
+
+    /**
+     * @param directory Folder holding the cache files (created on first store)
+     * @param maxSizeBytes Total size the cache is trimmed to after each store
+     */
+    explicit ConversionCache(const juce::File& directory,
+                             int64_t maxSizeBytes = 2LL * 1024 * 1024 * 1024);
+
+    /** Documents/VocalSuitePro/Cache */
+    static juce::File getDefaultDirectory();
+
+    /** SHA-256 (hex) of a block of samples. */
+    static std::string hashAudio(const float* samples, int numSamples);
+
+    /**
+     * SHA-256 (hex) of a model file's contents. Remembered per path, size and
+     * modification time so large models are only read once.
+     */
+    std::string hashFile(const juce::File& file);
+
+    /** Combine the parts of a key into one hex digest. */
+    static std::string makeKey(const std::vector<std::string>& parts);
+
+    /**
+     * Map a cached entry.
+     * @return nullptr on a miss or if the file is damaged
+     */
+    std::unique_ptr<Entry> open(const std::string& key);
+
+    /**
+     * Write an entry (atomically, via a temp file) and trim the cache.
+     * @return true if stored
+     */
+    bool store(const std::string& key, const std::vector<ArrayData>& arrays,
+               const int32_t (&params)[4]);
+
+    void setMaxSize(int64_t maxSizeBytes) { maxSize = maxSizeBytes; }
+    int64_t getMaxSize() const { return maxSize; }
+
+    /** Delete least recently used entries until the total is under the limit. */
+    void evict();
+
+    /** Delete every entry. */
+    void clear();
+
+private:
+    juce::File directory;
+    int64_t maxSize;
+
+    std::mutex hashLock;
+    std::map<std::string, std::pair<juce::String, std::string>> fileHashes; // path -> (stamp, hash)
+
+    juce::File getEntryFile(const std::string& key) const;
+};
+
+} // namespace blink
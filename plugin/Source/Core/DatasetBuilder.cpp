@@ -0,0 +1,573 @@
+#include "DatasetBuilder.h"
+#include "../DSP/Resampler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+namespace blink {
+
+namespace {
+
+constexpr char shardMagic[4] = { 'V', 'S', 'D', 'S' };
+constexpr uint32_t shardVersion = 1;
+constexpr uint32_t manifestVersion = 1;
+
+struct ShardHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t numSlices;
+    uint32_t reserved;
+    int32_t params[4];
+};
+
+static_assert(sizeof(ShardHeader) == 32, "Shard header layout must stay fixed");
+
+size_t alignTo16(size_t offset) {
+    return (offset + 15) & ~(size_t)15;
+}
+
+// True if count elements of elementSize bytes from offset lie within size bytes,
+// checked without any arithmetic that could wrap
+bool fitsIn(size_t offset, uint64_t count, size_t elementSize, size_t size) {
+    return offset <= size && count <= (size - offset) / elementSize;
+}
+
+// RMS of windowLength-sample windows, windowHop apart
+void computeWindowRms(const float* audio, int numSamples, int windowLength, int windowHop,
+                      std::vector<float>& rms) {
+    const int numWindows = (numSamples <= windowLength) ? 1 : (numSamples - windowLength) / windowHop + 1;
+    rms.resize((size_t)numWindows);
+
+    for (int w = 0; w < numWindows; w++) {
+        const int start = w * windowHop;
+        const int length = std::min(windowLength, numSamples - start);
+        double sum = 0.0;
+        for (int i = 0; i < length; i++) {
+            sum += (double)audio[start + i] * audio[start + i];
+        }
+        rms[(size_t)w] = (length > 0) ? (float)std::sqrt(sum / length) : 0.0f;
+    }
+}
+
+/**
+ * Opens a reader, memory-mapping the file when the format supports it
+ * and falling back to a streaming reader otherwise.
+ */
+std::unique_ptr<juce::AudioFormatReader> openReader(juce::AudioFormatManager& formats, const juce::File& file) {
+    for (int i = 0; i < formats.getNumKnownFormats(); i++) {
+        auto* format = formats.getKnownFormat(i);
+        if (!format->canHandleFile(file)) {
+            continue;
+        }
+
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format->createMemoryMappedReader(file));
+        if (mapped != nullptr && mapped->mapEntireFile()) {
+            return mapped;
+        }
+    }
+
+    return std::unique_ptr<juce::AudioFormatReader>(formats.createReaderFor(file));
+}
+
+} // namespace
+
+//==============================================================================
+// Shard reader
+
+std::unique_ptr<DatasetBuilder::Shard> DatasetBuilder::Shard::open(const juce::File& file) {
+    if (!file.existsAsFile()) {
+        return nullptr;
+    }
+
+    auto shard = std::make_unique<Shard>();
+    shard->mappedFile = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+
+    const auto* base = static_cast<const char*>(shard->mappedFile->getData());
+    const size_t size = shard->mappedFile->getSize();
+
+    if (base == nullptr || size < sizeof(ShardHeader)) {
+        return nullptr;
+    }
+
+    ShardHeader header;
+    std::memcpy(&header, base, sizeof(header));
+
+    if (std::memcmp(header.magic, shardMagic, sizeof(shardMagic)) != 0
+        || header.version != shardVersion
+        || header.params[3] <= 0) {
+        return nullptr;
+    }
+
+    const size_t tableOffset = sizeof(ShardHeader);
+    if (header.numSlices > (size - tableOffset) / sizeof(SliceRecord)) {
+        return nullptr;
+    }
+
+    const size_t numMelBands = (size_t)header.params[3];
+
+    for (uint32_t i = 0; i < header.numSlices; i++) {
+        SliceRecord record;
+        std::memcpy(&record, base + tableOffset + i * sizeof(SliceRecord), sizeof(record));
+
+        // Each array is checked before the next offset is derived from it
+        const uint64_t audioOffset = record.offset;
+        if (audioOffset % 16 != 0 || audioOffset < tableOffset || audioOffset > size
+            || record.numSamples > (uint32_t)std::numeric_limits<int>::max()
+            || record.numFrames > (uint32_t)std::numeric_limits<int>::max()
+            || !fitsIn((size_t)audioOffset, record.numSamples, sizeof(float), size)) {
+            return nullptr; // Truncated or damaged
+        }
+
+        const size_t f0Offset = alignTo16((size_t)audioOffset + (size_t)record.numSamples * sizeof(float));
+        if (!fitsIn(f0Offset, record.numFrames, sizeof(float), size)) {
+            return nullptr;
+        }
+
+        const size_t melOffset = alignTo16(f0Offset + (size_t)record.numFrames * sizeof(float));
+        if (!fitsIn(melOffset, record.numFrames, numMelBands * sizeof(float), size)) {
+            return nullptr;
+        }
+
+        Slice slice;
+        slice.audio = reinterpret_cast<const float*>(base + audioOffset);
+        slice.numSamples = (int)record.numSamples;
+        slice.f0 = reinterpret_cast<const float*>(base + f0Offset);
+        slice.mel = reinterpret_cast<const float*>(base + melOffset);
+        slice.numFrames = (int)record.numFrames;
+        slice.sourceIndex = (int)record.sourceIndex;
+        slice.sourceStart = (int)record.sourceStart;
+        shard->slices.push_back(slice);
+    }
+
+    std::copy(header.params, header.params + 4, shard->params);
+    return shard;
+}
+
+//==============================================================================
+// Locations
+
+juce::File DatasetBuilder::getCaptureDirectory() {
+    return juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+        .getChildFile("VocalSuitePro")
+        .getChildFile("Renders");
+}
+
+juce::File DatasetBuilder::getDefaultOutputDirectory() {
+    return juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+        .getChildFile("VocalSuitePro")
+        .getChildFile("Datasets");
+}
+
+juce::Array<juce::File> DatasetBuilder::findCaptures(const juce::File& directory) {
+    auto captures = directory.findChildFiles(juce::File::findFiles, false, "capture_*.wav");
+
+    // Capture names carry their timestamp, so name order is recording order
+    std::sort(captures.begin(), captures.end(),
+              [](const juce::File& a, const juce::File& b) { return a.getFileName() < b.getFileName(); });
+    return captures;
+}
+
+//==============================================================================
+// Slicing
+
+std::vector<std::pair<int, int>> DatasetBuilder::findSlices(const float* audio, int numSamples) const {
+    std::vector<std::pair<int, int>> slices;
+
+    const double rate = settings.sampleRate;
+    const int windowHop = std::max(1, (int)std::lround(0.01 * rate));  // 10 ms
+    const int windowLength = windowHop * 2;
+
+    std::vector<float> rms;
+    computeWindowRms(audio, numSamples, windowLength, windowHop, rms);
+
+    const float loudest = *std::max_element(rms.begin(), rms.end());
+    if (loudest <= 1.0e-6f) {
+        return slices; // Silent take
+    }
+
+    const float threshold = loudest * std::pow(10.0f, settings.silenceThresholdDb / 20.0f);
+    const int numWindows = (int)rms.size();
+    const int minSilenceWindows = std::max(1, (int)std::lround(settings.minSilenceSeconds * rate / windowHop));
+
+    // Voiced regions, in windows; pauses shorter than minSilence are bridged
+    std::vector<std::pair<int, int>> regions;
+    for (int w = 0; w < numWindows; w++) {
+        if (rms[(size_t)w] < threshold) {
+            continue;
+        }
+        if (!regions.empty() && w - regions.back().second <= minSilenceWindows) {
+            regions.back().second = w;
+        } else {
+            regions.emplace_back(w, w);
+        }
+    }
+
+    const int keep = (int)std::lround(settings.keepSilenceSeconds * rate);
+    const int minLength = (int)std::lround(settings.minSliceSeconds * rate);
+    const int maxLength = std::max(1, (int)std::lround(settings.maxSliceSeconds * rate));
+
+    for (const auto& region : regions) {
+        const int start = std::max(0, region.first * windowHop - keep);
+        const int end = std::min(numSamples, region.second * windowHop + windowLength + keep);
+        const int length = end - start;
+
+        if (length < minLength) {
+            continue;
+        }
+
+        // Long phrases are cut into equal parts no longer than the maximum
+        const int numParts = (length + maxLength - 1) / maxLength;
+        for (int part = 0; part < numParts; part++) {
+            const int partStart = start + (int)((int64_t)length * part / numParts);
+            const int partEnd = start + (int)((int64_t)length * (part + 1) / numParts);
+            slices.emplace_back(partStart, partEnd);
+        }
+    }
+
+    return slices;
+}
+
+//==============================================================================
+// Build
+
+DatasetBuilder::Worker::Worker(const Settings& settings, int index)
+    : index(index),
+      pitchDetector(settings.sampleRate, settings.fftSize),
+      f0Extractor(settings.hopSize),
+      melSpec(settings.fftSize, settings.hopSize, settings.numMelBands) {
+    f0Extractor.setSampleRate(settings.sampleRate);
+    melSpec.setSampleRate(settings.sampleRate);
+    formats.registerBasicFormats();
+}
+
+bool DatasetBuilder::build(const juce::Array<juce::File>& inputs, const juce::File& outputDir,
+                           Summary& summary, ProgressCallback progress, CancelCheck shouldCancel) {
+    summary = Summary();
+    summary.numFiles = inputs.size();
+
+    if (inputs.isEmpty()) {
+        summary.errors.push_back("No input files");
+        return false;
+    }
+
+    if (!outputDir.isDirectory() && outputDir.createDirectory().failed()) {
+        summary.errors.push_back("Cannot create " + outputDir.getFullPathName().toStdString());
+        return false;
+    }
+
+    BuildState state;
+    state.inputs = &inputs;
+    state.outputDir = outputDir;
+    state.progress = std::move(progress);
+    state.shouldCancel = std::move(shouldCancel);
+    state.summary = &summary;
+
+    const int numThreads = juce::jlimit(1, inputs.size(),
+        settings.numThreads > 0 ? settings.numThreads : juce::SystemStats::getNumCpus());
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int i = 0; i < numThreads; i++) {
+        workers.push_back(std::make_unique<Worker>(settings, i));
+    }
+
+    const auto wallStart = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (auto& worker : workers) {
+        threads.emplace_back([this, &worker, &state] { runWorker(*worker, state); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    summary.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    summary.numShards = (int)state.shards.size();
+
+    if (state.cancelled.load()) {
+        summary.errors.push_back("Cancelled");
+        return false;
+    }
+
+    if (summary.numSlices == 0) {
+        summary.errors.push_back("No usable slices found");
+        return false;
+    }
+
+    if (!writeManifest(state)) {
+        summary.errors.push_back("Cannot write dataset.json");
+        return false;
+    }
+
+    return true;
+}
+
+void DatasetBuilder::runWorker(Worker& worker, BuildState& state) {
+    const auto cpuStart = std::chrono::steady_clock::now();
+    const auto& inputs = *state.inputs;
+
+    for (int index = state.nextInput++; index < inputs.size(); index = state.nextInput++) {
+        if (state.cancelled.load() || (state.shouldCancel && state.shouldCancel())) {
+            state.cancelled.store(true);
+            break;
+        }
+
+        const juce::File& file = inputs.getReference(index);
+        double sourceSeconds = 0.0;
+        std::string error;
+
+        if (readSource(worker, file, sourceSeconds, error)) {
+            const auto slices = findSlices(worker.audio.data(), (int)worker.audio.size());
+
+            for (const auto& slice : slices) {
+                if (state.shouldCancel && state.shouldCancel()) {
+                    state.cancelled.store(true);
+                    break;
+                }
+                addSlice(worker, state, index, slice.first, slice.second);
+            }
+
+            std::lock_guard<std::mutex> guard(state.lock);
+            state.summary->sourceSeconds += sourceSeconds;
+        } else {
+            std::lock_guard<std::mutex> guard(state.lock);
+            state.summary->numFailedFiles++;
+            state.summary->errors.push_back(file.getFileName().toStdString() + ": " + error);
+        }
+
+        const int done = ++state.filesDone;
+        if (state.progress) {
+            state.progress((float)done / (float)inputs.size());
+        }
+    }
+
+    if (!state.cancelled.load()) {
+        flushShard(worker, state);
+    }
+
+    const double cpuSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - cpuStart).count();
+    std::lock_guard<std::mutex> guard(state.lock);
+    state.summary->cpuSeconds += cpuSeconds;
+}
+
+bool DatasetBuilder::readSource(Worker& worker, const juce::File& file, double& sourceSeconds,
+                                std::string& error) {
+    auto reader = openReader(worker.formats, file);
+    if (reader == nullptr) {
+        error = "Unsupported or unreadable file";
+        return false;
+    }
+
+    const int numSamples = (int)reader->lengthInSamples;
+    const int numChannels = (int)reader->numChannels;
+    const double sourceRate = reader->sampleRate;
+
+    if (numSamples <= 0 || sourceRate <= 0.0) {
+        error = "Empty file";
+        return false;
+    }
+
+    juce::AudioBuffer<float> source(numChannels, numSamples);
+    reader->read(source.getArrayOfWritePointers(), numChannels, 0, numSamples);
+    reader.reset();
+
+    // Fold to mono
+    worker.audio.assign(source.getReadPointer(0), source.getReadPointer(0) + numSamples);
+    for (int ch = 1; ch < numChannels; ch++) {
+        juce::FloatVectorOperations::add(worker.audio.data(), source.getReadPointer(ch), numSamples);
+    }
+    if (numChannels > 1) {
+        juce::FloatVectorOperations::multiply(worker.audio.data(), 1.0f / (float)numChannels, numSamples);
+    }
+
+    sourceSeconds = numSamples / sourceRate;
+    resample(worker, sourceRate);
+    return true;
+}
+
+void DatasetBuilder::resample(Worker& worker, double sourceRate) {
+    if (std::abs(sourceRate - settings.sampleRate) < 1.0e-6) {
+        return;
+    }
+
+    // The same converter the voice processors use, so training audio and live
+    // audio reach the model with the same passband and phase response
+    worker.audio = Resampler::resample(worker.audio.data(), (int)worker.audio.size(),
+                                       sourceRate, settings.sampleRate);
+}
+
+void DatasetBuilder::addSlice(Worker& worker, BuildState& state, int sourceIndex, int start, int end) {
+    const int numSamples = end - start;
+    const int fftSize = settings.fftSize;
+    const int hopSize = settings.hopSize;
+    const int numMelBands = settings.numMelBands;
+
+    // Analysis reads whole frames, so the tail is zero-padded to the last frame's end
+    const int numFrames = (numSamples <= fftSize) ? 1 : (numSamples - fftSize) / hopSize + 1;
+    const int paddedLength = std::max(numSamples, (numFrames - 1) * hopSize + fftSize);
+
+    worker.slice.assign((size_t)paddedLength, 0.0f);
+    std::copy(worker.audio.begin() + start, worker.audio.begin() + end, worker.slice.begin());
+    float* audio = worker.slice.data();
+
+    // Loudness: RMS over the windows that aren't silence, then a peak ceiling
+    const int windowHop = std::max(1, (int)std::lround(0.01 * settings.sampleRate));
+    std::vector<float> rms;
+    computeWindowRms(audio, numSamples, windowHop * 2, windowHop, rms);
+
+    const float loudest = *std::max_element(rms.begin(), rms.end());
+    const float threshold = loudest * std::pow(10.0f, settings.silenceThresholdDb / 20.0f);
+    double energy = 0.0;
+    int counted = 0;
+    for (float value : rms) {
+        if (value >= threshold) {
+            energy += (double)value * value;
+            counted++;
+        }
+    }
+
+    const float level = counted > 0 ? (float)std::sqrt(energy / counted) : 0.0f;
+    if (level > 1.0e-6f) {
+        float peak = 0.0f;
+        for (int i = 0; i < numSamples; i++) {
+            peak = std::max(peak, std::abs(audio[i]));
+        }
+
+        const float gainDb = std::min(settings.maxGainDb, settings.targetLoudnessDb - 20.0f * std::log10(level));
+        const float gain = std::min(std::pow(10.0f, gainDb / 20.0f), settings.peakCeiling / peak);
+        juce::FloatVectorOperations::multiply(audio, gain, numSamples);
+    }
+
+    // Features, with the converter's analysis settings
+    worker.f0.resize((size_t)numFrames);
+    worker.mel.resize((size_t)numFrames * numMelBands);
+
+    for (int frame = 0; frame < numFrames; frame++) {
+        worker.f0[(size_t)frame] = worker.pitchDetector.getPitch(audio + frame * hopSize, fftSize);
+    }
+    worker.f0Extractor.smoothCurve(worker.f0.data(), numFrames);
+    worker.melSpec.processFrames(audio, numFrames, worker.mel.data());
+
+    // Queue the arrays in the shard's data block
+    auto appendArray = [&worker](const float* values, size_t count) {
+        const size_t offset = alignTo16(worker.data.size());
+        worker.data.resize(offset + count * sizeof(float), 0);
+        std::memcpy(worker.data.data() + offset, values, count * sizeof(float));
+        return offset;
+    };
+
+    SliceRecord record {};
+    record.offset = appendArray(audio, (size_t)numSamples);
+    record.numSamples = (uint32_t)numSamples;
+    record.numFrames = (uint32_t)numFrames;
+    record.sourceIndex = (uint32_t)sourceIndex;
+    record.sourceStart = (uint32_t)start;
+    appendArray(worker.f0.data(), worker.f0.size());
+    appendArray(worker.mel.data(), worker.mel.size());
+    worker.records.push_back(record);
+
+    {
+        std::lock_guard<std::mutex> guard(state.lock);
+        state.summary->numSlices++;
+        state.summary->numFrames += numFrames;
+        state.summary->sliceSeconds += numSamples / settings.sampleRate;
+    }
+
+    if ((int64_t)worker.data.size() >= settings.maxShardBytes) {
+        flushShard(worker, state);
+    }
+}
+
+bool DatasetBuilder::flushShard(Worker& worker, BuildState& state) {
+    if (worker.records.empty()) {
+        return true;
+    }
+
+    const auto fileName = juce::String::formatted("shard_%02d_%04d.vsds", worker.index, worker.numShardsWritten);
+    const juce::File target = state.outputDir.getChildFile(fileName);
+
+    ShardHeader header {};
+    std::memcpy(header.magic, shardMagic, sizeof(shardMagic));
+    header.version = shardVersion;
+    header.numSlices = (uint32_t)worker.records.size();
+    header.params[0] = (int32_t)std::lround(settings.sampleRate);
+    header.params[1] = settings.fftSize;
+    header.params[2] = settings.hopSize;
+    header.params[3] = settings.numMelBands;
+
+    // Data block offsets become file offsets
+    const size_t dataOffset = alignTo16(sizeof(ShardHeader) + worker.records.size() * sizeof(SliceRecord));
+    for (auto& record : worker.records) {
+        record.offset += dataOffset;
+    }
+
+    bool written = false;
+    {
+        juce::TemporaryFile temp(target);
+        {
+            std::unique_ptr<juce::FileOutputStream> stream(temp.getFile().createOutputStream());
+            if (stream != nullptr && !stream->failedToOpen()) {
+                const char zeros[16] = {};
+                const size_t tableEnd = sizeof(ShardHeader) + worker.records.size() * sizeof(SliceRecord);
+
+                stream->write(&header, sizeof(header));
+                stream->write(worker.records.data(), worker.records.size() * sizeof(SliceRecord));
+                stream->write(zeros, dataOffset - tableEnd);
+                stream->write(worker.data.data(), worker.data.size());
+                stream->flush();
+                written = stream->getStatus().wasOk();
+            }
+        }
+        written = written && temp.overwriteTargetFileWithTemporary();
+    }
+
+    if (written) {
+        std::lock_guard<std::mutex> guard(state.lock);
+        state.shards.emplace_back(fileName.toStdString(), (int)worker.records.size());
+    } else {
+        std::lock_guard<std::mutex> guard(state.lock);
+        state.summary->errors.push_back("Cannot write " + target.getFullPathName().toStdString());
+    }
+
+    worker.numShardsWritten++;
+    worker.records.clear();
+    worker.data.clear();
+    return written;
+}
+
+bool DatasetBuilder::writeManifest(BuildState& state) const {
+    std::sort(state.shards.begin(), state.shards.end());
+
+    juce::Array<juce::var> sources;
+    for (const auto& input : *state.inputs) {
+        sources.add(input.getFullPathName());
+    }
+
+    juce::Array<juce::var> shards;
+    for (const auto& shard : state.shards) {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("file", juce::String(shard.first));
+        entry->setProperty("slices", shard.second);
+        shards.add(juce::var(entry));
+    }
+
+    auto* manifest = new juce::DynamicObject();
+    manifest->setProperty("version", (int)manifestVersion);
+    manifest->setProperty("sampleRate", settings.sampleRate);
+    manifest->setProperty("fftSize", settings.fftSize);
+    manifest->setProperty("hopSize", settings.hopSize);
+    manifest->setProperty("numMelBands", settings.numMelBands);
+    manifest->setProperty("targetLoudnessDb", settings.targetLoudnessDb);
+    manifest->setProperty("numSlices", state.summary->numSlices);
+    manifest->setProperty("sliceSeconds", state.summary->sliceSeconds);
+    manifest->setProperty("sources", sources);
+    manifest->setProperty("shards", shards);
+
+    return state.outputDir.getChildFile("dataset.json")
+        .replaceWithText(juce::JSON::toString(juce::var(manifest)));
+}
+
+} // namespace blink
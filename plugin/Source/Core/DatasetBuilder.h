@@ -0,0 +1,201 @@
+#pragma once
+
+#include "../DSP/F0Extractor.h"
+#include "../DSP/MelSpectrogram.h"
+#include "../DSP/PitchDetector.h"
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace blink {
+
+/**
+ * Builds a voice-model training set from capture WAVs.
+ *
+ * Each take is folded to mono, resampled to the model rate and split on
+ * silence (windowed RMS against the take's loudest window). Every slice is
+ * normalised to a target loudness, then its F0 and mel features are computed
+ * with the same settings the converter uses.
+ *
+ * Slices are written to shard files in a memory-mappable format:
+ *   - 32-byte header: magic "VSDS", version, slice count, four int32 params
+ *     (sample rate, FFT size, hop size, mel bands)
+ *   - a 32-byte table entry per slice (see SliceRecord)
+ *   - per slice: audio, F0 and mel (frame-major) float32 arrays, each starting
+ *     on a 16-byte boundary
+ * A dataset.json manifest lists the sources, shards and settings.
+ *
+ * Files are spread over worker threads, each with its own analysers and shards.
+ */
+class DatasetBuilder {
+public:
+    struct Settings {
+        double sampleRate = 40000.0;        // Model rate the audio is resampled to
+        int fftSize = 2048;
+        int hopSize = 512;
+        int numMelBands = 80;
+
+        float silenceThresholdDb = -40.0f;  // Below the take's loudest window
+        float minSilenceSeconds = 0.3f;     // Shorter pauses don't split
+        float keepSilenceSeconds = 0.1f;    // Kept either side of a split
+        float minSliceSeconds = 1.0f;       // Shorter slices are dropped
+        float maxSliceSeconds = 4.0f;       // Longer ones are cut into equal parts
+
+        float targetLoudnessDb = -20.0f;    // RMS of the slice's non-silent windows
+        float peakCeiling = 0.95f;
+        float maxGainDb = 30.0f;
+
+        int numThreads = 0;                 // 0 = all cores
+        int64_t maxShardBytes = 64LL * 1024 * 1024;
+    };
+
+    struct Summary {
+        int numFiles = 0;
+        int numFailedFiles = 0;
+        int numSlices = 0;
+        int numShards = 0;
+        int64_t numFrames = 0;
+        double sourceSeconds = 0.0;  // Audio read
+        double sliceSeconds = 0.0;   // Audio kept
+        double cpuSeconds = 0.0;     // Summed over workers
+        double wallSeconds = 0.0;
+        std::vector<std::string> errors;
+    };
+
+    /**
+     * Read-only view of a shard, backed by a memory-mapped file.
+     */
+    class Shard {
+    public:
+        struct Slice {
+            const float* audio;
+            int numSamples;
+            const float* f0;   // numFrames values, Hz (0 when unvoiced)
+            const float* mel;  // numFrames x numMelBands
+            int numFrames;
+            int sourceIndex;   // Into the manifest's source list
+            int sourceStart;   // First sample in the resampled source
+        };
+
+        /**
+         * Map a shard.
+         * @return nullptr if it is missing or damaged
+         */
+        static std::unique_ptr<Shard> open(const juce::File& file);
+
+        int getNumSlices() const { return (int)slices.size(); }
+        const Slice& getSlice(int index) const { return slices[(size_t)index]; }
+
+        int getSampleRate() const { return params[0]; }
+        int getFFTSize() const { return params[1]; }
+        int getHopSize() const { return params[2]; }
+        int getNumMelBands() const { return params[3]; }
+
+    private:
+        std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+        std::vector<Slice> slices;
+        int32_t params[4] = {};
+    };
+
+    using ProgressCallback = std::function<void(float progress)>;
+    using CancelCheck = std::function<bool()>;
+
+    DatasetBuilder() = default;
+
+    void setSettings(const Settings& newSettings) { settings = newSettings; }
+    const Settings& getSettings() const { return settings; }
+
+    /** Documents/VocalSuitePro/Renders, where captures are saved */
+    static juce::File getCaptureDirectory();
+
+    /** Documents/VocalSuitePro/Datasets */
+    static juce::File getDefaultOutputDirectory();
+
+    /** The capture_*.wav takes in a folder, oldest first */
+    static juce::Array<juce::File> findCaptures(const juce::File& directory);
+
+    /**
+     * Process every input into shards plus dataset.json in outputDir.
+     * Files that can't be read are skipped and listed in the summary.
+     * @param progress Called from worker threads with the fraction of files done
+     * @param shouldCancel Polled between slices
+     * @return false if nothing was written, or the build was cancelled
+     */
+    bool build(const juce::Array<juce::File>& inputs, const juce::File& outputDir,
+               Summary& summary,
+               ProgressCallback progress = nullptr, CancelCheck shouldCancel = nullptr);
+
+    /**
+     * Split positions for a take: [start, end) sample ranges at the model rate.
+     */
+    std::vector<std::pair<int, int>> findSlices(const float* audio, int numSamples) const;
+
+private:
+    Settings settings;
+
+    // On-disk slice table entry
+    struct SliceRecord {
+        uint64_t offset;        // Of the audio; F0 and mel follow, each 16-byte aligned
+        uint32_t numSamples;
+        uint32_t numFrames;
+        uint32_t sourceIndex;
+        uint32_t sourceStart;
+        uint64_t reserved;
+    };
+
+    // Analysis state and the shard being filled, one per worker thread
+    struct Worker {
+        Worker(const Settings& settings, int index);
+
+        int index;
+        PitchDetector pitchDetector;
+        F0Extractor f0Extractor;
+        MelSpectrogram melSpec;
+        juce::AudioFormatManager formats;
+
+        std::vector<float> audio;
+        std::vector<float> slice;
+        std::vector<float> f0;
+        std::vector<float> mel;
+
+        std::vector<SliceRecord> records;
+        std::vector<char> data;  // Slice arrays, offsets relative to the data block
+        int numShardsWritten = 0;
+    };
+
+    struct BuildState {
+        const juce::Array<juce::File>* inputs;
+        juce::File outputDir;
+        ProgressCallback progress;
+        CancelCheck shouldCancel;
+
+        std::atomic<int> nextInput { 0 };
+        std::atomic<int> filesDone { 0 };
+        std::atomic<bool> cancelled { false };
+
+        std::mutex lock;
+        Summary* summary;
+        std::vector<std::pair<std::string, int>> shards;  // File name, slice count
+    };
+
+    void runWorker(Worker& worker, BuildState& state);
+
+    bool readSource(Worker& worker, const juce::File& file, double& sourceSeconds, std::string& error);
+
+    // Resample worker.audio from sourceRate to the model rate
+    void resample(Worker& worker, double sourceRate);
+
+    // Normalise, analyse and queue one slice; the shard is flushed when full
+    void addSlice(Worker& worker, BuildState& state, int sourceIndex, int start, int end);
+
+    bool flushShard(Worker& worker, BuildState& state);
+
+    bool writeManifest(BuildState& state) const;
+};
+
+} // namespace blink
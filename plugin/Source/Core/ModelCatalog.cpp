@@ -0,0 +1,797 @@
+#include "ModelCatalog.h"
+#include "../AI/ONNXInference.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <map>
+
+#include <juce_cryptography/juce_cryptography.h>
+
+namespace blink {
+
+namespace {
+
+constexpr const char* indexFileName = ".catalog.json";
+constexpr int indexVersion = 2;  // 2: mel bands read from the bands axis
+
+// ONNX protobuf field numbers (onnx.proto3)
+constexpr uint32_t modelProducerName = 2;
+constexpr uint32_t modelGraph = 7;
+constexpr uint32_t modelMetadataProps = 14;
+constexpr uint32_t graphInitializer = 5;
+constexpr uint32_t graphInput = 11;
+constexpr uint32_t graphOutput = 12;
+constexpr uint32_t tensorProtoName = 8;
+constexpr uint32_t valueInfoName = 1;
+constexpr uint32_t valueInfoType = 2;
+constexpr uint32_t typeTensorType = 1;
+constexpr uint32_t tensorTypeElementType = 1;
+constexpr uint32_t tensorTypeShape = 2;
+constexpr uint32_t shapeDim = 1;
+constexpr uint32_t dimensionValue = 1;
+constexpr uint32_t entryKey = 1;
+constexpr uint32_t entryValue = 2;
+
+constexpr uint32_t wireVarint = 0;
+constexpr uint32_t wireLengthDelimited = 2;
+
+/**
+ * Just enough of the protobuf wire format to walk a ModelProto. Nested
+ * messages are views into the mapped file, and anything not needed (weights,
+ * nodes) is skipped by its length without being read.
+ */
+class ProtoReader {
+public:
+    ProtoReader() : pos(nullptr), end(nullptr) {}
+    ProtoReader(const uint8_t* data, size_t size) : pos(data), end(data + size) {}
+
+    bool atEnd() const { return pos >= end; }
+
+    bool nextField(uint32_t& field, uint32_t& wireType) {
+        uint64_t key;
+        if (!readVarint(key)) {
+            return false;
+        }
+        field = (uint32_t)(key >> 3);
+        wireType = (uint32_t)(key & 7);
+        return field != 0;
+    }
+
+    bool readVarint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+            const uint8_t byte = *pos++;
+            value |= (uint64_t)(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readMessage(ProtoReader& nested) {
+        uint64_t length;
+        if (!readVarint(length) || length > (uint64_t)(end - pos)) {
+            return false;
+        }
+        nested = ProtoReader(pos, (size_t)length);
+        pos += length;
+        return true;
+    }
+
+    bool readString(std::string& value) {
+        ProtoReader nested;
+        if (!readMessage(nested)) {
+            return false;
+        }
+        value.assign((const char*)nested.pos, (size_t)(nested.end - nested.pos));
+        return true;
+    }
+
+    bool skip(uint32_t wireType) {
+        switch (wireType) {
+            case 0: {
+                uint64_t value;
+                return readVarint(value);
+            }
+            case 1:
+                return advance(8);
+            case 2: {
+                ProtoReader nested;
+                return readMessage(nested);
+            }
+            case 5:
+                return advance(4);
+            default:
+                return false; // Groups; ONNX doesn't use them
+        }
+    }
+
+private:
+    const uint8_t* pos;
+    const uint8_t* end;
+
+    bool advance(size_t numBytes) {
+        if ((size_t)(end - pos) < numBytes) {
+            return false;
+        }
+        pos += numBytes;
+        return true;
+    }
+};
+
+bool parseShape(ProtoReader reader, std::vector<int64_t>& shape) {
+    uint32_t field, wireType;
+    while (!reader.atEnd()) {
+        if (!reader.nextField(field, wireType)) {
+            return false;
+        }
+
+        if (field == shapeDim && wireType == wireLengthDelimited) {
+            ProtoReader dimension;
+            if (!reader.readMessage(dimension)) {
+                return false;
+            }
+
+            // A named (symbolic) dimension has no value
+            int64_t size = -1;
+            while (!dimension.atEnd()) {
+                uint32_t dimField, dimWireType;
+                if (!dimension.nextField(dimField, dimWireType)) {
+                    return false;
+                }
+                uint64_t value;
+                if (dimField == dimensionValue && dimWireType == wireVarint) {
+                    if (!dimension.readVarint(value)) {
+                        return false;
+                    }
+                    size = (int64_t)value;
+                } else if (!dimension.skip(dimWireType)) {
+                    return false;
+                }
+            }
+            shape.push_back(size);
+        } else if (!reader.skip(wireType)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parseValueInfo(ProtoReader reader, ModelCatalog::TensorInfo& tensor) {
+    uint32_t field, wireType;
+    while (!reader.atEnd()) {
+        if (!reader.nextField(field, wireType)) {
+            return false;
+        }
+
+        if (field == valueInfoName && wireType == wireLengthDelimited) {
+            if (!reader.readString(tensor.name)) {
+                return false;
+            }
+        } else if (field == valueInfoType && wireType == wireLengthDelimited) {
+            ProtoReader type;
+            if (!reader.readMessage(type)) {
+                return false;
+            }
+
+            // Only tensor types matter; sequences and maps are left undescribed
+            while (!type.atEnd()) {
+                uint32_t typeField, typeWireType;
+                if (!type.nextField(typeField, typeWireType)) {
+                    return false;
+                }
+                if (typeField != typeTensorType || typeWireType != wireLengthDelimited) {
+                    if (!type.skip(typeWireType)) {
+                        return false;
+                    }
+                    continue;
+                }
+
+                ProtoReader tensorType;
+                if (!type.readMessage(tensorType)) {
+                    return false;
+                }
+                while (!tensorType.atEnd()) {
+                    uint32_t tensorField, tensorWireType;
+                    if (!tensorType.nextField(tensorField, tensorWireType)) {
+                        return false;
+                    }
+                    uint64_t value;
+                    if (tensorField == tensorTypeElementType && tensorWireType == wireVarint) {
+                        if (!tensorType.readVarint(value)) {
+                            return false;
+                        }
+                        tensor.elementType = (int)value;
+                    } else if (tensorField == tensorTypeShape && tensorWireType == wireLengthDelimited) {
+                        ProtoReader shape;
+                        if (!tensorType.readMessage(shape) || !parseShape(shape, tensor.shape)) {
+                            return false;
+                        }
+                    } else if (!tensorType.skip(tensorWireType)) {
+                        return false;
+                    }
+                }
+            }
+        } else if (!reader.skip(wireType)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parseInitializerName(ProtoReader reader, std::string& name) {
+    uint32_t field, wireType;
+    while (!reader.atEnd()) {
+        if (!reader.nextField(field, wireType)) {
+            return false;
+        }
+        if (field == tensorProtoName && wireType == wireLengthDelimited) {
+            return reader.readString(name);
+        }
+        if (!reader.skip(wireType)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parseGraph(ProtoReader reader, std::vector<ModelCatalog::TensorInfo>& inputs,
+                std::vector<ModelCatalog::TensorInfo>& outputs, std::vector<std::string>& initializers) {
+    uint32_t field, wireType;
+    while (!reader.atEnd()) {
+        if (!reader.nextField(field, wireType)) {
+            return false;
+        }
+
+        if ((field == graphInput || field == graphOutput) && wireType == wireLengthDelimited) {
+            ProtoReader valueInfo;
+            ModelCatalog::TensorInfo tensor;
+            if (!reader.readMessage(valueInfo) || !parseValueInfo(valueInfo, tensor)) {
+                return false;
+            }
+            (field == graphInput ? inputs : outputs).push_back(std::move(tensor));
+        } else if (field == graphInitializer && wireType == wireLengthDelimited) {
+            ProtoReader initializer;
+            std::string name;
+            if (!reader.readMessage(initializer) || !parseInitializerName(initializer, name)) {
+                return false;
+            }
+            initializers.push_back(std::move(name));
+        } else if (!reader.skip(wireType)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parseMetadataEntry(ProtoReader reader, std::string& key, std::string& value) {
+    uint32_t field, wireType;
+    while (!reader.atEnd()) {
+        if (!reader.nextField(field, wireType)) {
+            return false;
+        }
+        if (field == entryKey && wireType == wireLengthDelimited) {
+            if (!reader.readString(key)) {
+                return false;
+            }
+        } else if (field == entryValue && wireType == wireLengthDelimited) {
+            if (!reader.readString(value)) {
+                return false;
+            }
+        } else if (!reader.skip(wireType)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isVariantFile(const juce::File& file) {
+    const juce::String name = file.getFileName().toLowerCase();
+    return name.endsWith(".int8.onnx") || name.endsWith(".fp16.onnx");
+}
+
+juce::var shapeToVar(const std::vector<int64_t>& shape) {
+    juce::Array<juce::var> dims;
+    for (int64_t dim : shape) {
+        dims.add(juce::var((juce::int64)dim));
+    }
+    return juce::var(dims);
+}
+
+juce::var tensorsToVar(const std::vector<ModelCatalog::TensorInfo>& tensors) {
+    juce::Array<juce::var> list;
+    for (const auto& tensor : tensors) {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("name", juce::String(tensor.name));
+        object->setProperty("type", tensor.elementType);
+        object->setProperty("shape", shapeToVar(tensor.shape));
+        list.add(juce::var(object));
+    }
+    return juce::var(list);
+}
+
+void tensorsFromVar(const juce::var& value, std::vector<ModelCatalog::TensorInfo>& tensors) {
+    if (auto* list = value.getArray()) {
+        for (const auto& item : *list) {
+            ModelCatalog::TensorInfo tensor;
+            tensor.name = item.getProperty("name", "").toString().toStdString();
+            tensor.elementType = (int)item.getProperty("type", 0);
+            if (auto* dims = item.getProperty("shape", juce::var()).getArray()) {
+                for (const auto& dim : *dims) {
+                    tensor.shape.push_back((int64_t)(juce::int64)dim);
+                }
+            }
+            tensors.push_back(std::move(tensor));
+        }
+    }
+}
+
+} // namespace
+
+ModelCatalog::ModelCatalog(const juce::File& directory, int expectedMelBands)
+    : directory(directory), expectedMelBands(expectedMelBands), generation(0),
+      scanRunning(false), rescanRequested(false), stopping(false) {
+    // Last session's index lists the models straight away; a scan refreshes it
+    models = readIndex();
+}
+
+ModelCatalog::~ModelCatalog() {
+    {
+        std::lock_guard<std::mutex> guard(threadLock);
+        stopping = true;
+    }
+    if (scanThread.joinable()) {
+        scanThread.join();
+    }
+}
+
+juce::File ModelCatalog::getDefaultDirectory() {
+    return juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+        .getChildFile("VocalSuitePro")
+        .getChildFile("Models");
+}
+
+std::shared_ptr<ModelCatalog> ModelCatalog::getShared() {
+    static std::mutex sharedLock;
+    static std::weak_ptr<ModelCatalog> sharedCatalog;
+
+    std::lock_guard<std::mutex> guard(sharedLock);
+
+    std::shared_ptr<ModelCatalog> catalog = sharedCatalog.lock();
+    if (catalog == nullptr) {
+        catalog = std::make_shared<ModelCatalog>(getDefaultDirectory());
+        sharedCatalog = catalog;
+
+        // Once per process rather than once per plugin instance
+        catalog->scanAsync();
+    }
+    return catalog;
+}
+
+void ModelCatalog::setChangeCallback(ChangeCallback callback) {
+    std::lock_guard<std::mutex> guard(callbackLock);
+    changeCallback = std::move(callback);
+}
+
+void ModelCatalog::scanAsync() {
+    std::lock_guard<std::mutex> guard(threadLock);
+    if (stopping) {
+        return;
+    }
+
+    if (scanRunning) {
+        rescanRequested = true;
+        return;
+    }
+
+    if (scanThread.joinable()) {
+        scanThread.join();
+    }
+
+    scanRunning = true;
+    scanThread = std::thread([this] {
+        for (;;) {
+            scan();
+
+            std::lock_guard<std::mutex> threadGuard(threadLock);
+            if (!rescanRequested || stopping) {
+                scanRunning = false;
+                return;
+            }
+            rescanRequested = false;
+        }
+    });
+}
+
+bool ModelCatalog::scan() {
+    std::lock_guard<std::mutex> scanGuard(scanLock);
+
+    std::map<std::string, ModelInfo> previous;
+    for (auto& info : getModels()) {
+        const std::string fileName = juce::File(info.path).getFileName().toStdString();
+        previous[fileName] = std::move(info);
+    }
+
+    std::vector<ModelInfo> found;
+    std::map<std::string, std::vector<std::string>> variants; // Base file stem -> variant file names
+
+    for (const auto& file : directory.findChildFiles(juce::File::findFiles, false, "*.onnx;*.pth")) {
+        if (stopping) {
+            return false;
+        }
+
+        if (isVariantFile(file)) {
+            const juce::String name = file.getFileName();
+            variants[name.dropLastCharacters(10).toStdString()].push_back(name.toStdString());
+            continue;
+        }
+
+        const int64_t size = file.getSize();
+        const int64_t modified = file.getLastModificationTime().toMilliseconds();
+
+        ModelInfo info;
+        auto known = previous.find(file.getFileName().toStdString());
+
+        if (known != previous.end() && known->second.sizeBytes == size) {
+            if (known->second.modifiedMs == modified) {
+                info = known->second;
+            } else {
+                // Touched but possibly unchanged: the contents decide
+                const std::string hash = juce::SHA256(file).toHexString().toStdString();
+                if (hash == known->second.hash) {
+                    info = known->second;
+                    info.modifiedMs = modified;
+                } else {
+                    info.hash = hash;
+                    describeModel(file, info);
+                }
+            }
+        } else {
+            describeModel(file, info);
+        }
+
+        info.path = file.getFullPathName().toStdString();
+        info.variants.clear();
+        found.push_back(std::move(info));
+    }
+
+    for (auto& info : found) {
+        auto list = variants.find(info.id);
+        if (info.format == "onnx" && list != variants.end()) {
+            info.variants = list->second;
+            std::sort(info.variants.begin(), info.variants.end());
+        }
+    }
+
+    std::sort(found.begin(), found.end(), [](const ModelInfo& a, const ModelInfo& b) {
+        return a.id != b.id ? a.id < b.id : a.format < b.format;
+    });
+
+    // Compare through the index form, which holds everything that matters
+    juce::Array<juce::var> entries, currentEntries;
+    for (const auto& info : found) {
+        entries.add(toVar(info));
+    }
+    for (const auto& info : getModels()) {
+        currentEntries.add(toVar(info));
+    }
+
+    const bool changed = juce::JSON::toString(juce::var(entries)) != juce::JSON::toString(juce::var(currentEntries));
+
+    writeIndex(found);
+
+    if (changed) {
+        {
+            std::lock_guard<std::mutex> guard(modelsLock);
+            models = std::move(found);
+        }
+        generation++;
+
+        std::lock_guard<std::mutex> guard(callbackLock);
+        if (changeCallback) {
+            changeCallback();
+        }
+    }
+
+    return changed;
+}
+
+bool ModelCatalog::setChosenVariant(const std::string& modelPath, const std::string& variant,
+                                    const std::string& fingerprint) {
+    // Serialised with scans, so a scan in progress can't write its list over the choice
+    std::lock_guard<std::mutex> scanGuard(scanLock);
+
+    std::vector<ModelInfo> updated;
+    {
+        std::lock_guard<std::mutex> guard(modelsLock);
+
+        auto model = std::find_if(models.begin(), models.end(), [&](const ModelInfo& info) {
+            return juce::File(info.path) == juce::File(modelPath);
+        });
+        if (model == models.end()) {
+            return false;
+        }
+
+        model->chosenVariant = variant;
+        model->variantFingerprint = fingerprint;
+        updated = models;
+    }
+
+    writeIndex(updated);
+    return true;
+}
+
+std::vector<ModelCatalog::ModelInfo> ModelCatalog::getModels() const {
+    std::lock_guard<std::mutex> guard(modelsLock);
+    return models;
+}
+
+bool ModelCatalog::findModel(const std::string& idOrFileName, ModelInfo& info) const {
+    std::lock_guard<std::mutex> guard(modelsLock);
+
+    const ModelInfo* match = nullptr;
+    for (const auto& model : models) {
+        if (model.id == idOrFileName) {
+            // ONNX runs the real model; .pth only gets the vocoder
+            if (match == nullptr || model.format == "onnx") {
+                match = &model;
+            }
+        } else if (juce::File(model.path).getFileName().toStdString() == idOrFileName) {
+            match = &model;
+            break;
+        }
+    }
+
+    if (match == nullptr) {
+        return false;
+    }
+
+    info = *match;
+    return true;
+}
+
+bool ModelCatalog::readOnnxGraph(const juce::File& file, ModelInfo& info) {
+    juce::MemoryMappedFile mapped(file, juce::MemoryMappedFile::readOnly);
+    if (mapped.getData() == nullptr || mapped.getSize() == 0) {
+        info.problem = "Cannot read the file";
+        return false;
+    }
+
+    ProtoReader reader((const uint8_t*)mapped.getData(), mapped.getSize());
+    std::vector<TensorInfo> inputs, outputs;
+    std::vector<std::string> initializers;
+    std::map<std::string, std::string> metadata;
+    bool hasGraph = false;
+
+    while (!reader.atEnd()) {
+        uint32_t field, wireType;
+        bool ok = reader.nextField(field, wireType);
+
+        if (ok && field == modelGraph && wireType == wireLengthDelimited) {
+            ProtoReader graph;
+            ok = reader.readMessage(graph) && parseGraph(graph, inputs, outputs, initializers);
+            hasGraph = ok;
+        } else if (ok && field == modelProducerName && wireType == wireLengthDelimited) {
+            ok = reader.readString(info.producer);
+        } else if (ok && field == modelMetadataProps && wireType == wireLengthDelimited) {
+            ProtoReader entry;
+            std::string key, value;
+            ok = reader.readMessage(entry) && parseMetadataEntry(entry, key, value);
+            metadata[key] = value;
+        } else if (ok) {
+            ok = reader.skip(wireType);
+        }
+
+        if (!ok) {
+            info.problem = "Not a valid ONNX model";
+            return false;
+        }
+    }
+
+    if (!hasGraph) {
+        info.problem = "Not a valid ONNX model";
+        return false;
+    }
+
+    // Older exporters also list weights as graph inputs; they aren't fed by the caller
+    inputs.erase(std::remove_if(inputs.begin(), inputs.end(), [&](const TensorInfo& tensor) {
+        return std::find(initializers.begin(), initializers.end(), tensor.name) != initializers.end();
+    }), inputs.end());
+
+    info.inputs = std::move(inputs);
+    info.outputs = std::move(outputs);
+
+    // Same conventions ONNXInference runs the model with: F0 first, then mel
+    // [batch, bands, frames], and a negative leading dimension for dynamic batching
+    info.dynamicBatch = !info.inputs.empty() && !info.inputs[0].shape.empty() && info.inputs[0].shape[0] < 0;
+    info.numMelBands = 0;
+    if (info.inputs.size() >= 2 && info.inputs[1].shape.size() == 3) {
+        const int64_t bands = info.inputs[1].shape[(size_t)ONNXInference::melBandsAxis];
+        info.numMelBands = (bands > 0) ? (int)bands : 0;
+    }
+
+    info.sampleRate = 0;
+    for (const char* key : { "sample_rate", "sampling_rate", "sr" }) {
+        auto entry = metadata.find(key);
+        if (entry != metadata.end()) {
+            info.sampleRate = std::max(0, std::atoi(entry->second.c_str()));
+            break;
+        }
+    }
+
+    return true;
+}
+
+int ModelCatalog::getSampleRateFromFileName(const std::string& path) {
+    const size_t slash = path.find_last_of("/\\");
+    std::string name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+    static const std::pair<const char*, int> tags[] = {
+        { "16k", 16000 }, { "22k", 22050 }, { "24k", 24000 }, { "32k", 32000 },
+        { "40k", 40000 }, { "44k", 44100 }, { "48k", 48000 }
+    };
+
+    for (const auto& tag : tags) {
+        size_t pos = name.find(tag.first);
+        while (pos != std::string::npos) {
+            // Don't match the tail of a longer number ("116k")
+            if (pos == 0 || !std::isdigit((unsigned char)name[pos - 1])) {
+                return tag.second;
+            }
+            pos = name.find(tag.first, pos + 1);
+        }
+    }
+    return 0;
+}
+
+juce::File ModelCatalog::getIndexFile() const {
+    return directory.getChildFile(indexFileName);
+}
+
+std::vector<ModelCatalog::ModelInfo> ModelCatalog::readIndex() const {
+    std::vector<ModelInfo> entries;
+
+    const juce::var index = juce::JSON::parse(getIndexFile());
+    if ((int)index.getProperty("version", 0) != indexVersion) {
+        return entries;
+    }
+
+    if (auto* list = index.getProperty("models", juce::var()).getArray()) {
+        for (const auto& item : *list) {
+            ModelInfo info;
+            if (fromVar(item, info)) {
+                info.path = directory.getChildFile(item.getProperty("file", "").toString()).getFullPathName().toStdString();
+                entries.push_back(std::move(info));
+            }
+        }
+    }
+
+    return entries;
+}
+
+void ModelCatalog::writeIndex(const std::vector<ModelInfo>& entries) const {
+    if (!directory.isDirectory()) {
+        return;
+    }
+
+    juce::Array<juce::var> list;
+    for (const auto& info : entries) {
+        list.add(toVar(info));
+    }
+
+    auto* index = new juce::DynamicObject();
+    index->setProperty("version", indexVersion);
+    index->setProperty("models", juce::var(list));
+
+    const juce::String text = juce::JSON::toString(juce::var(index));
+    const juce::File indexFile = getIndexFile();
+    if (indexFile.loadFileAsString() != text) {
+        indexFile.replaceWithText(text);
+    }
+}
+
+void ModelCatalog::describeModel(const juce::File& file, ModelInfo& info) const {
+    info.id = file.getFileNameWithoutExtension().toStdString();
+    info.path = file.getFullPathName().toStdString();
+    info.format = file.hasFileExtension("onnx") ? "onnx" : "pth";
+    info.sizeBytes = file.getSize();
+    info.modifiedMs = file.getLastModificationTime().toMilliseconds();
+    if (info.hash.empty()) {
+        info.hash = juce::SHA256(file).toHexString().toStdString();
+    }
+
+    info.problem.clear();
+    const bool readable = info.format != "onnx" || readOnnxGraph(file, info);
+
+    if (info.sampleRate == 0) {
+        info.sampleRate = getSampleRateFromFileName(info.path);
+    }
+
+    info.valid = readable;
+    if (readable) {
+        validate(info);
+    }
+}
+
+void ModelCatalog::validate(ModelInfo& info) const {
+    // .pth models have no graph to check; they convert through the vocoder
+    if (info.format != "onnx") {
+        return;
+    }
+
+    if (info.inputs.size() < 2 || info.outputs.empty()) {
+        info.valid = false;
+        info.problem = "Needs F0 and mel inputs and an audio output";
+    } else if ((info.inputs[0].elementType != 0 && info.inputs[0].elementType != 1)
+               || (info.inputs[1].elementType != 0 && info.inputs[1].elementType != 1)) {
+        info.valid = false;
+        info.problem = "Inputs must be float32";
+    } else if (info.numMelBands > 0 && info.numMelBands != expectedMelBands) {
+        info.valid = false;
+        info.problem = "Expects " + std::to_string(info.numMelBands) + " mel bands; the converter produces "
+                     + std::to_string(expectedMelBands);
+    }
+}
+
+juce::var ModelCatalog::toVar(const ModelInfo& info) {
+    auto* object = new juce::DynamicObject();
+    object->setProperty("file", juce::File(info.path).getFileName());
+    object->setProperty("id", juce::String(info.id));
+    object->setProperty("format", juce::String(info.format));
+    object->setProperty("size", (juce::int64)info.sizeBytes);
+    object->setProperty("modified", (juce::int64)info.modifiedMs);
+    object->setProperty("hash", juce::String(info.hash));
+    object->setProperty("producer", juce::String(info.producer));
+    object->setProperty("inputs", tensorsToVar(info.inputs));
+    object->setProperty("outputs", tensorsToVar(info.outputs));
+    object->setProperty("melBands", info.numMelBands);
+    object->setProperty("sampleRate", info.sampleRate);
+    object->setProperty("dynamicBatch", info.dynamicBatch);
+
+    juce::Array<juce::var> variants;
+    for (const auto& variant : info.variants) {
+        variants.add(juce::String(variant));
+    }
+    object->setProperty("variants", juce::var(variants));
+    object->setProperty("chosenVariant", juce::String(info.chosenVariant));
+    object->setProperty("variantFingerprint", juce::String(info.variantFingerprint));
+
+    object->setProperty("valid", info.valid);
+    object->setProperty("problem", juce::String(info.problem));
+    return juce::var(object);
+}
+
+bool ModelCatalog::fromVar(const juce::var& value, ModelInfo& info) {
+    if (!value.isObject() || value.getProperty("file", "").toString().isEmpty()) {
+        return false;
+    }
+
+    info.id = value.getProperty("id", "").toString().toStdString();
+    info.format = value.getProperty("format", "").toString().toStdString();
+    info.sizeBytes = (int64_t)(juce::int64)value.getProperty("size", 0);
+    info.modifiedMs = (int64_t)(juce::int64)value.getProperty("modified", 0);
+    info.hash = value.getProperty("hash", "").toString().toStdString();
+    info.producer = value.getProperty("producer", "").toString().toStdString();
+    tensorsFromVar(value.getProperty("inputs", juce::var()), info.inputs);
+    tensorsFromVar(value.getProperty("outputs", juce::var()), info.outputs);
+    info.numMelBands = (int)value.getProperty("melBands", 0);
+    info.sampleRate = (int)value.getProperty("sampleRate", 0);
+    info.dynamicBatch = (bool)value.getProperty("dynamicBatch", false);
+
+    if (auto* variants = value.getProperty("variants", juce::var()).getArray()) {
+        for (const auto& variant : *variants) {
+            info.variants.push_back(variant.toString().toStdString());
+        }
+    }
+    info.chosenVariant = value.getProperty("chosenVariant", "").toString().toStdString();
+    info.variantFingerprint = value.getProperty("variantFingerprint", "").toString().toStdString();
+
+    info.valid = (bool)value.getProperty("valid", false);
+    info.problem = value.getProperty("problem", "").toString().toStdString();
+    return true;
+}
+
+} // namespace blink
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace blink {
+
+/**
+ * Index of the voice models in a folder, readable without creating sessions.
+ *
+ * A scan lists every .onnx and .pth model (quantized ".int8.onnx" and
+ * ".fp16.onnx" copies are recorded as variants of their base model). For ONNX
+ * files, the graph's inputs, outputs and metadata are read straight from the
+ * protobuf, skipping the weights. That takes milliseconds, not the seconds
+ * an inference session needs.
+ *
+ * Results are kept in a ".catalog.json" index in the folder, along with the
+ * variant benchmarked as fastest for each model. An entry is reused
+ * while its file's size and modification time are unchanged; if only the time
+ * changed, the contents are hashed and the entry is kept when the hash matches.
+ *
+ * Scans run on a background thread; readers always see the last complete list.
+ */
+class ModelCatalog {
+public:
+    struct TensorInfo {
+        std::string name;
+        int elementType = 0;         // ONNX TensorProto data type (1 = float)
+        std::vector<int64_t> shape;  // -1 for symbolic or unknown dimensions
+    };
+
+    struct ModelInfo {
+        std::string id;              // File name without extension
+        std::string path;
+        std::string format;          // "onnx" or "pth"
+        int64_t sizeBytes = 0;
+        int64_t modifiedMs = 0;
+        std::string hash;            // SHA-256 of the file contents
+
+        std::vector<TensorInfo> inputs;
+        std::vector<TensorInfo> outputs;
+        std::string producer;
+        int numMelBands = 0;         // Bands axis of the mel input, 0 if unknown
+        int sampleRate = 0;          // From metadata or the file name, 0 if unknown
+        bool dynamicBatch = false;
+        std::vector<std::string> variants;  // Quantized copies beside it (file names)
+        std::string chosenVariant;          // File name of the copy that runs, empty until benchmarked
+        std::string variantFingerprint;     // Files and tolerance the choice was made with
+
+        bool valid = false;
+        std::string problem;         // Why it can't be used, when not valid
+    };
+
+    /** Called on the scan thread after a scan that changed the list. */
+    using ChangeCallback = std::function<void()>;
+
+    /**
+     * @param directory Folder holding the models (need not exist yet)
+     * @param expectedMelBands Mel bands the converter produces; models expecting
+     *                         a different count are marked invalid
+     */
+    explicit ModelCatalog(const juce::File& directory, int expectedMelBands = 80);
+    ~ModelCatalog();
+
+    /** Documents/VocalSuitePro/Models */
+    static juce::File getDefaultDirectory();
+
+    /**
+     * The catalog of the default directory shared by every plugin instance,
+     * created (and scanned in the background) on first use.
+     */
+    static std::shared_ptr<ModelCatalog> getShared();
+
+    const juce::File& getDirectory() const { return directory; }
+
+    void setChangeCallback(ChangeCallback callback);
+
+    /**
+     * Rescan on the background thread; returns immediately. A request made
+     * while a scan is running starts another once it finishes.
+     */
+    void scanAsync();
+
+    /**
+     * Rescan on the calling thread.
+     * @return true if the list changed
+     */
+    bool scan();
+
+    /** The models found by the last scan, sorted by id. */
+    std::vector<ModelInfo> getModels() const;
+
+    /**
+     * Look a model up by id (preferring ONNX over .pth) or by file name.
+     * @return false if the last scan didn't find it
+     */
+    bool findModel(const std::string& idOrFileName, ModelInfo& info) const;
+
+    /**
+     * Record which file runs for a model (its own or one of its variants), with
+     * a fingerprint of what the choice was made with, and rewrite the index.
+     * The choice is dropped when a scan finds the model file changed.
+     * @return false if the last scan didn't find a model at that path
+     */
+    bool setChosenVariant(const std::string& modelPath, const std::string& variant,
+                          const std::string& fingerprint);
+
+    /** Incremented by every scan that changes the list. */
+    int getGeneration() const { return generation.load(); }
+
+    /**
+     * Read an ONNX file's graph inputs, outputs and metadata without building
+     * a session. Fills the tensor and metadata fields of info.
+     * @return false with info.problem set if the file isn't a readable model
+     */
+    static bool readOnnxGraph(const juce::File& file, ModelInfo& info);
+
+    /**
+     * Sample rate from a tag in a model's file name, e.g. "singer_40k.onnx".
+     * @return Rate in Hz, or 0 if there is none
+     */
+    static int getSampleRateFromFileName(const std::string& path);
+
+private:
+    juce::File directory;
+    int expectedMelBands;
+
+    mutable std::mutex modelsLock;
+    std::vector<ModelInfo> models;
+    std::atomic<int> generation;
+
+    std::mutex callbackLock;
+    ChangeCallback changeCallback;
+
+    // Serialises scans, whether async or direct
+    std::mutex scanLock;
+
+    std::mutex threadLock;
+    std::thread scanThread;
+    std::atomic<bool> scanRunning;
+    std::atomic<bool> rescanRequested;
+    std::atomic<bool> stopping;
+
+    juce::File getIndexFile() const;
+
+    // Previously indexed entries keyed by file name
+    std::vector<ModelInfo> readIndex() const;
+    void writeIndex(const std::vector<ModelInfo>& entries) const;
+
+    // Fill in and validate a fresh entry for a model file
+    void describeModel(const juce::File& file, ModelInfo& info) const;
+    void validate(ModelInfo& info) const;
+
+    static juce::var toVar(const ModelInfo& info);
+    static bool fromVar(const juce::var& value, ModelInfo& info);
+};
+
+} // namespace blink
@@ -0,0 +1,73 @@
+#include "QualityGovernor.h"
+#include <algorithm>
+
+namespace blink {
+
+void QualityGovernor::prepare(double newSampleRate) {
+    sampleRate = newSampleRate;
+    numLoads = 0;
+    quietWindows = 0;
+    tier.store(FullQuality);
+    load.store(0.0f);
+    overruns.store(0);
+}
+
+void QualityGovernor::setBudget(float fraction) {
+    budget.store(juce::jlimit(0.05f, 1.0f, fraction));
+}
+
+void QualityGovernor::addBlock(double seconds, int numSamples) {
+    if (numSamples <= 0 || sampleRate <= 0.0) {
+        return;
+    }
+
+    const float blockLoad = (float)(seconds * sampleRate / numSamples);
+    if (blockLoad > 1.0f) {
+        overruns.fetch_add(1);
+    }
+
+    loads[numLoads++] = blockLoad;
+    if (numLoads == windowBlocks) {
+        evaluateWindow();
+        numLoads = 0;
+    }
+}
+
+void QualityGovernor::evaluateWindow() {
+    // 95th percentile: the fourth-slowest of 64 blocks
+    const int percentileIndex = (windowBlocks * 95) / 100;
+    sorted = loads;
+    std::nth_element(sorted.begin(), sorted.begin() + percentileIndex, sorted.end());
+    const float p95 = sorted[percentileIndex];
+    load.store(p95);
+
+    const float allowed = budget.load();
+    const int current = tier.load();
+
+    if (p95 > stepDownLoad * allowed) {
+        quietWindows = 0;
+        if (current < numTiers - 1) {
+            tier.store(current + 1);
+        }
+    } else if (p95 < stepUpLoad * allowed) {
+        // Climb back slowly, so a tier that only just fits isn't toggled every window
+        if (++quietWindows >= windowsBeforeStepUp && current > FullQuality) {
+            tier.store(current - 1);
+            quietWindows = 0;
+        }
+    } else {
+        quietWindows = 0;
+    }
+}
+
+const char* QualityGovernor::getTierName(int tier) {
+    switch (tier) {
+        case FullQuality:        return "full";
+        case EnvelopeFormants:   return "envelope formants";
+        case DecimatedDetection: return "decimated detection";
+        case ReducedOverlap:     return "reduced overlap";
+        default:                 return "unknown";
+    }
+}
+
+} // namespace blink
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+
+namespace blink {
+
+/**
+ * Sheds DSP work when processBlock runs close to its deadline.
+ *
+ * Each block's processing time is measured against the audio it covers
+ * (numSamples / sampleRate). Every windowBlocks blocks the 95th percentile of
+ * that load is compared with the budget: above stepDownLoad the quality tier
+ * drops one step, and after windowsBeforeStepUp windows in a row below
+ * stepUpLoad it climbs back one step. Tiers are cumulative, each one adding a
+ * saving to those below it.
+ *
+ * The audio thread measures and reads the tier; any thread may read the tier
+ * and load for telemetry. Nothing here allocates or locks.
+ */
+class QualityGovernor {
+public:
+    enum Tier {
+        FullQuality = 0,
+        EnvelopeFormants,    // Smoothed-spectrum formants instead of LPC
+        DecimatedDetection,  // Pitch detection at half the sample rate
+        ReducedOverlap,      // Vocoder hop doubled (2x overlap instead of 4x)
+        numTiers
+    };
+
+    /** Times one block, from construction to destruction. */
+    class ScopedMeasurement {
+    public:
+        ScopedMeasurement(QualityGovernor& governor, int numSamples)
+            : governor(governor), numSamples(numSamples), startTicks(juce::Time::getHighResolutionTicks()) {}
+
+        ~ScopedMeasurement() {
+            const auto ticks = juce::Time::getHighResolutionTicks() - startTicks;
+            governor.addBlock(juce::Time::highResolutionTicksToSeconds(ticks), numSamples);
+        }
+
+        ScopedMeasurement(const ScopedMeasurement&) = delete;
+        ScopedMeasurement& operator=(const ScopedMeasurement&) = delete;
+
+    private:
+        QualityGovernor& governor;
+        int numSamples;
+        juce::int64 startTicks;
+    };
+
+    QualityGovernor() = default;
+
+    /** Call from prepareToPlay; returns to full quality and clears the history. */
+    void prepare(double sampleRate);
+
+    /**
+     * Share of each block's deadline this instance may use, 0..1 (default 0.5,
+     * leaving the rest for the host and other plugins).
+     */
+    void setBudget(float fraction);
+
+    /** Record one block's processing time. Audio thread only. */
+    void addBlock(double seconds, int numSamples);
+
+    /** Current tier, FullQuality when there is CPU to spare. */
+    int getTier() const { return tier.load(); }
+
+    /** 95th percentile load of the last window, as a fraction of the deadline. */
+    float getLoad() const { return load.load(); }
+
+    /** Blocks that took longer than their deadline since prepare(). */
+    int getOverruns() const { return overruns.load(); }
+
+    static const char* getTierName(int tier);
+
+private:
+    static constexpr int windowBlocks = 64;
+    static constexpr float stepDownLoad = 0.85f;   // Of the budget
+    static constexpr float stepUpLoad = 0.45f;
+    static constexpr int windowsBeforeStepUp = 4;
+
+    double sampleRate = 44100.0;
+    std::atomic<float> budget { 0.5f };
+
+    std::array<float, windowBlocks> loads {};
+    std::array<float, windowBlocks> sorted {};
+    int numLoads = 0;
+    int quietWindows = 0;
+
+    std::atomic<int> tier { FullQuality };
+    std::atomic<float> load { 0.0f };
+    std::atomic<int> overruns { 0 };
+
+    // p95 of the window just filled, then step the tier if it calls for it
+    void evaluateWindow();
+};
+
+} // namespace blink
@@ -0,0 +1,352 @@
+#include "RealtimeSafety.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if VOCALSUITE_RT_SAFETY_CHECKS
+ #if defined(__APPLE__) || defined(__linux__)
+  #include <execinfo.h>
+  #include <pthread.h>
+  #include <unistd.h>
+  #define VOCALSUITE_RT_HAS_BACKTRACE 1
+ #else
+  #include <cstdio>
+  #define VOCALSUITE_RT_HAS_BACKTRACE 0
+ #endif
+
+ #if defined(__linux__)
+  #include <dlfcn.h>
+ #endif
+
+ #if defined(__APPLE__)
+  #include <malloc/malloc.h>
+  #include <mach/mach.h>
+ #endif
+
+ // Thread-local state is touched from inside malloc, so it must not allocate
+ // on first access. initial-exec TLS avoids the lazy __tls_get_addr path.
+ #if defined(__linux__)
+  #define VOCALSUITE_RT_TLS static thread_local __attribute__((tls_model("initial-exec")))
+ #else
+  #define VOCALSUITE_RT_TLS static thread_local
+ #endif
+#endif
+
+namespace blink {
+
+#if VOCALSUITE_RT_SAFETY_CHECKS
+
+namespace {
+
+VOCALSUITE_RT_TLS int audioThreadDepth = 0;
+VOCALSUITE_RT_TLS int suspendDepth = 0;
+
+std::atomic<int> violationCount { 0 };
+std::atomic<int> currentMode { -1 }; // -1 = not yet read from the environment
+
+void writeToStderr(const char* text) {
+   #if VOCALSUITE_RT_HAS_BACKTRACE
+    ssize_t ignored = ::write(STDERR_FILENO, text, std::strlen(text));
+    (void) ignored;
+   #else
+    std::fputs(text, stderr);
+   #endif
+}
+
+void printStackTrace() {
+   #if VOCALSUITE_RT_HAS_BACKTRACE
+    // backtrace_symbols_fd writes straight to the fd without calling malloc
+    void* frames[64];
+    const int numFrames = ::backtrace(frames, 64);
+    ::backtrace_symbols_fd(frames, numFrames, STDERR_FILENO);
+   #endif
+}
+
+} // namespace
+
+void RealtimeSafety::setMode(Mode newMode) {
+    currentMode.store((int) newMode);
+}
+
+RealtimeSafety::Mode RealtimeSafety::getMode() {
+    int mode = currentMode.load();
+    if (mode < 0) {
+        const char* env = std::getenv("VOCALSUITE_RT_SAFETY");
+        mode = (env != nullptr && std::strcmp(env, "abort") == 0) ? (int) Mode::Abort
+                                                                  : (int) Mode::Report;
+        currentMode.store(mode);
+    }
+    return (Mode) mode;
+}
+
+bool RealtimeSafety::isCheckingThisThread() {
+    return audioThreadDepth > 0 && suspendDepth == 0;
+}
+
+int RealtimeSafety::getViolationCount() {
+    return violationCount.load();
+}
+
+void RealtimeSafety::resetViolationCount() {
+    violationCount.store(0);
+}
+
+void RealtimeSafety::checkAllowed(const char* operation) {
+    if (!isCheckingThisThread())
+        return;
+
+    // Everything below may allocate or lock (symbolisation, stdio), so stop
+    // checking until the report is out.
+    suspendChecks();
+
+    violationCount.fetch_add(1);
+
+    writeToStderr("[SwindleVX] Real-time violation on audio thread: ");
+    writeToStderr(operation);
+    writeToStderr("\n");
+    printStackTrace();
+
+    if (getMode() == Mode::Abort)
+        std::abort();
+
+    resumeChecks();
+}
+
+void RealtimeSafety::enterAudioThread() { ++audioThreadDepth; }
+void RealtimeSafety::exitAudioThread()  { --audioThreadDepth; }
+void RealtimeSafety::suspendChecks()    { ++suspendDepth; }
+void RealtimeSafety::resumeChecks()     { --suspendDepth; }
+
+#else
+
+void RealtimeSafety::setMode(Mode) {}
+RealtimeSafety::Mode RealtimeSafety::getMode() { return Mode::Report; }
+bool RealtimeSafety::isCheckingThisThread() { return false; }
+int RealtimeSafety::getViolationCount() { return 0; }
+void RealtimeSafety::resetViolationCount() {}
+void RealtimeSafety::checkAllowed(const char*) {}
+void RealtimeSafety::enterAudioThread() {}
+void RealtimeSafety::exitAudioThread() {}
+void RealtimeSafety::suspendChecks() {}
+void RealtimeSafety::resumeChecks() {}
+
+#endif
+
+} // namespace blink
+
+#if VOCALSUITE_RT_SAFETY_CHECKS
+
+//==============================================================================
+// Allocation interceptors
+
+namespace {
+
+// operator new reports once itself; the malloc underneath must not report again.
+void* checkedAllocate(std::size_t size, const char* operation) {
+    blink::RealtimeSafety::checkAllowed(operation);
+    blink::RealtimeSafety::ScopedAllow inner;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* checkedAllocateAligned(std::size_t size, std::size_t alignment, const char* operation) {
+    blink::RealtimeSafety::checkAllowed(operation);
+    blink::RealtimeSafety::ScopedAllow inner;
+    void* ptr = nullptr;
+    if (::posix_memalign(&ptr, alignment < sizeof(void*) ? sizeof(void*) : alignment,
+                         size == 0 ? 1 : size) != 0)
+        return nullptr;
+    return ptr;
+}
+
+void checkedFree(void* ptr, const char* operation) {
+    if (ptr == nullptr)
+        return;
+    blink::RealtimeSafety::checkAllowed(operation);
+    blink::RealtimeSafety::ScopedAllow inner;
+    std::free(ptr);
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (void* ptr = checkedAllocate(size, "operator new"))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* ptr = checkedAllocate(size, "operator new[]"))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return checkedAllocate(size, "operator new");
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return checkedAllocate(size, "operator new[]");
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* ptr = checkedAllocateAligned(size, (std::size_t) alignment, "operator new"))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    if (void* ptr = checkedAllocateAligned(size, (std::size_t) alignment, "operator new[]"))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept                                   { checkedFree(ptr, "operator delete"); }
+void operator delete[](void* ptr) noexcept                                 { checkedFree(ptr, "operator delete[]"); }
+void operator delete(void* ptr, std::size_t) noexcept                      { checkedFree(ptr, "operator delete"); }
+void operator delete[](void* ptr, std::size_t) noexcept                    { checkedFree(ptr, "operator delete[]"); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept            { checkedFree(ptr, "operator delete"); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept          { checkedFree(ptr, "operator delete[]"); }
+void operator delete(void* ptr, std::align_val_t) noexcept                 { checkedFree(ptr, "operator delete"); }
+void operator delete[](void* ptr, std::align_val_t) noexcept               { checkedFree(ptr, "operator delete[]"); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept    { checkedFree(ptr, "operator delete"); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept  { checkedFree(ptr, "operator delete[]"); }
+
+#if defined(__linux__)
+
+// glibc: define the C allocator entry points and forward to the __libc_ versions.
+// The real pthread_mutex_lock is resolved once at load time, because dlsym()
+// itself allocates and must never run on a checked thread.
+namespace {
+
+using MutexLockFn = int (*)(pthread_mutex_t*);
+
+MutexLockFn resolveRealMutexLock() {
+    return (MutexLockFn) ::dlsym(RTLD_NEXT, "pthread_mutex_lock");
+}
+
+MutexLockFn realMutexLock = resolveRealMutexLock();
+
+} // namespace
+
+extern "C" {
+
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void  __libc_free(void*);
+
+void* malloc(size_t size) {
+    blink::RealtimeSafety::checkAllowed("malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    blink::RealtimeSafety::checkAllowed("calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    blink::RealtimeSafety::checkAllowed("realloc");
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    if (ptr != nullptr)
+        blink::RealtimeSafety::checkAllowed("free");
+    __libc_free(ptr);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    blink::RealtimeSafety::checkAllowed("pthread_mutex_lock");
+
+    if (realMutexLock == nullptr)
+        realMutexLock = resolveRealMutexLock();
+
+    return realMutexLock(mutex);
+}
+
+} // extern "C"
+
+#elif defined(__APPLE__)
+
+// macOS: patch the default malloc zone in place. Symbol interposition is not
+// dependable for plugin bundles, but every allocator call goes through the zone.
+// pthread_mutex_lock has no such hook and is interposed below.
+namespace {
+
+void* (*realZoneMalloc)(malloc_zone_t*, size_t) = nullptr;
+void* (*realZoneCalloc)(malloc_zone_t*, size_t, size_t) = nullptr;
+void* (*realZoneRealloc)(malloc_zone_t*, void*, size_t) = nullptr;
+void  (*realZoneFree)(malloc_zone_t*, void*) = nullptr;
+
+void* checkedZoneMalloc(malloc_zone_t* zone, size_t size) {
+    blink::RealtimeSafety::checkAllowed("malloc");
+    return realZoneMalloc(zone, size);
+}
+
+void* checkedZoneCalloc(malloc_zone_t* zone, size_t count, size_t size) {
+    blink::RealtimeSafety::checkAllowed("calloc");
+    return realZoneCalloc(zone, count, size);
+}
+
+void* checkedZoneRealloc(malloc_zone_t* zone, void* ptr, size_t size) {
+    blink::RealtimeSafety::checkAllowed("realloc");
+    return realZoneRealloc(zone, ptr, size);
+}
+
+void checkedZoneFree(malloc_zone_t* zone, void* ptr) {
+    if (ptr != nullptr)
+        blink::RealtimeSafety::checkAllowed("free");
+    realZoneFree(zone, ptr);
+}
+
+bool installZoneHooks() {
+    malloc_zone_t* zone = malloc_default_zone();
+    if (zone == nullptr)
+        return false;
+
+    const auto page = (vm_address_t) zone & ~(vm_address_t) (vm_page_size - 1);
+    if (vm_protect(mach_task_self(), page, vm_page_size, 0, VM_PROT_READ | VM_PROT_WRITE) != KERN_SUCCESS)
+        return false;
+
+    realZoneMalloc  = zone->malloc;
+    realZoneCalloc  = zone->calloc;
+    realZoneRealloc = zone->realloc;
+    realZoneFree    = zone->free;
+
+    zone->malloc  = checkedZoneMalloc;
+    zone->calloc  = checkedZoneCalloc;
+    zone->realloc = checkedZoneRealloc;
+    zone->free    = checkedZoneFree;
+
+    vm_protect(mach_task_self(), page, vm_page_size, 0, VM_PROT_READ);
+    return true;
+}
+
+[[maybe_unused]] const bool zoneHooksInstalled = installZoneHooks();
+
+// Mutexes go through dyld interposition: the __interpose tuple below makes every
+// other image's pthread_mutex_lock bind to checkedMutexLock. Calls from this image
+// are not redirected, so the call inside reaches the real function. dyld only
+// honours the tuple for images loaded at launch, i.e. when the checker is linked
+// into the executable.
+int checkedMutexLock(pthread_mutex_t* mutex) {
+    blink::RealtimeSafety::checkAllowed("pthread_mutex_lock");
+    return pthread_mutex_lock(mutex);
+}
+
+struct Interpose {
+    const void* replacement;
+    const void* replacee;
+};
+
+__attribute__((used, section("__DATA,__interpose")))
+const Interpose mutexLockInterpose { (const void*) &checkedMutexLock, (const void*) &pthread_mutex_lock };
+
+} // namespace
+
+#endif
+
+#endif // VOCALSUITE_RT_SAFETY_CHECKS
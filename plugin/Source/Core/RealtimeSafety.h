@@ -0,0 +1,90 @@
+#pragma once
+
+#ifndef VOCALSUITE_RT_SAFETY_CHECKS
+ #define VOCALSUITE_RT_SAFETY_CHECKS 0
+#endif
+
+namespace blink {
+
+/**
+ * Debug/test-mode checker for real-time safety on the audio thread.
+ *
+ * When built with VOCALSUITE_RT_SAFETY_CHECKS=1, code inside a ScopedAudioThread
+ * is watched: operator new/delete, malloc/calloc/realloc/free and blocking
+ * mutex locks are reported with a stack trace, or abort the process.
+ * In normal builds every call here compiles away to nothing.
+ *
+ * Interception of operator new/delete always works. On Linux, malloc and
+ * pthread_mutex_lock are interposed by symbol; on macOS the default malloc
+ * zone is patched and pthread_mutex_lock is interposed through dyld's
+ * __interpose section. Interposition is reliable when the checker is linked
+ * into an executable (VocalSuiteRtStress, the render tool); inside a dlopen'd
+ * plugin the host's allocator may bind first, and on macOS mutex locks are not
+ * seen at all.
+ *
+ * The mode can be set in code or with the VOCALSUITE_RT_SAFETY environment
+ * variable ("report" or "abort").
+ */
+class RealtimeSafety {
+public:
+    enum class Mode {
+        Report,  // Print the violation and a stack trace, keep running
+        Abort    // Print the violation and a stack trace, then abort()
+    };
+
+    /**
+     * Marks the calling thread as the audio thread for the lifetime of the scope.
+     * Scopes nest, so re-entrant processBlock calls are fine.
+     */
+    class ScopedAudioThread {
+    public:
+       #if VOCALSUITE_RT_SAFETY_CHECKS
+        ScopedAudioThread() { enterAudioThread(); }
+        ~ScopedAudioThread() { exitAudioThread(); }
+       #else
+        ScopedAudioThread() = default;
+       #endif
+
+        ScopedAudioThread(const ScopedAudioThread&) = delete;
+        ScopedAudioThread& operator=(const ScopedAudioThread&) = delete;
+    };
+
+    /**
+     * Suspends checking on the calling thread, for code that is known to be
+     * safe but trips the interceptors (e.g. a one-off lazy init that is guarded
+     * elsewhere). Use sparingly.
+     */
+    class ScopedAllow {
+    public:
+       #if VOCALSUITE_RT_SAFETY_CHECKS
+        ScopedAllow() { suspendChecks(); }
+        ~ScopedAllow() { resumeChecks(); }
+       #else
+        ScopedAllow() = default;
+       #endif
+
+        ScopedAllow(const ScopedAllow&) = delete;
+        ScopedAllow& operator=(const ScopedAllow&) = delete;
+    };
+
+    static void setMode(Mode newMode);
+    static Mode getMode();
+
+    /** True when the calling thread is inside a ScopedAudioThread and not suspended. */
+    static bool isCheckingThisThread();
+
+    /** Number of violations seen since start-up or the last reset (for harness assertions). */
+    static int getViolationCount();
+    static void resetViolationCount();
+
+    /** Reports a violation if the calling thread is being checked. */
+    static void checkAllowed(const char* operation);
+
+private:
+    static void enterAudioThread();
+    static void exitAudioThread();
+    static void suspendChecks();
+    static void resumeChecks();
+};
+
+} // namespace blink
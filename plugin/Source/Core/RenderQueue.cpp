@@ -0,0 +1,224 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace blink {
+
+bool RenderQueue::JobContext::shouldCancel() const {
+    auto job = queue.findRunningJob(id);
+    return job == nullptr || job->cancelled.load();
+}
+
+void RenderQueue::JobContext::setProgress(float progress) {
+    auto job = queue.findRunningJob(id);
+    if (job == nullptr) {
+        return;
+    }
+
+    progress = std::min(1.0f, std::max(0.0f, progress));
+    const int percent = (int)(progress * 100.0f);
+
+    // Only the running job's own worker touches this, so no lock is needed
+    if (percent != job->lastReportedPercent) {
+        job->lastReportedPercent = percent;
+        queue.notify(*job, State::Running, progress);
+    }
+}
+
+void RenderQueue::JobContext::setMessage(const std::string& message) {
+    if (auto job = queue.findRunningJob(id)) {
+        job->message = message;
+    }
+}
+
+RenderQueue::RenderQueue(int numWorkers)
+    : numWorkers(std::max(1, numWorkers)), nextId(1), stopping(false) {
+}
+
+RenderQueue::~RenderQueue() {
+    shutdown();
+}
+
+void RenderQueue::setStatusCallback(StatusCallback callback) {
+    std::lock_guard<std::mutex> guard(callbackLock);
+    statusCallback = std::move(callback);
+}
+
+int RenderQueue::addJob(const std::string& name, Priority priority, JobFunction function) {
+    auto job = std::make_shared<Job>();
+    job->name = name;
+    job->priority = priority;
+    job->function = std::move(function);
+
+    bool rejected;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        job->id = nextId++;
+        rejected = stopping;
+        if (!rejected) {
+            queued.push_back(job);
+
+            // Queues that never get a job never cost a thread
+            while ((int)workers.size() < numWorkers) {
+                workers.emplace_back([this] { runWorker(); });
+            }
+        }
+    }
+
+    notify(*job, rejected ? State::Cancelled : State::Queued, 0.0f);
+    jobAvailable.notify_one();
+    return job->id;
+}
+
+bool RenderQueue::cancelJob(int id) {
+    std::shared_ptr<Job> dropped;
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+
+        auto it = std::find_if(queued.begin(), queued.end(),
+                               [id](const std::shared_ptr<Job>& job) { return job->id == id; });
+        if (it != queued.end()) {
+            dropped = *it;
+            queued.erase(it);
+        } else {
+            for (auto& job : running) {
+                if (job->id == id) {
+                    job->cancelled.store(true);
+                    return true; // Its worker reports the cancellation when it returns
+                }
+            }
+            return false;
+        }
+    }
+
+    notify(*dropped, State::Cancelled, 0.0f);
+    return true;
+}
+
+void RenderQueue::cancelAll() {
+    std::vector<std::shared_ptr<Job>> dropped;
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        dropped.swap(queued);
+        for (auto& job : running) {
+            job->cancelled.store(true);
+        }
+    }
+
+    for (auto& job : dropped) {
+        notify(*job, State::Cancelled, 0.0f);
+    }
+}
+
+void RenderQueue::shutdown() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (stopping) {
+            return;
+        }
+        stopping = true;
+    }
+
+    cancelAll();
+    jobAvailable.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+int RenderQueue::getNumQueuedJobs() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return (int)queued.size();
+}
+
+int RenderQueue::getNumRunningJobs() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return (int)running.size();
+}
+
+std::shared_ptr<RenderQueue::Job> RenderQueue::findRunningJob(int id) const {
+    std::lock_guard<std::mutex> guard(lock);
+    for (const auto& job : running) {
+        if (job->id == id) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void RenderQueue::notify(const JobStatus& status) {
+    std::lock_guard<std::mutex> guard(callbackLock);
+    if (statusCallback) {
+        statusCallback(status);
+    }
+}
+
+void RenderQueue::notify(const Job& job, State state, float progress) {
+    JobStatus status;
+    status.id = job.id;
+    status.name = job.name;
+    status.state = state;
+    status.progress = progress;
+    status.message = job.message;
+    notify(status);
+}
+
+void RenderQueue::runWorker() {
+    for (;;) {
+        std::shared_ptr<Job> job;
+
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            jobAvailable.wait(guard, [this] { return stopping || !queued.empty(); });
+
+            if (stopping) {
+                return;
+            }
+
+            // Highest priority first, then oldest
+            auto next = std::min_element(queued.begin(), queued.end(),
+                                         [](const std::shared_ptr<Job>& a, const std::shared_ptr<Job>& b) {
+                                             return a->priority != b->priority ? a->priority < b->priority
+                                                                               : a->id < b->id;
+                                         });
+            job = *next;
+            queued.erase(next);
+            running.push_back(job);
+        }
+
+        job->lastReportedPercent = 0;
+        notify(*job, State::Running, 0.0f);
+
+        JobContext context(*this, job->id);
+        bool succeeded = false;
+        try {
+            succeeded = job->function(context);
+        } catch (const std::exception& e) {
+            job->message = e.what();
+        } catch (...) {
+            // A worker must outlive any job; anything else thrown still fails just this one
+            job->message = "Unknown error";
+        }
+
+        // Release whatever the job captured before reporting it done
+        job->function = nullptr;
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            running.erase(std::find(running.begin(), running.end(), job));
+        }
+
+        const State finalState = job->cancelled.load() ? State::Cancelled
+                               : succeeded ? State::Finished
+                               : State::Failed;
+        notify(*job, finalState, succeeded ? 1.0f : 0.0f);
+    }
+}
+
+} // namespace blink
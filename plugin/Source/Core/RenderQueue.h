@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace blink {
+
+/**
+ * Queue of background render jobs (capture writes, conversions) run on a small
+ * fixed pool of worker threads.
+ *
+ * Jobs start in priority order, then in the order they were added. Each job
+ * can report progress and is asked to stop when it is cancelled; queued jobs
+ * are cancelled without running. Status changes go to a callback that may be
+ * called on any worker thread.
+ *
+ * Destroying the queue cancels everything and waits for running jobs to stop,
+ * so jobs may safely use whatever outlives the queue.
+ */
+class RenderQueue {
+public:
+    enum class Priority {
+        High,    // Work a user is directly waiting on (e.g. saving a take)
+        Normal,  // Conversions
+        Low      // Background batch work
+    };
+
+    enum class State {
+        Queued,
+        Running,
+        Finished,
+        Failed,
+        Cancelled
+    };
+
+    struct JobStatus {
+        int id = 0;
+        std::string name;
+        State state = State::Queued;
+        float progress = 0.0f;  // 0.0 to 1.0
+        std::string message;    // Output file, or why it failed
+    };
+
+    /**
+     * Handed to a running job.
+     */
+    class JobContext {
+    public:
+        /** True once the job has been cancelled; return as soon as convenient. */
+        bool shouldCancel() const;
+
+        /** Report progress (0.0 to 1.0). Updates are throttled to whole percents. */
+        void setProgress(float progress);
+
+        /** Text sent with the final status, e.g. the file that was written. */
+        void setMessage(const std::string& message);
+
+    private:
+        friend class RenderQueue;
+
+        JobContext(RenderQueue& queue, int id) : queue(queue), id(id) {}
+
+        RenderQueue& queue;
+        int id;
+    };
+
+    /** Does the work; returns true on success. */
+    using JobFunction = std::function<bool(JobContext& context)>;
+
+    /** Called on worker threads (and the caller's thread for cancellations). */
+    using StatusCallback = std::function<void(const JobStatus& status)>;
+
+    /**
+     * @param numWorkers Jobs that may run at once (at least 1); the worker
+     *                   threads are started by the first job
+     */
+    explicit RenderQueue(int numWorkers = 2);
+    ~RenderQueue();
+
+    void setStatusCallback(StatusCallback callback);
+
+    /**
+     * Queue a job.
+     * @return The job's id
+     */
+    int addJob(const std::string& name, Priority priority, JobFunction job);
+
+    /**
+     * Cancel a job: a queued job is dropped, a running one is asked to stop.
+     * @return false if no such job is queued or running
+     */
+    bool cancelJob(int id);
+
+    /** Cancel every queued and running job. */
+    void cancelAll();
+
+    /**
+     * Cancel everything, wait for running jobs to return and stop the workers.
+     * Jobs added afterwards are cancelled straight away.
+     */
+    void shutdown();
+
+    int getNumQueuedJobs() const;
+    int getNumRunningJobs() const;
+
+private:
+    struct Job {
+        int id;
+        std::string name;
+        Priority priority;
+        JobFunction function;
+        std::atomic<bool> cancelled { false };
+        int lastReportedPercent = -1;
+        std::string message;
+    };
+
+    mutable std::mutex lock;
+    std::condition_variable jobAvailable;
+    std::vector<std::shared_ptr<Job>> queued;
+    std::vector<std::shared_ptr<Job>> running;
+    std::vector<std::thread> workers;
+    int numWorkers;
+    int nextId;
+    bool stopping;
+
+    std::mutex callbackLock;
+    StatusCallback statusCallback;
+
+    void runWorker();
+    std::shared_ptr<Job> findRunningJob(int id) const;
+    void notify(const JobStatus& status);
+    void notify(const Job& job, State state, float progress);
+};
+
+} // namespace blink
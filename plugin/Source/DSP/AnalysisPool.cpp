@@ -0,0 +1,53 @@
+#include "AnalysisPool.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+namespace blink {
+
+AnalysisPool::AnalysisPool(int numThreads)
+    : numThreads(std::max(0, numThreads)) {
+    if (this->numThreads > 0) {
+        pool = std::make_unique<juce::ThreadPool>(this->numThreads);
+    }
+}
+
+std::shared_ptr<AnalysisPool> AnalysisPool::getShared() {
+    static std::mutex sharedLock;
+    static std::weak_ptr<AnalysisPool> sharedPool;
+
+    std::lock_guard<std::mutex> guard(sharedLock);
+
+    std::shared_ptr<AnalysisPool> analysisPool = sharedPool.lock();
+    if (analysisPool == nullptr) {
+        analysisPool = std::make_shared<AnalysisPool>(juce::SystemStats::getNumCpus() - 1);
+        sharedPool = analysisPool;
+    }
+    return analysisPool;
+}
+
+void AnalysisPool::run(int numTasks, const std::function<void(int task)>& task) {
+    if (numTasks <= 1 || pool == nullptr) {
+        for (int i = 0; i < numTasks; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    std::atomic<int> remaining { numTasks - 1 };
+    juce::WaitableEvent allDone;
+
+    for (int i = 1; i < numTasks; i++) {
+        pool->addJob([&, i] {
+            task(i);
+            if (remaining.fetch_sub(1) == 1) {
+                allDone.signal();
+            }
+        });
+    }
+
+    task(0);
+    allDone.wait();
+}
+
+} // namespace blink
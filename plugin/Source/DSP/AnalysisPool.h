@@ -0,0 +1,41 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <functional>
+#include <memory>
+
+namespace blink {
+
+/**
+ * Worker threads for offline frame analysis, shared by every converter and
+ * vocoder in the process.
+ *
+ * The pool is created on first use with one thread fewer than there are cores
+ * (the caller runs a share itself) and freed when its last user lets go. A
+ * session of plugin instances, each with render engines and a vocoder, so has
+ * one set of analysis threads rather than one per module. Callers may run at
+ * the same time; their tasks queue on the same threads.
+ */
+class AnalysisPool {
+public:
+    explicit AnalysisPool(int numThreads);
+
+    /** The process-wide pool, created on first use. */
+    static std::shared_ptr<AnalysisPool> getShared();
+
+    /** Threads that run tasks at once, the calling thread included. */
+    int getNumWorkers() const { return numThreads + 1; }
+
+    /**
+     * Run task(0) to task(numTasks - 1) and return once all have finished.
+     * Task 0 runs on the calling thread, the rest on the pool. Must not be
+     * called from a task.
+     */
+    void run(int numTasks, const std::function<void(int task)>& task);
+
+private:
+    const int numThreads;
+    std::unique_ptr<juce::ThreadPool> pool;  // nullptr on a single core
+};
+
+} // namespace blink
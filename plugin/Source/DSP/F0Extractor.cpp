@@ -11,6 +11,7 @@ F0Extractor::F0Extractor(int hopSize)
 
 void F0Extractor::setSampleRate(double sampleRate) {
     this->sampleRate = sampleRate;
+    pitchDetector.setSampleRate(sampleRate);
 }
 
 float F0Extractor::processSample(const float* buffer, int numSamples) {
@@ -36,6 +37,22 @@ float F0Extractor::processSample(const float* buffer, int numSamples) {
     return frequency;
 }
 
+void F0Extractor::smoothCurve(float* f0, int numFrames) const {
+    float previous = 0.0f;
+    
+    for (int i = 0; i < numFrames; i++) {
+        if (f0[i] > 0.0f) {
+            if (previous > 0.0f) {
+                f0[i] = previous * smoothingFactor + f0[i] * (1.0f - smoothingFactor);
+            }
+            previous = f0[i];
+        } else {
+            f0[i] = 0.0f;
+            previous = 0.0f;
+        }
+    }
+}
+
 void F0Extractor::reset() {
     f0Curve.clear();
     prevF0 = 0.0f;
@@ -44,6 +44,14 @@ public:
      */
     void getF0AsMIDI(float* output, int numFrames);
 
+    /**
+     * Apply the same smoothing processSample() uses to a curve of raw F0 values,
+     * in place. Lets frames be detected independently and smoothed afterwards.
+     * @param f0 Raw F0 values in Hz (0.0 for unvoiced)
+     * @param numFrames Number of frames
+     */
+    void smoothCurve(float* f0, int numFrames) const;
+
 private:
     PitchDetector pitchDetector;
     std::vector<float> f0Curve;
@@ -9,6 +9,8 @@ LPCAnalyzer::LPCAnalyzer(int order)
     : order(order), predictionError(0.0f) {
     lpcCoeffs.resize(order + 1, 0.0f);
     autocorr.resize(order + 1, 0.0f);
+    recursionCoeffs.resize(order + 1, 0.0f);
+    recursionPrev.resize(order + 1, 0.0f);
 }
 
 void LPCAnalyzer::calculateAutocorrelation(const float* buffer, int numSamples) {
@@ -33,8 +35,11 @@ void LPCAnalyzer::levinsonDurbin(const std::vector<float>& r) {
         return;
     }
     
-    std::vector<float> a(order + 1, 0.0f);
-    std::vector<float> aPrev(order + 1, 0.0f);
+    // Scratch is preallocated so analysis never allocates on the audio thread
+    std::vector<float>& a = recursionCoeffs;
+    std::vector<float>& aPrev = recursionPrev;
+    std::fill(a.begin(), a.end(), 0.0f);
+    std::fill(aPrev.begin(), aPrev.end(), 0.0f);
     
     // Initialize
     float error = r[0];
@@ -49,6 +49,10 @@ private:
     std::vector<float> autocorr;
     float predictionError;
     
+    // Levinson-Durbin scratch (order + 1)
+    std::vector<float> recursionCoeffs;
+    std::vector<float> recursionPrev;
+    
     // Levinson-Durbin recursion
     void levinsonDurbin(const std::vector<float>& r);
     
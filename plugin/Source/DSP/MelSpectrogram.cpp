@@ -1,25 +1,24 @@
 #include "MelSpectrogram.h"
 #include <cmath>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 
 namespace blink {
 
 MelSpectrogram::MelSpectrogram(int fftSize, int hopSize, int numMelBands)
     : fftSize(fftSize), hopSize(hopSize), numMelBands(numMelBands), sampleRate(44100.0) {
     
-    // Calculate FFT order and create JUCE FFT
+    // FFT plan and window are shared with other instances of the same size
     fftOrder = calculateFFTOrder(fftSize);
-    fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+    fft = SharedTables::getFFT(fftOrder);
+    window = SharedTables::getHannWindow(fftSize);
     
     // Initialize buffers
-    window.resize(fftSize);
     fftData.resize(fftSize * 2, 0.0f);
     powerSpectrum.resize(fftSize / 2 + 1);
-    
-    // Hann window
-    for (int i = 0; i < fftSize; i++) {
-        window[i] = 0.5f * (1.0f - cosf(2.0f * juce::MathConstants<float>::pi * i / (fftSize - 1)));
-    }
+    blockPower.resize((size_t)(fftSize / 2 + 1) * framesPerBlock);
+    blockEnergy.resize(framesPerBlock);
     
     // Initialize mel filterbank
     initMelFilterbank();
@@ -27,7 +26,7 @@ MelSpectrogram::MelSpectrogram(int fftSize, int hopSize, int numMelBands)
 
 void MelSpectrogram::setSampleRate(double sampleRate) {
     this->sampleRate = sampleRate;
-    initMelFilterbank();  // Rebuild filterbank for new sample rate
+    initMelFilterbank();  // Filterbank for the new sample rate
 }
 
 int MelSpectrogram::calculateFFTOrder(int size) {
@@ -40,106 +39,110 @@ int MelSpectrogram::calculateFFTOrder(int size) {
     return order;
 }
 
-float MelSpectrogram::hzToMel(float hz) {
-    // Convert Hz to mel scale
-    return 2595.0f * log10f(1.0f + hz / 700.0f);
-}
-
-float MelSpectrogram::melToHz(float mel) {
-    // Convert mel scale to Hz
-    return 700.0f * (powf(10.0f, mel / 2595.0f) - 1.0f);
+void MelSpectrogram::initMelFilterbank() {
+    filterbank = SharedTables::getMelFilterbank(fftSize, numMelBands, sampleRate);
 }
 
-void MelSpectrogram::initMelFilterbank() {
-    // Create mel filterbank (triangular filters)
-    melFilterbank.clear();
-    melFilterbank.resize(numMelBands);
-    
-    // Frequency range: 0 Hz to Nyquist
-    float minFreq = 0.0f;
-    float maxFreq = (float)sampleRate / 2.0f;
-    
-    // Convert to mel scale
-    float minMel = hzToMel(minFreq);
-    float maxMel = hzToMel(maxFreq);
+void MelSpectrogram::computePowerSpectrum(const float* buffer, int numSamples) {
+    // Ensure we have enough samples
+    int samplesToUse = std::min(numSamples, fftSize);
     
-    // Create mel-spaced frequency points
-    std::vector<float> melPoints(numMelBands + 2);
-    for (int i = 0; i < numMelBands + 2; i++) {
-        melPoints[i] = minMel + (maxMel - minMel) * i / (numMelBands + 1);
-    }
+    // Apply window (real input is contiguous for the real-only transform)
+    juce::FloatVectorOperations::multiply(fftData.data(), buffer, window->data(), samplesToUse);
+    std::fill(fftData.begin() + samplesToUse, fftData.end(), 0.0f);
     
-    // Convert back to Hz
-    std::vector<float> hzPoints(numMelBands + 2);
-    for (int i = 0; i < numMelBands + 2; i++) {
-        hzPoints[i] = melToHz(melPoints[i]);
-    }
+    // Forward FFT, interleaved complex output for bins 0..fftSize/2
+    fft->performRealOnlyForwardTransform(fftData.data(), true);
     
-    // Convert Hz to FFT bins
-    std::vector<int> binPoints(numMelBands + 2);
-    for (int i = 0; i < numMelBands + 2; i++) {
-        binPoints[i] = (int)floorf((fftSize + 1) * hzPoints[i] / sampleRate);
+    // Calculate power spectrum
+    for (int k = 0; k <= fftSize / 2; k++) {
+        float real = fftData[k * 2];
+        float imag = fftData[k * 2 + 1];
+        powerSpectrum[k] = real * real + imag * imag;
     }
+}
+
+void MelSpectrogram::logCompress(float* data, int numValues) {
+    // log2(x) = exponent + log2(mantissa), mantissa in [1, 2).
+    // log2(m) = 2/ln2 * atanh(t), t = (m - 1) / (m + 1) in [0, 1/3]; the odd
+    // series to t^9 is accurate to about 1e-6.
+    const float log10Of2 = 0.30102999566f;
+    const float twoOverLn2 = 2.88539008178f;
     
-    // Create triangular filters
-    for (int i = 0; i < numMelBands; i++) {
-        melFilterbank[i].resize(fftSize / 2 + 1, 0.0f);
+    for (int i = 0; i < numValues; i++) {
+        float x = data[i] + 1e-10f;  // Add small value to avoid log(0)
         
-        int leftBin = binPoints[i];
-        int centerBin = binPoints[i + 1];
-        int rightBin = binPoints[i + 2];
+        int32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        const float exponent = (float)(((bits >> 23) & 0xff) - 127);
+        bits = (bits & 0x007fffff) | 0x3f800000;
         
-        // Left slope (rising)
-        for (int k = leftBin; k < centerBin; k++) {
-            if (centerBin > leftBin) {
-                melFilterbank[i][k] = (float)(k - leftBin) / (centerBin - leftBin);
-            }
-        }
+        float mantissa;
+        std::memcpy(&mantissa, &bits, sizeof(mantissa));
         
-        // Right slope (falling)
-        for (int k = centerBin; k < rightBin; k++) {
-            if (rightBin > centerBin) {
-                melFilterbank[i][k] = (float)(rightBin - k) / (rightBin - centerBin);
-            }
-        }
+        const float t = (mantissa - 1.0f) / (mantissa + 1.0f);
+        const float t2 = t * t;
+        const float series = t * (1.0f + t2 * (1.0f / 3.0f + t2 * (1.0f / 5.0f + t2 * (1.0f / 7.0f + t2 * (1.0f / 9.0f)))));
+        
+        data[i] = (exponent + twoOverLn2 * series) * log10Of2;
     }
 }
 
 void MelSpectrogram::processFrame(const float* buffer, int numSamples, float* output) {
-    // Ensure we have enough samples
-    int samplesToUse = std::min(numSamples, fftSize);
-    
-    // Apply window and prepare for FFT
-    for (int i = 0; i < samplesToUse; i++) {
-        fftData[i * 2] = buffer[i] * window[i];  // Real part
-        fftData[i * 2 + 1] = 0.0f;               // Imaginary part
-    }
+    computePowerSpectrum(buffer, numSamples);
     
-    // Zero-pad if needed
-    for (int i = samplesToUse; i < fftSize; i++) {
-        fftData[i * 2] = 0.0f;
-        fftData[i * 2 + 1] = 0.0f;
+    // Apply mel filterbank: each band only touches the bins it covers
+    for (int i = 0; i < numMelBands; i++) {
+        const SharedTables::MelFilterbank::Span& span = filterbank->spans[i];
+        const float* power = powerSpectrum.data() + span.startBin;
+        const float* weights = filterbank->weights.data() + span.offset;
+        
+        float melEnergy = 0.0f;
+        for (int k = 0; k < span.numBins; k++) {
+            melEnergy += power[k] * weights[k];
+        }
+        output[i] = melEnergy;
     }
     
-    // Forward FFT
-    fft->performFrequencyOnlyForwardTransform(fftData.data());
-    
-    // Calculate power spectrum
-    for (int k = 0; k <= fftSize / 2; k++) {
-        float real = fftData[k * 2];
-        float imag = fftData[k * 2 + 1];
-        powerSpectrum[k] = real * real + imag * imag;
-    }
+    // Log scale (standard for mel-spectrograms)
+    logCompress(output, numMelBands);
+}
+
+void MelSpectrogram::processFrames(const float* input, int numFrames, float* output) {
+    const int numBins = fftSize / 2 + 1;
     
-    // Apply mel filterbank
-    for (int i = 0; i < numMelBands; i++) {
-        float melEnergy = 0.0f;
-        for (int k = 0; k <= fftSize / 2; k++) {
-            melEnergy += powerSpectrum[k] * melFilterbank[i][k];
+    for (int blockStart = 0; blockStart < numFrames; blockStart += framesPerBlock) {
+        const int blockFrames = std::min(framesPerBlock, numFrames - blockStart);
+        
+        // Power spectra, stored bin-major so each bin is a row across the block's frames
+        for (int f = 0; f < blockFrames; f++) {
+            computePowerSpectrum(input + (size_t)(blockStart + f) * hopSize, fftSize);
+            for (int k = 0; k < numBins; k++) {
+                blockPower[(size_t)k * framesPerBlock + f] = powerSpectrum[k];
+            }
         }
         
-        // Log scale (standard for mel-spectrograms)
-        output[i] = log10f(melEnergy + 1e-10f);  // Add small value to avoid log(0)
+        float* blockOutput = output + (size_t)blockStart * numMelBands;
+        
+        for (int i = 0; i < numMelBands; i++) {
+            const SharedTables::MelFilterbank::Span& span = filterbank->spans[i];
+            const float* weights = filterbank->weights.data() + span.offset;
+            
+            // One vector multiply-add per non-zero weight, across all frames at once
+            juce::FloatVectorOperations::clear(blockEnergy.data(), blockFrames);
+            for (int k = 0; k < span.numBins; k++) {
+                juce::FloatVectorOperations::addWithMultiply(
+                    blockEnergy.data(),
+                    blockPower.data() + (size_t)(span.startBin + k) * framesPerBlock,
+                    weights[k], blockFrames);
+            }
+            
+            logCompress(blockEnergy.data(), blockFrames);
+            
+            for (int f = 0; f < blockFrames; f++) {
+                blockOutput[(size_t)f * numMelBands + i] = blockEnergy[f];
+            }
+        }
     }
 }
 
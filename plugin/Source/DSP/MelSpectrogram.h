@@ -1,6 +1,8 @@
 #pragma once
 
-#include <JuceHeader.h>
+#include <juce_dsp/juce_dsp.h>
+#include "SharedTables.h"
+#include <memory>
 #include <vector>
 
 namespace blink {
@@ -27,6 +29,16 @@ public:
      */
     void processFrame(const float* buffer, int numSamples, float* output);
 
+    /**
+     * Process many frames per call, hopSize samples apart.
+     * Frames are worked through in blocks so the filterbank runs as vector
+     * multiply-adds across frames.
+     * @param input Audio holding (numFrames - 1) * hopSize + fftSize samples
+     * @param numFrames Number of frames
+     * @param output Frame-major output (numFrames x numMelBands)
+     */
+    void processFrames(const float* input, int numFrames, float* output);
+
     /**
      * Get number of mel bands.
      */
@@ -43,24 +55,32 @@ private:
     int numMelBands;
     double sampleRate;
     
-    // JUCE FFT
-    std::unique_ptr<juce::dsp::FFT> fft;
+    // FFT plan, window and mel filterbank, shared with every other user of the same sizes
+    std::shared_ptr<const juce::dsp::FFT> fft;
     int fftOrder;
+    std::shared_ptr<const std::vector<float>> window;
+    std::shared_ptr<const SharedTables::MelFilterbank> filterbank;
     
     // Buffers
-    std::vector<float> window;
     std::vector<float> fftData;
     std::vector<float> powerSpectrum;
     
-    // Mel filterbank
-    std::vector<std::vector<float>> melFilterbank;
+    // Scratch for processFrames(): bin-major power spectra and band energies per block
+    static constexpr int framesPerBlock = 32;
+    std::vector<float> blockPower;
+    std::vector<float> blockEnergy;
     
-    // Initialize mel filterbank
+    
+    // Fetch the mel filterbank for the current sample rate
     void initMelFilterbank();
     
+    // Windowed real FFT of one frame into powerSpectrum
+    void computePowerSpectrum(const float* buffer, int numSamples);
+    
+    // In-place log10(x + 1e-10), branch-free so the loop vectorizes
+    static void logCompress(float* data, int numValues);
+    
     // Helper functions
-    float hzToMel(float hz);
-    float melToHz(float mel);
     int calculateFFTOrder(int size);
 };
 
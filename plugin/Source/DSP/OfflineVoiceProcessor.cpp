@@ -1,34 +1,300 @@
 #include "OfflineVoiceProcessor.h"
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 
 namespace blink {
 
 OfflineVoiceProcessor::OfflineVoiceProcessor()
-    : f0Extractor(512), melSpec(2048, 512, 80),
-      sampleRate(44100.0), hopSize(512), fftSize(2048),
-      statusMessage("Ready") {
+    : f0Extractor(512), melSpec(2048, 512, 80), formantShifter(2048, 512),
+      sampleRate(44100.0), analysisRate(44100.0), hopSize(512), fftSize(2048),
+      statusMessage("Ready"), pitchShiftSemitones(0.0f), formantShiftSemitones(0.0f),
+      batchSize(0) {
+    Resampler::precomputeCommonTables();
 }
 
 void OfflineVoiceProcessor::setSampleRate(double sampleRate) {
     this->sampleRate = sampleRate;
-    f0Extractor.setSampleRate(sampleRate);
+    
+    const int modelRate = onnxInference.getModelSampleRate();
+    analysisRate = (modelRate > 0) ? (double)modelRate : sampleRate;
+    configureAnalysis();
+}
+
+void OfflineVoiceProcessor::configureAnalysis() {
+    f0Extractor.setSampleRate(analysisRate);
+    melSpec.setSampleRate(analysisRate);
+    formantShifter.setSampleRate(analysisRate);
+    
+    // Analysers are rebuilt for the new rate on next use
+    analyzers.clear();
+}
+
+void OfflineVoiceProcessor::updateModelRate() {
+    const int modelRate = onnxInference.getModelSampleRate();
+    const double newRate = (modelRate > 0) ? (double)modelRate : sampleRate;
+    
+    if (newRate != analysisRate) {
+        analysisRate = newRate;
+        configureAnalysis();
+    }
+}
+
+OfflineVoiceProcessor::FrameAnalyzer::FrameAnalyzer(double sampleRate, int fftSize,
+                                                    int hopSize, int numMelBands)
+    : pitchDetector(sampleRate, fftSize), melSpec(fftSize, hopSize, numMelBands) {
     melSpec.setSampleRate(sampleRate);
 }
 
+void OfflineVoiceProcessor::prepareAnalyzers() {
+    if (!analyzers.empty()) {
+        return;
+    }
+    
+    // Threads are shared process-wide; analysers are per converter, one per worker
+    if (analysisPool == nullptr) {
+        analysisPool = AnalysisPool::getShared();
+    }
+    
+    const int numWorkers = analysisPool->getNumWorkers();
+    for (int i = 0; i < numWorkers; i++) {
+        analyzers.push_back(std::make_unique<FrameAnalyzer>(analysisRate, fftSize, hopSize,
+                                                            melSpec.getNumMelBands()));
+    }
+}
+
+void OfflineVoiceProcessor::analyseFrames(const float* input, int numFrames,
+                                          float* f0Out, float* melOut) {
+    prepareAnalyzers();
+    
+    const int numMelBands = melSpec.getNumMelBands();
+    const int numWorkers = (int)analyzers.size();
+    const int framesPerTask = std::max(minFramesPerTask, (numFrames + numWorkers - 1) / numWorkers);
+    const int numTasks = (numFrames + framesPerTask - 1) / framesPerTask;
+    
+    // Each task owns a contiguous frame range and one analyser; outputs don't overlap
+    auto analyseRange = [=](int task) {
+        FrameAnalyzer& analyzer = *analyzers[task];
+        const int first = task * framesPerTask;
+        const int last = std::min(numFrames, first + framesPerTask);
+        
+        for (int frame = first; frame < last; frame++) {
+            f0Out[frame] = analyzer.pitchDetector.getPitch(input + frame * hopSize, fftSize);
+        }
+        
+        analyzer.melSpec.processFrames(input + first * hopSize, last - first,
+                                       melOut + (size_t)first * numMelBands);
+    };
+    
+    analysisPool->run(numTasks, analyseRange);
+}
+
 bool OfflineVoiceProcessor::loadVoiceModel(const std::string& modelPath) {
+    if (onnxInference.isLoaded() && modelPath == loadedModelPath) {
+        return true;
+    }
+    
     statusMessage = "Loading model: " + modelPath;
-    bool success = onnxInference.loadModel(modelPath);
+    
+    const std::string variantPath = variantSettings.autoSelect ? selectModelVariant(modelPath) : modelPath;
+    bool success = onnxInference.loadModel(variantPath);
+    
+    modelHash.clear();
     
     if (success) {
+        loadedModelPath = modelPath;
+        activeModelPath = variantPath;
+        updateModelRate();
         statusMessage = "Model loaded successfully";
     } else {
+        loadedModelPath.clear();
+        activeModelPath.clear();
         statusMessage = "Failed to load model";
     }
     
     return success;
 }
 
+std::vector<std::string> OfflineVoiceProcessor::findModelVariants(const std::string& modelPath) {
+    const juce::File model(modelPath);
+    const juce::String stem = model.getFileNameWithoutExtension();
+    
+    std::vector<std::string> variants { modelPath };
+    for (const char* suffix : { ".int8.onnx", ".fp16.onnx" }) {
+        const juce::File variant = model.getSiblingFile(stem + suffix);
+        if (variant.existsAsFile()) {
+            variants.push_back(variant.getFullPathName().toStdString());
+        }
+    }
+    
+    return variants;
+}
+
+std::string OfflineVoiceProcessor::selectModelVariant(const std::string& modelPath) {
+    const std::vector<std::string> candidates = findModelVariants(modelPath);
+    if (candidates.size() < 2) {
+        return modelPath;
+    }
+    
+    // The recorded choice stands while none of the files or the tolerance change
+    juce::String fingerprint = juce::String(variantSettings.maxSpectralDistanceDb);
+    for (const auto& candidate : candidates) {
+        const juce::File file(candidate);
+        fingerprint << "|" << file.getFileName() << ":" << juce::String(file.getSize()) << ":"
+                    << juce::String(file.getLastModificationTime().toMilliseconds());
+    }
+    
+    ModelCatalog::ModelInfo catalogEntry;
+    const bool inCatalog = modelCatalog != nullptr
+                        && modelCatalog->findModel(juce::File(modelPath).getFileName().toStdString(), catalogEntry)
+                        && juce::File(catalogEntry.path) == juce::File(modelPath);
+    
+    if (inCatalog && !catalogEntry.chosenVariant.empty()
+        && catalogEntry.variantFingerprint == fingerprint.toStdString()) {
+        const juce::File chosen = juce::File(modelPath).getSiblingFile(catalogEntry.chosenVariant);
+        if (chosen.existsAsFile()) {
+            return chosen.getFullPathName().toStdString();
+        }
+    }
+    
+    // The base model sets the rate the reference clip is analysed at
+    if (!onnxInference.loadModel(modelPath)) {
+        return modelPath;
+    }
+    updateModelRate();
+    
+    // Reference clip features, shared by every candidate
+    const std::vector<float> clip = makeReferenceClip();
+    const int numSamples = (int)clip.size();
+    
+    std::vector<float> f0Curve, melSpecData;
+    if (!extractFeatures(clip.data(), numSamples, f0Curve, melSpecData)) {
+        return modelPath;
+    }
+    
+    const int numFrames = (int)f0Curve.size();
+    const int numMelBands = melSpec.getNumMelBands();
+    
+    std::vector<float> reference(numSamples), rendered(numSamples);
+    int referenceLength = 0;
+    
+    std::string bestPath = modelPath;
+    double bestMs = 0.0;
+    
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const std::string& candidate = candidates[i];
+        if (!onnxInference.loadModel(candidate)) {
+            if (i == 0) {
+                return modelPath; // Nothing to compare against
+            }
+            continue;
+        }
+        
+        // Sessions are already warmed up on load; keep the fastest of a few runs
+        float* output = (i == 0) ? reference.data() : rendered.data();
+        int generated = 0;
+        double fastestMs = 0.0;
+        
+        for (int run = 0; run < std::max(1, variantSettings.benchmarkRuns); run++) {
+            const double start = juce::Time::getMillisecondCounterHiRes();
+            generated = onnxInference.processOffline(f0Curve.data(), melSpecData.data(),
+                                                     numFrames, numMelBands, output, numSamples);
+            const double elapsed = juce::Time::getMillisecondCounterHiRes() - start;
+            fastestMs = (run == 0) ? elapsed : std::min(fastestMs, elapsed);
+        }
+        
+        if (generated <= 0) {
+            if (i == 0) {
+                return modelPath;
+            }
+            onnxInference.releaseModel(candidate);
+            continue;
+        }
+        
+        float distanceDb = 0.0f;
+        if (i == 0) {
+            referenceLength = generated;
+        } else {
+            distanceDb = spectralDistanceDb(reference.data(), rendered.data(),
+                                            std::min(referenceLength, generated));
+        }
+        
+        if (i == 0 || (distanceDb <= variantSettings.maxSpectralDistanceDb && fastestMs < bestMs)) {
+            bestPath = candidate;
+            bestMs = fastestMs;
+        }
+    }
+    
+    // Only the winner stays in the session pool
+    for (const auto& candidate : candidates) {
+        if (candidate != bestPath) {
+            onnxInference.releaseModel(candidate);
+        }
+    }
+    
+    if (inCatalog) {
+        modelCatalog->setChosenVariant(modelPath, juce::File(bestPath).getFileName().toStdString(),
+                                       fingerprint.toStdString());
+    }
+    
+    return bestPath;
+}
+
+std::vector<float> OfflineVoiceProcessor::makeReferenceClip() const {
+    // Two seconds of a sung glide with vibrato: a harmonic source under three
+    // vowel-like formants, so quantization error shows up where voices live
+    const int numSamples = (int)(2.0 * analysisRate);
+    const float twoPi = 2.0f * juce::MathConstants<float>::pi;
+    const float formants[3] = { 700.0f, 1200.0f, 2600.0f };
+    const float bandwidths[3] = { 110.0f, 120.0f, 160.0f };
+    
+    std::vector<float> clip((size_t)numSamples);
+    float phase = 0.0f;
+    
+    for (int n = 0; n < numSamples; n++) {
+        const float t = (float)(n / analysisRate);
+        const float f0 = (180.0f + 80.0f * t / 2.0f) * (1.0f + 0.02f * std::sin(twoPi * 5.5f * t));
+        phase = std::fmod(phase + twoPi * f0 / (float)analysisRate, twoPi);
+        
+        float sample = 0.0f;
+        for (int h = 1; h * f0 < 5000.0f; h++) {
+            const float freq = h * f0;
+            float gain = 0.0f;
+            for (int k = 0; k < 3; k++) {
+                const float d = (freq - formants[k]) / bandwidths[k];
+                gain += 1.0f / (1.0f + d * d);
+            }
+            sample += gain * std::sin(phase * h) / h;
+        }
+        
+        // Short fades so the clip starts and ends cleanly
+        const float fade = std::min(1.0f, std::min(t, 2.0f - t) / 0.05f);
+        clip[(size_t)n] = 0.2f * fade * sample;
+    }
+    
+    return clip;
+}
+
+float OfflineVoiceProcessor::spectralDistanceDb(const float* a, const float* b, int numSamples) {
+    const int numFrames = (numSamples - fftSize) / hopSize + 1;
+    if (numFrames <= 0) {
+        return 0.0f;
+    }
+    
+    const int numMelBands = melSpec.getNumMelBands();
+    std::vector<float> melA((size_t)numFrames * numMelBands), melB(melA.size());
+    melSpec.processFrames(a, numFrames, melA.data());
+    melSpec.processFrames(b, numFrames, melB.data());
+    
+    double total = 0.0;
+    for (size_t i = 0; i < melA.size(); i++) {
+        total += std::abs(melA[i] - melB[i]);
+    }
+    
+    // Mel values are log10 power
+    return (float)(10.0 * total / melA.size());
+}
+
 bool OfflineVoiceProcessor::extractFeatures(const float* input, int numSamples,
                                            std::vector<float>& f0Curve,
                                            std::vector<float>& melSpecData) {
@@ -40,32 +306,15 @@ bool OfflineVoiceProcessor::extractFeatures(const float* input, int numSamples,
         return false;
     }
     
-    // Clear previous data
-    f0Curve.clear();
-    melSpecData.clear();
-    
-    // Reset F0 extractor
-    f0Extractor.reset();
-    
-    // Process each frame
+    // Frame-major outputs, sized up front so workers write in place
     int numMelBands = melSpec.getNumMelBands();
-    std::vector<float> melFrame(numMelBands);
+    f0Curve.resize(numFrames);
+    melSpecData.resize((size_t)numFrames * numMelBands);
     
-    for (int frame = 0; frame < numFrames; frame++) {
-        int offset = frame * hopSize;
-        
-        // Extract F0
-        float f0 = f0Extractor.processSample(input + offset, fftSize);
-        f0Curve.push_back(f0);
-        
-        // Extract mel-spectrogram
-        melSpec.processFrame(input + offset, fftSize, melFrame.data());
-        
-        // Append to mel-spec data (transpose: [numFrames x numMelBands])
-        for (int i = 0; i < numMelBands; i++) {
-            melSpecData.push_back(melFrame[i]);
-        }
-    }
+    analyseFrames(input, numFrames, f0Curve.data(), melSpecData.data());
+    
+    // Smoothing depends on the previous frame, so it runs after the parallel pass
+    f0Extractor.smoothCurve(f0Curve.data(), numFrames);
     
     statusMessage = "Features extracted: " + std::to_string(numFrames) + " frames";
     return true;
@@ -79,6 +328,14 @@ bool OfflineVoiceProcessor::processOffline(const float* input, float* output, in
         return false;
     }
     
+    // Long takes go through the chunked path so memory stays bounded; so do
+    // cached conversions, which are stored per chunk window, and takes that
+    // need resampling to the model rate
+    const int totalFrames = (numSamples - fftSize) / hopSize + 1;
+    if (totalFrames > chunkSettings.chunkFrames || cache != nullptr || analysisRate != sampleRate) {
+        return processOfflineChunked(input, output, numSamples);
+    }
+    
     statusMessage = "Processing audio...";
     
     // Step 1: Extract features
@@ -94,6 +351,9 @@ bool OfflineVoiceProcessor::processOffline(const float* input, float* output, in
     int numFrames = (int)f0Curve.size();
     int numMelBands = melSpec.getNumMelBands();
     
+    // Pitch is shifted on the model input, the way RVC-style models expect
+    transposeF0(f0Curve);
+    
     // Step 2: Run ONNX inference
     std::vector<float> aiOutput(numSamples);
     
@@ -112,6 +372,8 @@ bool OfflineVoiceProcessor::processOffline(const float* input, float* output, in
             std::fill(output + samplesGenerated, output + numSamples, 0.0f);
         }
         
+        applyFormantShift(output, numSamples);
+        
         statusMessage = "Processing complete: " + std::to_string(samplesGenerated) + " samples";
         return true;
     } else {
@@ -122,6 +384,465 @@ bool OfflineVoiceProcessor::processOffline(const float* input, float* output, in
     }
 }
 
+bool OfflineVoiceProcessor::processOfflineChunked(const float* input, float* output, int numSamples,
+                                                  const ProgressCallback& onProgress,
+                                                  const OutputCallback& onOutput) {
+    std::vector<Take> takes(1);
+    takes[0].input = input;
+    takes[0].output = output;
+    takes[0].numSamples = numSamples;
+    takes[0].onOutput = onOutput;
+    
+    return processTakes(takes, onProgress);
+}
+
+bool OfflineVoiceProcessor::processTakes(std::vector<Take>& takes,
+                                         const ProgressCallback& onProgress) {
+    if (!onnxInference.isLoaded() || analysisRate == sampleRate) {
+        return convertTakes(takes, onProgress);
+    }
+    
+    // The model runs at its own rate: resample each take in, and stream the
+    // model's output back to the host rate as it arrives
+    struct Conversion {
+        std::vector<float> modelInput;
+        Resampler outputResampler;
+        int written = 0;
+    };
+    
+    std::vector<Conversion> conversions(takes.size());
+    std::vector<Take> modelTakes(takes.size());
+    std::vector<float> resampled;
+    
+    auto deliver = [&](size_t t, const float* samples, int numSamples) {
+        const Take& take = takes[t];
+        Conversion& conversion = conversions[t];
+        const int count = std::min(numSamples, take.numSamples - conversion.written);
+        if (count <= 0) {
+            return;
+        }
+        
+        if (take.output != nullptr) {
+            std::copy(samples, samples + count, take.output + conversion.written);
+        }
+        if (take.onOutput) {
+            take.onOutput(samples, conversion.written, count);
+        }
+        conversion.written += count;
+    };
+    
+    for (size_t t = 0; t < takes.size(); t++) {
+        Conversion& conversion = conversions[t];
+        conversion.modelInput = Resampler::resample(takes[t].input, takes[t].numSamples, sampleRate, analysisRate);
+        conversion.outputResampler.prepare(analysisRate, sampleRate, chunkSettings.chunkFrames * hopSize);
+        
+        modelTakes[t].input = conversion.modelInput.data();
+        modelTakes[t].numSamples = (int)conversion.modelInput.size();
+        modelTakes[t].onOutput = [&, t](const float* samples, int, int numSamples) {
+            Resampler& resampler = conversions[t].outputResampler;
+            resampled.resize(std::max(resampled.size(), (size_t)resampler.getMaxOutputSamples(numSamples)));
+            const int produced = resampler.process(samples, numSamples, resampled.data(), (int)resampled.size());
+            deliver(t, resampled.data(), produced);
+        };
+    }
+    
+    const bool success = convertTakes(modelTakes, onProgress);
+    if (!success && shouldCancel && shouldCancel()) {
+        return false;
+    }
+    
+    for (size_t t = 0; t < takes.size(); t++) {
+        Take& take = takes[t];
+        Conversion& conversion = conversions[t];
+        take.converted = modelTakes[t].converted;
+        
+        Resampler& resampler = conversion.outputResampler;
+        resampled.resize(std::max(resampled.size(), (size_t)resampler.getMaxOutputSamples(resampler.getLookaheadSamples() + 1)));
+        const int tail = resampler.flush(resampled.data(), (int)resampled.size());
+        deliver(t, resampled.data(), tail);
+        
+        if (conversion.written >= take.numSamples) {
+            continue;
+        }
+        
+        if (!take.converted) {
+            // Whatever wasn't converted (a take too short to analyse, or everything
+            // after a failed run) passes through
+            deliver(t, take.input + conversion.written, take.numSamples - conversion.written);
+        } else {
+            // Rounding in the rate conversion can leave the take a sample or two short
+            std::fill(resampled.begin(), resampled.end(), 0.0f);
+            while (conversion.written < take.numSamples) {
+                deliver(t, resampled.data(), std::min((int)resampled.size(), take.numSamples - conversion.written));
+            }
+        }
+    }
+    
+    return success;
+}
+
+bool OfflineVoiceProcessor::convertTakes(std::vector<Take>& takes,
+                                         const ProgressCallback& onProgress) {
+    auto passThrough = [](const Take& take, int from) {
+        if (take.output != nullptr) {
+            std::copy(take.input + from, take.input + take.numSamples, take.output + from);
+        }
+    };
+    
+    for (auto& take : takes) {
+        take.converted = false;
+    }
+    
+    if (!onnxInference.isLoaded()) {
+        statusMessage = "No voice model loaded";
+        for (const auto& take : takes) {
+            passThrough(take, 0);
+        }
+        return false;
+    }
+    
+    const int numMelBands = melSpec.getNumMelBands();
+    const int chunkFrames = std::max(1, chunkSettings.chunkFrames);
+    const int crossfadeSamples = std::max(0, chunkSettings.crossfadeFrames) * hopSize;
+    const int halfFade = crossfadeSamples / 2;
+    
+    // Context on each side, plus enough to cover the crossfade overlap
+    const int padFrames = std::max(0, chunkSettings.contextFrames) + (halfFade + hopSize - 1) / hopSize;
+    
+    // Every chunk is extracted over the same window length (zero-padded past the
+    // take edges), so any set of chunks can share one batched tensor
+    const int windowFrames = chunkFrames + 2 * padFrames;
+    const int windowSamples = (windowFrames - 1) * hopSize + fftSize;
+    
+    struct TakeState {
+        int totalFrames = 0;
+        int numChunks = 0;
+        int emitted = 0; // Next output sample to deliver
+        std::vector<float> fadeTail;
+        
+        // Cache state: mapped features on a hit, recorded features and output on a miss
+        std::string featureKey;
+        std::string renderKey;
+        std::unique_ptr<ConversionCache::Entry> cachedFeatures;
+        std::vector<float> recordedF0;
+        std::vector<float> recordedMel;
+        std::vector<float> rendered;
+    };
+    
+    struct ChunkRef {
+        int take;
+        int firstFrame;
+    };
+    
+    if (cache != nullptr && modelHash.empty()) {
+        modelHash = cache->hashFile(juce::File(activeModelPath));
+    }
+    
+    // Queue the chunks of every take in order
+    bool allProcessed = true;
+    int cachedRenders = 0;
+    std::vector<TakeState> states(takes.size());
+    std::vector<ChunkRef> chunks;
+    
+    // After a failed run, takes already converted keep their output; only what
+    // the others had not yet received passes through
+    auto passThroughUnconverted = [&] {
+        for (size_t t = 0; t < takes.size(); t++) {
+            if (!takes[t].converted) {
+                passThrough(takes[t], states[t].emitted);
+            }
+        }
+    };
+    
+    for (size_t t = 0; t < takes.size(); t++) {
+        Take& take = takes[t];
+        TakeState& state = states[t];
+        
+        state.totalFrames = (take.numSamples - fftSize) / hopSize + 1;
+        if (state.totalFrames <= 0) {
+            statusMessage = "Audio too short for processing";
+            passThrough(take, 0);
+            allProcessed = false;
+            continue;
+        }
+        
+        state.numChunks = (state.totalFrames + chunkFrames - 1) / chunkFrames;
+        
+        if (cache != nullptr) {
+            const std::string audioHash = ConversionCache::hashAudio(take.input, take.numSamples);
+            const std::string analysis = std::to_string(analysisRate) + "/" + std::to_string(fftSize) + "/"
+                                       + std::to_string(hopSize) + "/" + std::to_string(numMelBands) + "/"
+                                       + std::to_string(chunkFrames) + "/" + std::to_string(padFrames);
+            
+            state.featureKey = ConversionCache::makeKey({ "features", audioHash, analysis });
+            state.renderKey = ConversionCache::makeKey({ "render", audioHash, analysis, modelHash,
+                                                         std::to_string(pitchShiftSemitones),
+                                                         std::to_string(formantShiftSemitones),
+                                                         std::to_string(crossfadeSamples) });
+            
+            // A finished render for the same audio and settings comes straight back
+            auto render = cache->open(state.renderKey);
+            if (render != nullptr && render->getNumArrays() == 1
+                && render->getArrayLength(0) == (size_t)take.numSamples) {
+                if (take.output != nullptr) {
+                    std::copy(render->getArray(0), render->getArray(0) + take.numSamples, take.output);
+                }
+                if (take.onOutput) {
+                    take.onOutput(render->getArray(0), 0, take.numSamples);
+                }
+                take.converted = true;
+                cachedRenders++;
+                continue;
+            }
+            
+            // Cached features skip extraction for every chunk of the take
+            auto features = cache->open(state.featureKey);
+            if (features != nullptr && features->getNumArrays() == 2
+                && features->getParam(0) == windowFrames && features->getParam(1) == numMelBands
+                && features->getParam(2) == state.numChunks
+                && features->getArrayLength(0) == (size_t)state.numChunks * windowFrames
+                && features->getArrayLength(1) == (size_t)state.numChunks * windowFrames * numMelBands) {
+                state.cachedFeatures = std::move(features);
+            } else {
+                state.recordedF0.reserve((size_t)state.numChunks * windowFrames);
+                state.recordedMel.reserve((size_t)state.numChunks * windowFrames * numMelBands);
+            }
+            
+            if (take.output == nullptr) {
+                state.rendered.resize(take.numSamples);
+            }
+        }
+        
+        state.fadeTail.assign(crossfadeSamples, 0.0f);
+        for (int c0 = 0; c0 < state.totalFrames; c0 += chunkFrames) {
+            chunks.push_back({ (int)t, c0 });
+        }
+    }
+    
+    if (chunks.empty()) {
+        if (cachedRenders > 0) {
+            statusMessage = "Processing complete: " + std::to_string(cachedRenders) + " take(s) from cache";
+            if (onProgress) {
+                onProgress(1.0f);
+            }
+        }
+        return allProcessed && cachedRenders > 0;
+    }
+    
+    int chunksPerRun = batchSize > 0 ? batchSize
+                                     : onnxInference.chooseBatchSize(windowFrames, numMelBands, maxAutoBatchSize);
+    chunksPerRun = std::max(1, std::min(chunksPerRun, (int)chunks.size()));
+    
+    // Working memory is sized by the batch and chunk, independent of take length
+    std::vector<float> windowInput(windowSamples);
+    std::vector<float> f0Curve;
+    std::vector<float> melSpecData;
+    f0Curve.reserve(windowFrames);
+    melSpecData.reserve((size_t)windowFrames * numMelBands);
+    
+    std::vector<float> batchF0((size_t)chunksPerRun * windowFrames);
+    std::vector<float> batchMel((size_t)chunksPerRun * windowFrames * numMelBands);
+    // Laying the batch out the way the model writes it lets inference fill it in place
+    int outputStride = onnxInference.getOutputLength(chunksPerRun, windowFrames, numMelBands);
+    if (outputStride <= 0) {
+        outputStride = windowSamples;
+    }
+    std::vector<float> batchOutput((size_t)chunksPerRun * outputStride);
+    std::vector<float> segment((size_t)chunkFrames * hopSize + fftSize + hopSize + crossfadeSamples);
+    
+    for (size_t first = 0; first < chunks.size(); first += chunksPerRun) {
+        const int numInBatch = (int)std::min((size_t)chunksPerRun, chunks.size() - first);
+        
+        if (shouldCancel && shouldCancel()) {
+            statusMessage = "Cancelled";
+            return false;
+        }
+        
+        statusMessage = "Processing chunks " + std::to_string(first + 1) + "-"
+                      + std::to_string(first + numInBatch) + " of " + std::to_string(chunks.size());
+        
+        // Features for each chunk in the batch
+        for (int b = 0; b < numInBatch; b++) {
+            const ChunkRef& chunk = chunks[first + b];
+            const Take& take = takes[chunk.take];
+            TakeState& state = states[chunk.take];
+            const int chunkIndex = chunk.firstFrame / chunkFrames;
+            
+            if (state.cachedFeatures != nullptr) {
+                const float* f0 = state.cachedFeatures->getArray(0) + (size_t)chunkIndex * windowFrames;
+                const float* mel = state.cachedFeatures->getArray(1) + (size_t)chunkIndex * windowFrames * numMelBands;
+                f0Curve.assign(f0, f0 + windowFrames);
+                melSpecData.assign(mel, mel + (size_t)windowFrames * numMelBands);
+            } else {
+                const int baseSample = (chunk.firstFrame - padFrames) * hopSize;
+                
+                for (int i = 0; i < windowSamples; i++) {
+                    const int src = baseSample + i;
+                    windowInput[i] = (src >= 0 && src < take.numSamples) ? take.input[src] : 0.0f;
+                }
+                
+                if (!extractFeatures(windowInput.data(), windowSamples, f0Curve, melSpecData)) {
+                    passThroughUnconverted();
+                    return false;
+                }
+                
+                if (cache != nullptr) {
+                    state.recordedF0.insert(state.recordedF0.end(), f0Curve.begin(), f0Curve.end());
+                    state.recordedMel.insert(state.recordedMel.end(), melSpecData.begin(), melSpecData.end());
+                }
+            }
+            
+            transposeF0(f0Curve);
+            
+            std::copy(f0Curve.begin(), f0Curve.end(), batchF0.begin() + (size_t)b * windowFrames);
+            std::copy(melSpecData.begin(), melSpecData.end(),
+                      batchMel.begin() + (size_t)b * windowFrames * numMelBands);
+        }
+        
+        // One inference run for the whole batch
+        int samplesGenerated = onnxInference.processBatch(
+            batchF0.data(), batchMel.data(),
+            numInBatch, windowFrames, numMelBands,
+            batchOutput.data(), outputStride
+        );
+        
+        if (samplesGenerated <= 0) {
+            statusMessage = "ONNX inference failed - passthrough";
+            passThroughUnconverted();
+            return false;
+        }
+        
+        // Scatter: crossfade each chunk into its take and deliver the finished span
+        for (int b = 0; b < numInBatch; b++) {
+            const ChunkRef& chunk = chunks[first + b];
+            Take& take = takes[chunk.take];
+            TakeState& state = states[chunk.take];
+            float* chunkOutput = batchOutput.data() + (size_t)b * outputStride;
+            const int chunkSamples = std::min(samplesGenerated, windowSamples);
+            
+            applyFormantShift(chunkOutput, chunkSamples);
+            
+            const int c1 = std::min(state.totalFrames, chunk.firstFrame + chunkFrames);
+            const bool isFirst = (chunk.firstFrame == 0);
+            const bool isLast = (c1 == state.totalFrames);
+            const int baseSample = (chunk.firstFrame - padFrames) * hopSize;
+            
+            // Everything up to the start of the next crossfade is final now
+            const int end = isLast ? take.numSamples : c1 * hopSize - halfFade;
+            const int count = end - state.emitted;
+            
+            for (int i = 0; i < count; i++) {
+                const int src = state.emitted + i - baseSample;
+                float sample = (src >= 0 && src < chunkSamples) ? chunkOutput[src] : 0.0f;
+                
+                // Overlap-add with the previous chunk's faded-out tail
+                if (!isFirst && i < crossfadeSamples) {
+                    const float fadeIn = (i + 0.5f) / crossfadeSamples;
+                    sample = state.fadeTail[i] + sample * fadeIn;
+                }
+                segment[i] = sample;
+            }
+            
+            if (!isLast) {
+                for (int i = 0; i < crossfadeSamples; i++) {
+                    const int src = end + i - baseSample;
+                    const float fadeOut = 1.0f - (i + 0.5f) / crossfadeSamples;
+                    state.fadeTail[i] = ((src >= 0 && src < chunkSamples) ? chunkOutput[src] : 0.0f) * fadeOut;
+                }
+            }
+            
+            if (take.output != nullptr) {
+                std::copy(segment.begin(), segment.begin() + count, take.output + state.emitted);
+            }
+            if (!state.rendered.empty()) {
+                std::copy(segment.begin(), segment.begin() + count, state.rendered.begin() + state.emitted);
+            }
+            if (take.onOutput) {
+                take.onOutput(segment.data(), state.emitted, count);
+            }
+            
+            state.emitted = end;
+            take.converted = isLast;
+            
+            if (isLast && cache != nullptr) {
+                storeInCache(state.featureKey, state.renderKey, state.recordedF0, state.recordedMel,
+                             take.output != nullptr ? take.output : state.rendered.data(), take.numSamples,
+                             windowFrames, numMelBands, state.numChunks);
+                
+                std::vector<float>().swap(state.recordedF0);
+                std::vector<float>().swap(state.recordedMel);
+                std::vector<float>().swap(state.rendered);
+                state.cachedFeatures.reset();
+            }
+        }
+        
+        if (onProgress) {
+            onProgress((float)(first + numInBatch) / (float)chunks.size());
+        }
+    }
+    
+    statusMessage = "Processing complete: " + std::to_string(takes.size()) + " take(s), "
+                  + std::to_string(chunks.size()) + " chunks, batch size " + std::to_string(chunksPerRun);
+    if (cachedRenders > 0) {
+        statusMessage += ", " + std::to_string(cachedRenders) + " from cache";
+    }
+    return allProcessed;
+}
+
+void OfflineVoiceProcessor::storeInCache(const std::string& featureKey, const std::string& renderKey,
+                                         const std::vector<float>& f0Data, const std::vector<float>& melData,
+                                         const float* rendered, int numSamples,
+                                         int windowFrames, int numMelBands, int numChunks) {
+    // Features are only recorded when they were extracted (not read from the cache)
+    if (!f0Data.empty()) {
+        const int32_t params[4] = { windowFrames, numMelBands, numChunks, 0 };
+        cache->store(featureKey, { { f0Data.data(), f0Data.size() }, { melData.data(), melData.size() } }, params);
+    }
+    
+    const int32_t params[4] = { numSamples, 0, 0, 0 };
+    cache->store(renderKey, { { rendered, (size_t)numSamples } }, params);
+}
+
+void OfflineVoiceProcessor::transposeF0(std::vector<float>& f0Curve) const {
+    if (std::abs(pitchShiftSemitones) < 0.01f) {
+        return;
+    }
+    
+    const float ratio = std::pow(2.0f, pitchShiftSemitones / 12.0f);
+    for (auto& f0 : f0Curve) {
+        if (f0 > 0.0f) {
+            f0 *= ratio;
+        }
+    }
+}
+
+void OfflineVoiceProcessor::applyFormantShift(float* buffer, int numSamples) {
+    if (std::abs(formantShiftSemitones) < 0.01f || numSamples <= 0) {
+        return;
+    }
+    
+    const float formantRatio = std::pow(2.0f, formantShiftSemitones / 12.0f);
+    const int frameSize = formantShifter.getFftSize();
+    const int hop = formantShifter.getHopSize();
+    
+    // Pad a frame of silence on both sides so the edges get full overlap
+    std::vector<float> padded(numSamples + 2 * frameSize, 0.0f);
+    std::vector<float> shifted(padded.size(), 0.0f);
+    std::vector<float> frameOut(frameSize);
+    std::copy(buffer, buffer + numSamples, padded.begin() + frameSize);
+    
+    formantShifter.reset();
+    
+    for (size_t start = 0; start + frameSize <= padded.size(); start += hop) {
+        formantShifter.processFrame(padded.data() + start, frameOut.data(), 1.0f, formantRatio);
+        for (int i = 0; i < frameSize; i++) {
+            shifted[start + i] += frameOut[i];
+        }
+    }
+    
+    std::copy(shifted.begin() + frameSize, shifted.begin() + frameSize + numSamples, buffer);
+}
+
 bool OfflineVoiceProcessor::isModelLoaded() const {
     return onnxInference.isLoaded();
 }
@@ -1,8 +1,16 @@
 #pragma once
 
+#include "AnalysisPool.h"
 #include "F0Extractor.h"
 #include "MelSpectrogram.h"
+#include "PitchShifter.h"
+#include "Resampler.h"
 #include "../AI/ONNXInference.h"
+#include "../Core/ConversionCache.h"
+#include "../Core/ModelCatalog.h"
+#include <algorithm>
+#include <functional>
+#include <memory>
 #include <vector>
 
 namespace blink {
@@ -13,21 +21,103 @@ namespace blink {
  */
 class OfflineVoiceProcessor {
 public:
+    /** Called after each chunk with the fraction of the take completed (0.0 to 1.0). */
+    using ProgressCallback = std::function<void(float progress)>;
+    
+    /** Polled between chunk batches; returning true abandons the conversion. */
+    using CancelCheck = std::function<bool()>;
+    
+    /** Receives finished output in order: samples [startSample, startSample + numSamples). */
+    using OutputCallback = std::function<void(const float* samples, int startSample, int numSamples)>;
+    
+    /**
+     * Window sizes for chunked inference (in feature frames of hopSize samples).
+     */
+    struct ChunkSettings {
+        int chunkFrames = 256;    // Frames per inference window (~3 s at 44.1 kHz)
+        int contextFrames = 16;   // Extra frames of model context on each side
+        int crossfadeFrames = 4;  // Overlap-add crossfade length at chunk edges
+    };
+    
+    /**
+     * One take for processTakes(). Chunks from all queued takes share batches.
+     */
+    struct Take {
+        const float* input = nullptr;
+        float* output = nullptr;      // Whole-take output, or nullptr to only stream via onOutput
+        int numSamples = 0;
+        OutputCallback onOutput;      // Optional, receives this take's finished spans
+        bool converted = false;       // Set by processTakes once the whole take is converted
+    };
+    
+    /**
+     * Quantized model variants. A model "voice.onnx" may ship with
+     * "voice.int8.onnx" and/or "voice.fp16.onnx" beside it; on first load every
+     * variant is timed on a reference clip and the fastest one whose output stays
+     * within the spectral tolerance of the full-precision model is used. The
+     * choice is kept in the model's ModelCatalog entry (see setModelCatalog)
+     * until any of the files change.
+     */
+    struct VariantSettings {
+        bool autoSelect = true;
+        float maxSpectralDistanceDb = 1.0f; // Mean log-mel difference allowed vs. the base model
+        int benchmarkRuns = 3;              // Timed runs per variant (fastest counts)
+    };
+
     OfflineVoiceProcessor();
     ~OfflineVoiceProcessor() = default;
 
     /**
-     * Set sample rate.
+     * Set the host sample rate of the audio passed in and returned.
      */
     void setSampleRate(double sampleRate);
 
     /**
-     * Load an ONNX voice model.
+     * Rate features are extracted and the model runs at: the loaded model's
+     * native rate if it declares one, otherwise the host rate. Audio is
+     * resampled to it before analysis and back after inference.
+     */
+    double getAnalysisSampleRate() const { return analysisRate; }
+
+    /**
+     * Load an ONNX voice model. Loading the model that is already loaded is a no-op,
+     * so repeated conversions with the same model skip session creation.
      * @param modelPath Path to .onnx model file
      * @return true if loaded successfully
      */
     bool loadVoiceModel(const std::string& modelPath);
 
+    void setVariantSettings(const VariantSettings& settings) { variantSettings = settings; }
+    const VariantSettings& getVariantSettings() const { return variantSettings; }
+
+    /**
+     * The file actually running for the loaded model: the model itself or the
+     * quantized variant chosen for it.
+     */
+    const std::string& getActiveModelPath() const { return activeModelPath; }
+
+    /**
+     * The model and the quantized variants found beside it, base model first.
+     */
+    static std::vector<std::string> findModelVariants(const std::string& modelPath);
+
+    /**
+     * Catalog holding each model's variant choice, so it is benchmarked once
+     * per machine. Without one (or for a model it doesn't list) the choice is
+     * made again whenever the model is loaded.
+     */
+    void setModelCatalog(std::shared_ptr<ModelCatalog> newCatalog) { modelCatalog = std::move(newCatalog); }
+
+    /**
+     * Transpose applied to the F0 curve before inference (semitones).
+     */
+    void setPitchShift(float semitones) { pitchShiftSemitones = semitones; }
+
+    /**
+     * Formant shift applied natively to the model output (semitones).
+     */
+    void setFormantShift(float semitones) { formantShiftSemitones = semitones; }
+
     /**
      * Process audio buffer offline (for pre-recorded vocals).
      * @param input Input audio buffer
@@ -37,6 +127,55 @@ public:
      */
     bool processOffline(const float* input, float* output, int numSamples);
 
+    /**
+     * Process audio in fixed-size windows of frames with context padding and
+     * crossfaded chunk edges. Peak memory depends on the chunk size, not the take
+     * length, and output starts arriving after the first chunk.
+     * @param input Input audio buffer
+     * @param output Output buffer for the whole take, or nullptr to only stream via onOutput
+     * @param numSamples Number of samples
+     * @param onProgress Optional progress callback
+     * @param onOutput Optional callback for each finished span of output
+     * @return true if processing successful
+     */
+    bool processOfflineChunked(const float* input, float* output, int numSamples,
+                               const ProgressCallback& onProgress = nullptr,
+                               const OutputCallback& onOutput = nullptr);
+
+    /**
+     * Chunk several takes (e.g. queued render jobs) and run their chunks through
+     * the model in batches of equal-length windows, scattering the results back
+     * to each take. A take's output arrives in order. If a run fails, takes
+     * already converted keep their output and the rest of the others passes through.
+     * @param takes Takes to convert; each one's converted flag is set on return
+     * @param onProgress Optional progress callback over all takes
+     * @return true if every take was converted
+     */
+    bool processTakes(std::vector<Take>& takes, const ProgressCallback& onProgress = nullptr);
+
+    /**
+     * Chunks per inference run. 0 (the default) picks the size with the best
+     * measured throughput on the loaded model.
+     */
+    void setBatchSize(int chunksPerRun) { batchSize = std::max(0, chunksPerRun); }
+    int getBatchSize() const { return batchSize; }
+
+    /**
+     * Disk cache for extracted features and finished renders (nullptr disables it).
+     * Takes whose audio and settings were converted before skip extraction, or
+     * come straight back from the cache when the model and shifts also match.
+     */
+    void setCache(std::shared_ptr<ConversionCache> newCache) { cache = std::move(newCache); }
+
+    /**
+     * Lets a long conversion be abandoned part way (nullptr to clear). A
+     * cancelled conversion returns false with status "Cancelled".
+     */
+    void setCancelCheck(CancelCheck check) { shouldCancel = std::move(check); }
+
+    void setChunkSettings(const ChunkSettings& settings) { chunkSettings = settings; }
+    const ChunkSettings& getChunkSettings() const { return chunkSettings; }
+
     /**
      * Check if a voice model is loaded.
      */
@@ -51,17 +190,85 @@ private:
     F0Extractor f0Extractor;
     MelSpectrogram melSpec;
     ONNXInference onnxInference;
+    PitchShifter formantShifter;
     
-    double sampleRate;
+    double sampleRate;    // Host rate
+    double analysisRate;  // Model rate (see getAnalysisSampleRate)
     int hopSize;
     int fftSize;
     
     std::string statusMessage;
+    std::string loadedModelPath;
+    std::string activeModelPath;
+    
+    VariantSettings variantSettings;
+    std::shared_ptr<ModelCatalog> modelCatalog;
+    
+    float pitchShiftSemitones;
+    float formantShiftSemitones;
+    
+    ChunkSettings chunkSettings;
+    int batchSize;
+    CancelCheck shouldCancel;
+    
+    std::shared_ptr<ConversionCache> cache;
+    std::string modelHash; // Content hash of the loaded model, computed on first cached use
+    
+    // Per-worker analysis state, so frames can be analysed concurrently
+    struct FrameAnalyzer {
+        FrameAnalyzer(double sampleRate, int fftSize, int hopSize, int numMelBands);
+        
+        PitchDetector pitchDetector;
+        MelSpectrogram melSpec;
+    };
+    
+    std::vector<std::unique_ptr<FrameAnalyzer>> analyzers;
+    std::shared_ptr<AnalysisPool> analysisPool;  // The process-wide pool, taken on first use
+    
+    static constexpr int minFramesPerTask = 32;
+    
+    static constexpr int maxAutoBatchSize = 8;
     
     // Extract features from audio
     bool extractFeatures(const float* input, int numSamples,
                         std::vector<float>& f0Curve,
                         std::vector<float>& melSpecData);
+    
+    // Point the analysers at analysisRate
+    void configureAnalysis();
+    
+    // Switch to the loaded model's native rate (host rate if it has none)
+    void updateModelRate();
+    
+    // processTakes at the analysis rate; takes must already be at that rate
+    bool convertTakes(std::vector<Take>& takes, const ProgressCallback& onProgress);
+    
+    // Create the workers and their analysers on first use
+    void prepareAnalyzers();
+    
+    // Detect raw F0 and mel frames for numFrames frames, split over the worker pool
+    void analyseFrames(const float* input, int numFrames, float* f0Out, float* melOut);
+    
+    // Write a finished take's features (if freshly extracted) and output to the cache
+    void storeInCache(const std::string& featureKey, const std::string& renderKey,
+                      const std::vector<float>& f0Data, const std::vector<float>& melData,
+                      const float* rendered, int numSamples,
+                      int windowFrames, int numMelBands, int numChunks);
+    
+    // Pick the variant to run for a model, benchmarking and recording the choice if needed
+    std::string selectModelVariant(const std::string& modelPath);
+    
+    // Synthetic sung phrase used as the reference clip when comparing variants
+    std::vector<float> makeReferenceClip() const;
+    
+    // Mean absolute log-mel difference between two renders, in dB
+    float spectralDistanceDb(const float* a, const float* b, int numSamples);
+    
+    // Scale voiced F0 values by the pitch shift
+    void transposeF0(std::vector<float>& f0Curve) const;
+    
+    // Formant-shift a whole buffer in place with overlap-add
+    void applyFormantShift(float* buffer, int numSamples);
 };
 
 } // namespace blink
@@ -42,12 +42,12 @@ void PitchCorrector::setKey(int rootKey) {
     this->rootKey = rootKey % 12;
     
     // Update active notes based on current scale
-    std::vector<int> intervals = getScaleIntervals(scaleType);
+    const ScaleIntervals& scale = getScaleIntervals(scaleType);
     for (int i = 0; i < 12; i++) {
         activeNotes[i] = false;
     }
-    for (int interval : intervals) {
-        activeNotes[(rootKey + interval) % 12] = true;
+    for (int i = 0; i < scale.count; i++) {
+        activeNotes[(rootKey + scale.intervals[i]) % 12] = true;
     }
 }
 
@@ -62,28 +62,38 @@ void PitchCorrector::setActiveNotes(const bool notes[12]) {
     }
 }
 
-std::vector<int> PitchCorrector::getScaleIntervals(ScaleType scale) const {
+const PitchCorrector::ScaleIntervals& PitchCorrector::getScaleIntervals(ScaleType scale) {
+    static constexpr ScaleIntervals major         { 7, { 0, 2, 4, 5, 7, 9, 11 } };
+    static constexpr ScaleIntervals minor         { 7, { 0, 2, 3, 5, 7, 8, 10 } };
+    static constexpr ScaleIntervals harmonicMinor { 7, { 0, 2, 3, 5, 7, 8, 11 } };
+    static constexpr ScaleIntervals melodicMinor  { 7, { 0, 2, 3, 5, 7, 9, 11 } };
+    static constexpr ScaleIntervals dorian        { 7, { 0, 2, 3, 5, 7, 9, 10 } };
+    static constexpr ScaleIntervals phrygian      { 7, { 0, 1, 3, 5, 7, 8, 10 } };
+    static constexpr ScaleIntervals lydian        { 7, { 0, 2, 4, 6, 7, 9, 11 } };
+    static constexpr ScaleIntervals mixolydian    { 7, { 0, 2, 4, 5, 7, 9, 10 } };
+    static constexpr ScaleIntervals chromatic     { 12, { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 } };
+
     switch (scale) {
         case ScaleType::Major:
-            return {0, 2, 4, 5, 7, 9, 11};
+            return major;
         case ScaleType::Minor:
-            return {0, 2, 3, 5, 7, 8, 10};
+            return minor;
         case ScaleType::HarmonicMinor:
-            return {0, 2, 3, 5, 7, 8, 11};
+            return harmonicMinor;
         case ScaleType::MelodicMinor:
-            return {0, 2, 3, 5, 7, 9, 11};
+            return melodicMinor;
         case ScaleType::Dorian:
-            return {0, 2, 3, 5, 7, 9, 10};
+            return dorian;
         case ScaleType::Phrygian:
-            return {0, 1, 3, 5, 7, 8, 10};
+            return phrygian;
         case ScaleType::Lydian:
-            return {0, 2, 4, 6, 7, 9, 11};
+            return lydian;
         case ScaleType::Mixolydian:
-            return {0, 2, 4, 5, 7, 9, 10};
+            return mixolydian;
         case ScaleType::Chromatic:
-            return {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+            return chromatic;
         default:
-            return {0, 2, 4, 5, 7, 9, 11}; // Default to Major
+            return major; // Default to Major
     }
 }
 
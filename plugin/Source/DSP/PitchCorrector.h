@@ -65,7 +65,13 @@ private:
     float smoothedTarget;
     
     // Scale definitions (intervals from root)
-    std::vector<int> getScaleIntervals(ScaleType scale) const;
+    struct ScaleIntervals {
+        int count;
+        int intervals[12];
+    };
+
+    // Returns a static table entry, so it is safe to call from the audio thread
+    static const ScaleIntervals& getScaleIntervals(ScaleType scale);
     
     // Find nearest note in active scale
     int findNearestScaleNote(float midiNote) const;
@@ -5,18 +5,44 @@
 namespace blink {
 
 PitchDetector::PitchDetector(double sr, int bs) : sampleRate(sr), bufferSize(bs) {
-    yinBuffer.resize(bufferSize / 2);
+    setBufferSize(bs);
+}
+
+void PitchDetector::setBufferSize(int newSize) {
+    bufferSize = newSize;
+    yinBuffer.resize(newSize / 2);
+    decimatedBuffer.resize(newSize);
 }
 
 float PitchDetector::getPitch(const float* buffer, int numSamples) {
+    voicingConfidence = 0.0f;
+
     if (buffer == nullptr || numSamples <= 0)
         return 0.0f;
 
-    const int analysisSize = std::min(bufferSize, numSamples);
+    int analysisSize = std::min(bufferSize, numSamples);
+    double analysisRate = sampleRate;
+
+    // Decimated analysis: average each group of samples (a crude low-pass is
+    // enough for the voice's fundamental) and run YIN on the result
+    if (decimation > 1) {
+        analysisSize /= decimation;
+        analysisRate /= decimation;
+        for (int i = 0; i < analysisSize; i++) {
+            float sum = 0.0f;
+            for (int j = 0; j < decimation; j++) {
+                sum += buffer[i * decimation + j];
+            }
+            decimatedBuffer[i] = sum / decimation;
+        }
+        buffer = decimatedBuffer.data();
+    }
+
     const int halfSize = analysisSize / 2;
     if (halfSize < 2)
         return 0.0f;
 
+    // Never grows past the size setBufferSize() reserved
     if ((int) yinBuffer.size() != halfSize)
         yinBuffer.resize(halfSize);
 
@@ -24,11 +50,12 @@ float PitchDetector::getPitch(const float* buffer, int numSamples) {
 
     difference(buffer, analysisSize);
     cumulativeMeanNormalizedDifference();
+    voicingConfidence = std::clamp(1.0f - minimumDifference(), 0.0f, 1.0f);
     tauEstimate = absoluteThreshold();
 
     if (tauEstimate != -1) {
         float betterTau = parabolicInterpolation(tauEstimate);
-        return (float)sampleRate / betterTau;
+        return (float)analysisRate / betterTau;
     }
 
     return 0.0f;
@@ -74,6 +101,15 @@ int PitchDetector::absoluteThreshold() {
     return -1;
 }
 
+float PitchDetector::minimumDifference() const {
+    // Same lag range absoluteThreshold() searches
+    float minimum = 1.0f;
+    for (int tau = 2; tau < yinBuffer.size(); tau++) {
+        minimum = std::min(minimum, yinBuffer[tau]);
+    }
+    return minimum;
+}
+
 float PitchDetector::parabolicInterpolation(int tauEstimate) {
     if (tauEstimate < 1 || tauEstimate >= yinBuffer.size() - 1) 
         return (float)tauEstimate;
@@ -1,10 +1,9 @@
 #pragma once
 
-#include <JuceHeader.h>
+#include <juce_dsp/juce_dsp.h>
+#include <memory>
 #include <vector>
-#include <complex>
-#include "TransientDetector.h"
-#include "LPCAnalyzer.h"
+#include "PitchShifterT.h"
 
 namespace blink {
 
@@ -12,11 +11,22 @@ namespace blink {
  * Professional Phase Vocoder with JUCE FFT and dynamic sample rate support.
  * Implements SMB-style pitch shifting with formant preservation.
  * Supports independent control of pitch and spectral envelope (formants).
+ *
+ * The vocoder itself runs in PitchShifterT kernels compiled for each supported
+ * configuration: frames of 1024, 2048 or 4096 samples with 2x, 4x or 8x
+ * overlap. This class picks the one matching its sizes at run time.
  */
 class PitchShifter {
 public:
+    /**
+     * Sizes outside the supported configurations assert in debug builds and
+     * fall back to 2048-sample frames with 4x overlap.
+     */
     PitchShifter(int fftSize, int hopSize);
-    ~PitchShifter() = default;
+    ~PitchShifter();
+
+    /** True if PitchShifterT kernels are compiled for these sizes. */
+    static bool isSupported(int fftSize, int hopSize);
 
     /**
      * Set the sample rate for accurate frequency calculations.
@@ -33,59 +43,77 @@ public:
      */
     void process(const float* input, float* output, float pitchRatio, float formantRatio);
 
+    /**
+     * Processes one analysis frame directly, for callers that run their own overlap-add.
+     * The output is windowed and normalised so frames taken every hopSize samples
+     * sum back to unity gain.
+     * @param frame Input frame (fftSize samples)
+     * @param output Output frame (fftSize samples)
+     * @param pitchRatio Frequency scaling factor
+     * @param formantRatio Formant scaling factor (1.0 = no change)
+     */
+    void processFrame(const float* frame, float* output, float pitchRatio, float formantRatio);
+
+    /**
+     * Voicing confidence of the audio about to be processed, 0 (noise, silence)
+     * to 1 (clearly pitched), e.g. PitchDetector::getVoicingConfidence().
+     * Frames below the unvoiced threshold skip the vocoder and pass through
+     * dry, at the same latency; frames just above it crossfade between the two.
+     * Stays at 1 (always process) unless set.
+     */
+    void setVoicingConfidence(float confidence) { settings->voicingConfidence = confidence; }
+
+    /**
+     * Confidence below which frames bypass the vocoder. 0 disables the bypass.
+     * Default: 0.5
+     */
+    void setUnvoicedThreshold(float threshold) { settings->unvoicedThreshold = threshold; }
+
+    /**
+     * Formant preservation by LPC envelope (default), or by the cheaper
+     * smoothed-spectrum envelope. Takes effect from the next frame.
+     */
+    void setUseLPCFormants(bool useLPC) { settings->useLPCFormants = useLPC; }
+
+    /**
+     * Change the hop between frames, for callers of processFrame() that run their
+     * own overlap-add; it must give 2x, 4x or 8x overlap. Call at a hop boundary:
+     * the next frame's phase advance assumes the new hop.
+     */
+    void setHopSize(int newHopSize);
+
+    /**
+     * Gain processFrame() applies on top of the squared Hann window, so frames
+     * at the current hop sum to unity. Callers normalising their overlap-add
+     * by the accumulated window can weight it by hann^2 times this.
+     */
+    float getWindowNorm() const { return windowNorm; }
+
+    /**
+     * Clears phase history and FIFOs, e.g. before rendering a new take.
+     */
+    void reset();
+
+    int getFftSize() const { return fftSize; }
+    int getHopSize() const { return hopSize; }
+
 private:
     int fftSize;
     int hopSize;
-    int osamp; // Oversampling factor
-    double sampleRate;
-    float freqPerBin;
-    
-    // JUCE FFT
-    std::unique_ptr<juce::dsp::FFT> fft;
-    int fftOrder;
-    
-    // Window and FFT buffers
-    std::vector<float> window;
-    std::vector<float> fftBuffer;
-    std::vector<float> lastPhase;
-    std::vector<float> sumPhase;
-
-    // FFT processing buffers (interleaved real/imag for JUCE FFT)
-    std::vector<float> fftData;
-    std::vector<float> magnitude;
-    std::vector<float> phase;
-    std::vector<float> instFreq;
-    std::vector<float> newMagnitude;
-    std::vector<float> newPhase;
-    std::vector<float> envelope;
-    std::vector<float> warpedEnvelope;
-    
+    float windowNorm;
+
+    // PitchShifterState and kernels for the configured frame size
+    struct Engine;
+    template <int FrameSize> struct EngineT;
+    std::unique_ptr<Engine> engine;
+    PitchShifterSettings* settings;  // The engine's
+
     // Overlap-add buffers
     std::vector<float> inFIFO;
     std::vector<float> outFIFO;
     std::vector<float> outputAccum;
     int inFIFOIndex;
     int outFIFOIndex;
-    float windowNorm;
-    
-    // Process one frame
-    void processFrame(const float* frame, float pitchRatio, float formantRatio);
-    
-    // Spectral envelope for formant preservation
-    void shiftFormants(std::vector<std::complex<float>>& spectrum, float ratio);
-    
-    // Helper: Calculate FFT order from size
-    int calculateFFTOrder(int size);
-    
-    // Transient detection
-    TransientDetector transientDetector;
-    bool bypassPitchShiftOnTransient;
-    
-    // LPC formant analysis
-    LPCAnalyzer lpcAnalyzer;
-    std::vector<float> lpcEnvelope;
-    std::vector<float> warpedLPCEnvelope;
-    bool useLPCFormants;
 };
 
 } // namespace blink
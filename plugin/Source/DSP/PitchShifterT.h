@@ -0,0 +1,443 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include "SharedTables.h"
+#include "TransientDetector.h"
+#include "LPCAnalyzer.h"
+
+namespace blink {
+
+namespace detail {
+
+/** Hann window 0.5 * (1 - cos(2 pi n / (size - 1))), built at compile time. */
+template <int Size>
+constexpr std::array<float, Size> makeHannWindow() {
+    // cos(theta) by Taylor series, then cos(n theta) by the Chebyshev recurrence
+    // cos((n + 1) theta) = 2 cos(theta) cos(n theta) - cos((n - 1) theta)
+    const double theta = 2.0 * 3.14159265358979323846 / (Size - 1);
+    double cosTheta = 1.0;
+    double term = 1.0;
+    for (int n = 1; n < 12; n++) {
+        term *= -theta * theta / ((2 * n - 1) * (2 * n));
+        cosTheta += term;
+    }
+
+    std::array<float, Size> window {};
+    double previous = cosTheta;  // cos(-theta)
+    double current = 1.0;        // cos(0)
+    for (int n = 0; n < Size; n++) {
+        window[n] = (float)(0.5 * (1.0 - current));
+        const double next = 2.0 * cosTheta * current - previous;
+        previous = current;
+        current = next;
+    }
+    return window;
+}
+
+/** Gain that makes hann^2 frames taken every hopSize samples sum to unity. */
+template <int Size, int HopSize>
+constexpr float overlapAddNorm(const std::array<float, Size>& window) {
+    float sum = 0.0f;
+    for (int i = 0; i < Size; i += HopSize) {
+        sum += window[i] * window[i];
+    }
+    return 1.0f / (sum + 0.0001f);
+}
+
+constexpr int log2(int size) {
+    int order = 0;
+    while ((1 << order) < size) {
+        order++;
+    }
+    return order;
+}
+
+} // namespace detail
+
+/**
+ * Settings and analysers of a phase vocoder, whatever its frame size.
+ */
+struct PitchShifterSettings {
+    explicit PitchShifterSettings(int fftSize) : transientDetector(fftSize), lpcAnalyzer(12) {}
+
+    double sampleRate = 44100.0;
+    float freqPerBin = 0.0f;
+
+    // Transient detection
+    TransientDetector transientDetector;
+    bool bypassPitchShiftOnTransient = true;
+
+    // LPC formant analysis
+    LPCAnalyzer lpcAnalyzer;
+    bool useLPCFormants = true;
+
+    // Voicing gate: unvoiced frames bypass the vocoder
+    float voicingConfidence = 1.0f;
+    float unvoicedThreshold = 0.5f;
+    static constexpr float voicingFadeWidth = 0.2f; // Confidence range of the dry/wet crossfade
+    bool phaseStale = false;  // Set after bypassed frames; phase history restarts from the next one
+};
+
+/**
+ * Buffers and phase history of a FrameSize-point phase vocoder, in fixed-size
+ * 16-byte aligned arrays. Shared by the kernels of every hop at that size, so
+ * the hop can change between frames without losing the phase history.
+ */
+template <int FrameSize>
+struct PitchShifterState : PitchShifterSettings {
+    static constexpr int numBins = FrameSize / 2 + 1;
+    static constexpr int fftOrder = detail::log2(FrameSize);
+
+    // Analysis and synthesis window, shared by the kernels of every hop
+    static constexpr std::array<float, FrameSize> window = detail::makeHannWindow<FrameSize>();
+
+    PitchShifterState() : PitchShifterSettings(FrameSize), fft(SharedTables::getFFT(fftOrder)) {
+        setSampleRate(sampleRate);
+    }
+
+    void setSampleRate(double newSampleRate) {
+        sampleRate = newSampleRate;
+        freqPerBin = (float)sampleRate / FrameSize;
+    }
+
+    /** Clears phase history, e.g. before rendering a new take. */
+    void reset() {
+        lastPhase.fill(0.0f);
+        sumPhase.fill(0.0f);
+        phaseStale = false;
+    }
+
+    // FFT plan, shared with other instances of the same size
+    std::shared_ptr<const juce::dsp::FFT> fft;
+
+    // The last frame processed, windowed and normalised for overlap-add
+    alignas(16) std::array<float, FrameSize> output {};
+
+    // Interleaved real/imag for the JUCE FFT
+    alignas(16) std::array<float, FrameSize * 2> fftData {};
+
+    alignas(16) std::array<float, numBins> lastPhase {};
+    alignas(16) std::array<float, numBins> sumPhase {};   // Synthesis phase of the previous frame
+    alignas(16) std::array<float, numBins> magnitude {};
+    alignas(16) std::array<float, numBins> phase {};
+    alignas(16) std::array<float, numBins> instFreq {};
+    alignas(16) std::array<float, numBins> newMagnitude {};
+    alignas(16) std::array<float, numBins> newPhase {};
+    alignas(16) std::array<float, numBins> envelope {};
+    alignas(16) std::array<float, numBins> warpedEnvelope {};
+    alignas(16) std::array<float, numBins> lpcEnvelope {};
+    alignas(16) std::array<float, numBins> warpedLPCEnvelope {};
+    std::array<int, numBins> peakBins {};                     // Spectral peaks of the current frame
+};
+
+/**
+ * Phase-vocoder kernels compiled for one frame/hop configuration.
+ *
+ * With the sizes known at compile time, the window and its overlap-add gain are
+ * constants and every loop has a fixed trip count over aligned arrays, so the
+ * compiler can unroll and vectorise them. PitchShifter picks the instantiation
+ * matching its run-time sizes; code with a fixed configuration can own a
+ * PitchShifterState and call processFrame() directly.
+ */
+template <int FrameSize, int HopSize>
+class PitchShifterT {
+public:
+    static_assert(FrameSize > 0 && (FrameSize & (FrameSize - 1)) == 0, "FrameSize must be a power of two");
+    static_assert(HopSize > 0 && FrameSize % HopSize == 0, "HopSize must divide FrameSize");
+
+    using State = PitchShifterState<FrameSize>;
+
+    static constexpr int fftSize = FrameSize;
+    static constexpr int hopSize = HopSize;
+    static constexpr int osamp = FrameSize / HopSize;
+    static constexpr int numBins = State::numBins;
+
+    static constexpr const std::array<float, FrameSize>& window = State::window;
+    static constexpr float windowNorm = detail::overlapAddNorm<FrameSize, HopSize>(window);
+
+    /**
+     * Shift one frame into state.output, windowed and normalised so frames taken
+     * every HopSize samples sum back to unity gain.
+     * @param frame Input frame (FrameSize samples)
+     * @param pitchRatio Frequency scaling factor
+     * @param formantRatio Formant scaling factor (1.0 = no change)
+     */
+    static void processFrame(State& state, const float* frame, float pitchRatio, float formantRatio);
+
+private:
+    // Input with analysis and synthesis windows applied, for bypassed frames
+    static void writeDryFrame(State& state, const float* frame);
+
+    static void shiftFormantsLPC(State& state, const float* frame, float formantRatio);
+    static void shiftFormantsSmoothed(State& state, float pitchRatio, float formantRatio);
+};
+
+template <int FrameSize, int HopSize>
+void PitchShifterT<FrameSize, HopSize>::writeDryFrame(State& state, const float* frame) {
+    // Same gain (and latency) as a processed frame
+    for (int i = 0; i < FrameSize; i++) {
+        state.output[i] = frame[i] * window[i] * window[i] * windowNorm;
+    }
+}
+
+template <int FrameSize, int HopSize>
+void PitchShifterT<FrameSize, HopSize>::processFrame(State& state, const float* frame,
+                                                     float pitchRatio, float formantRatio) {
+    constexpr float pi = juce::MathConstants<float>::pi;
+    constexpr float twoPi = 2.0f * pi;
+    constexpr float expectedPhaseDiff = twoPi * HopSize / FrameSize;
+
+    // Unvoiced frames (consonants, breaths, noise) have no pitch to shift:
+    // below the threshold they skip the vocoder, and just above it they are
+    // blended with the dry frame so the switch doesn't click
+    const float wetAmount = (state.unvoicedThreshold > 0.0f)
+        ? std::clamp((state.voicingConfidence - state.unvoicedThreshold) / state.voicingFadeWidth, 0.0f, 1.0f)
+        : 1.0f;
+
+    // Detect transients (consonants, attacks)
+    const bool isTransient = wetAmount > 0.0f && state.transientDetector.detectTransient(frame, FrameSize);
+
+    // Bypass pitch shifting on unvoiced frames and transients to preserve clarity
+    if (wetAmount <= 0.0f || (state.bypassPitchShiftOnTransient && isTransient && std::abs(pitchRatio - 1.0f) > 0.01f)) {
+        writeDryFrame(state, frame);
+        state.phaseStale = true;
+        return;
+    }
+
+    state.newMagnitude.fill(0.0f);
+    state.newPhase.fill(0.0f);
+
+    // 1. ANALYSIS: Apply window (real-only FFT takes FrameSize contiguous samples)
+    float* fftData = state.fftData.data();
+    for (int i = 0; i < FrameSize; i++) {
+        fftData[i] = frame[i] * window[i];
+    }
+    std::fill(fftData + FrameSize, fftData + 2 * FrameSize, 0.0f);
+
+    // 2. Forward FFT using JUCE (complex output; phase is needed below)
+    state.fft->performRealOnlyForwardTransform(fftData, true);
+
+    // 3. Convert to magnitude and phase
+    for (int k = 0; k < numBins; k++) {
+        const float real = fftData[k * 2];
+        const float imag = fftData[k * 2 + 1];
+        state.magnitude[k] = sqrtf(real * real + imag * imag);
+        state.phase[k] = atan2f(imag, real);
+    }
+
+    // After bypassed frames the phase history is out of date: restart it from
+    // this frame, so unshifted bins keep the phase of the dry frames before it
+    if (state.phaseStale) {
+        for (int k = 0; k < numBins; k++) {
+            state.lastPhase[k] = state.phase[k] - k * expectedPhaseDiff;
+            state.sumPhase[k] = state.phase[k] - k * expectedPhaseDiff;
+        }
+        state.phaseStale = false;
+    }
+
+    // 4. INSTANTANEOUS FREQUENCY: Calculate true frequency of each bin
+    for (int k = 0; k < numBins; k++) {
+        // Phase difference
+        float phaseDiff = state.phase[k] - state.lastPhase[k];
+        state.lastPhase[k] = state.phase[k];
+
+        // Unwrap phase (bring into -π to π range)
+        phaseDiff -= k * expectedPhaseDiff;
+        int qpd = (int)(phaseDiff / pi);
+        if (qpd >= 0) qpd += qpd & 1;
+        else qpd -= qpd & 1;
+        phaseDiff -= pi * qpd;
+
+        // Calculate instantaneous frequency
+        const float deviation = phaseDiff * osamp / twoPi;
+        state.instFreq[k] = (k + deviation) * state.freqPerBin;
+    }
+
+    // 5. PITCH SHIFTING with identity phase locking (Laroche-Dolson):
+    // each spectral peak moves with its region of influence as one block, and
+    // the whole region gets the peak's phase rotation so partials stay coherent.
+    const float* magnitude = state.magnitude.data();
+    int numPeaks = 0;
+    for (int k = 2; k < numBins - 2; k++) {
+        const float m = magnitude[k];
+        if (m > 1.0e-6f && m > magnitude[k - 1] && m >= magnitude[k + 1]
+            && m > magnitude[k - 2] && m >= magnitude[k + 2]) {
+            state.peakBins[numPeaks++] = k;
+        }
+    }
+
+    const float synthAdvanceScale = twoPi * pitchRatio * HopSize / (float)state.sampleRate;
+    for (int p = 0; p < numPeaks; p++) {
+        const int peak = state.peakBins[p];
+        const int regionStart = (p == 0) ? 0 : (state.peakBins[p - 1] + peak) / 2 + 1;
+        const int regionEnd = (p == numPeaks - 1) ? numBins - 1 : (peak + state.peakBins[p + 1]) / 2;
+
+        const int targetBin = (int)std::round(peak * pitchRatio);
+        if (targetBin < 0 || targetBin >= numBins) {
+            continue;
+        }
+        const int shift = targetBin - peak;
+
+        // Advance the synthesis phase at the target bin by the shifted true frequency
+        const float synthAdvance = state.instFreq[peak] * synthAdvanceScale;
+        const float rotation = state.sumPhase[targetBin] + synthAdvance - state.phase[peak];
+
+        for (int k = regionStart; k <= regionEnd; k++) {
+            const int newBin = k + shift;
+            if (newBin < 0 || newBin >= numBins) {
+                continue;
+            }
+            // Overlapping regions (downward shifts) keep the louder contribution
+            if (magnitude[k] > state.newMagnitude[newBin]) {
+                state.newMagnitude[newBin] = magnitude[k];
+                state.newPhase[newBin] = state.phase[k] + rotation;
+            }
+        }
+    }
+
+    // Keep the synthesis phase history for the next frame; silent bins advance at bin centre
+    for (int k = 0; k < numBins; k++) {
+        if (state.newMagnitude[k] > 0.0f) {
+            state.sumPhase[k] = state.newPhase[k] - twoPi * std::floor(state.newPhase[k] / twoPi);
+        } else {
+            state.sumPhase[k] += k * expectedPhaseDiff;
+            state.sumPhase[k] -= twoPi * std::floor(state.sumPhase[k] / twoPi);
+        }
+    }
+
+    // 6. FORMANT PRESERVATION
+    if (std::abs(formantRatio - 1.0f) > 0.01f) {
+        if (state.useLPCFormants) {
+            shiftFormantsLPC(state, frame, formantRatio);
+        } else {
+            shiftFormantsSmoothed(state, pitchRatio, formantRatio);
+        }
+    }
+
+    // 7. Convert back to real/imaginary for inverse FFT
+    for (int k = 0; k < numBins; k++) {
+        fftData[k * 2] = state.newMagnitude[k] * cosf(state.newPhase[k]);
+        fftData[k * 2 + 1] = state.newMagnitude[k] * sinf(state.newPhase[k]);
+    }
+
+    // Mirror for negative frequencies (JUCE FFT requirement)
+    for (int k = numBins; k < FrameSize; k++) {
+        fftData[k * 2] = fftData[(FrameSize - k) * 2];
+        fftData[k * 2 + 1] = -fftData[(FrameSize - k) * 2 + 1];
+    }
+
+    // 8. Inverse FFT using JUCE (real samples come back in the first FrameSize floats)
+    state.fft->performRealOnlyInverseTransform(fftData);
+
+    // 9. Apply window and normalize
+    for (int i = 0; i < FrameSize; i++) {
+        state.output[i] = fftData[i] * window[i] * windowNorm;
+    }
+
+    // 10. Crossfade with the dry frame on weakly voiced frames
+    if (wetAmount < 1.0f) {
+        const float dryAmount = 1.0f - wetAmount;
+        for (int i = 0; i < FrameSize; i++) {
+            state.output[i] = wetAmount * state.output[i]
+                            + dryAmount * frame[i] * window[i] * window[i] * windowNorm;
+        }
+    }
+}
+
+template <int FrameSize, int HopSize>
+void PitchShifterT<FrameSize, HopSize>::shiftFormantsLPC(State& state, const float* frame, float formantRatio) {
+    // Step 1: Analyze vocal tract with LPC
+    state.lpcAnalyzer.analyze(frame, FrameSize);
+
+    // Step 2: Get spectral envelope from LPC. The bins sit at 2 pi k / FrameSize,
+    // so one FFT of the zero-padded inverse filter [1, a1 .. ap] evaluates
+    // 1 / |A(w)| at all of them, instead of p sin/cos pairs per bin. fftData is
+    // free between analysis and resynthesis.
+    const auto& coeffs = state.lpcAnalyzer.getCoefficients();
+    float* inverseFilter = state.fftData.data();
+    std::fill(inverseFilter, inverseFilter + 2 * FrameSize, 0.0f);
+    inverseFilter[0] = 1.0f;
+    for (int j = 1; j < (int)coeffs.size() && j < FrameSize; j++) {
+        inverseFilter[j] = coeffs[j];
+    }
+    state.fft->performRealOnlyForwardTransform(inverseFilter, true);
+
+    for (int k = 0; k < numBins; k++) {
+        const float real = inverseFilter[k * 2];
+        const float imag = inverseFilter[k * 2 + 1];
+        state.lpcEnvelope[k] = 1.0f / sqrtf(real * real + imag * imag);
+    }
+
+    // Step 3: Warp the LPC envelope
+    state.warpedLPCEnvelope.fill(0.0f);
+    for (int k = 0; k < numBins; k++) {
+        const float sourceBin = k / formantRatio;
+
+        const int k1 = (int)sourceBin;
+        const int k2 = k1 + 1;
+        const float frac = sourceBin - k1;
+
+        if (k1 >= 0 && k1 < numBins) {
+            state.warpedLPCEnvelope[k] = state.lpcEnvelope[k1] * (1.0f - frac);
+        }
+        if (k2 >= 0 && k2 < numBins) {
+            state.warpedLPCEnvelope[k] += state.lpcEnvelope[k2] * frac;
+        }
+    }
+
+    // Step 4: Remove the original envelope from the magnitude, apply the warped one
+    for (int k = 0; k < numBins; k++) {
+        if (state.lpcEnvelope[k] > 0.0001f) {
+            state.newMagnitude[k] *= state.warpedLPCEnvelope[k] / state.lpcEnvelope[k];
+        }
+    }
+}
+
+template <int FrameSize, int HopSize>
+void PitchShifterT<FrameSize, HopSize>::shiftFormantsSmoothed(State& state, float pitchRatio, float formantRatio) {
+    // Moving-average envelope of the analysis magnitude
+    constexpr int smoothWindow = std::max(5, FrameSize / 100);
+
+    for (int k = 0; k < numBins; k++) {
+        float sum = 0.0f;
+        int count = 0;
+        for (int j = std::max(0, k - smoothWindow); j <= std::min(numBins - 1, k + smoothWindow); j++) {
+            sum += state.magnitude[j];
+            count++;
+        }
+        state.envelope[k] = sum / count;
+    }
+
+    // Warp the envelope
+    state.warpedEnvelope.fill(0.0f);
+    for (int k = 0; k < numBins; k++) {
+        const float sourceK = k / formantRatio;
+        const int k1 = (int)sourceK;
+        const int k2 = k1 + 1;
+        const float frac = sourceK - k1;
+
+        if (k1 >= 0 && k1 < numBins) {
+            state.warpedEnvelope[k] = state.envelope[k1] * (1.0f - frac);
+        }
+        if (k2 >= 0 && k2 < numBins) {
+            state.warpedEnvelope[k] += state.envelope[k2] * frac;
+        }
+    }
+
+    // Apply warped envelope to magnitude
+    for (int k = 0; k < numBins; k++) {
+        const int origBin = (int)(k * pitchRatio);
+        if (origBin >= 0 && origBin < numBins) {
+            const float origEnv = state.envelope[origBin];
+            if (origEnv > 0.0001f && state.warpedEnvelope[k] > 0.0001f) {
+                state.newMagnitude[k] *= state.warpedEnvelope[k] / origEnv;
+            }
+        }
+    }
+}
+
+} // namespace blink
@@ -0,0 +1,314 @@
+#include "Resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+
+namespace blink {
+
+namespace {
+
+// Taps per phase when neither rate is decimated; scaled up when downsampling
+constexpr int baseTaps = 96;
+
+// Passband and stopband edges as fractions of the lower rate's Nyquist frequency
+constexpr double passbandEdge = 0.88;
+constexpr double stopbandEdge = 1.0;
+constexpr double stopbandAttenuationDb = 90.0;
+
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1.0e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// Written with independent partial sums so the compiler maps it onto vector lanes
+float dotProduct(const float* a, const float* b, int numTaps) {
+    float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+    for (int i = 0; i < numTaps; i += 4) {
+        sum0 += a[i] * b[i];
+        sum1 += a[i + 1] * b[i + 1];
+        sum2 += a[i + 2] * b[i + 2];
+        sum3 += a[i + 3] * b[i + 3];
+    }
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
+} // namespace
+
+struct Resampler::FilterTable {
+    int upFactor;    // L output samples ...
+    int downFactor;  // ... for every M input samples
+    int numTaps;     // Per phase, a multiple of 4
+    std::vector<float> coefficients;  // upFactor phases x numTaps, in input order
+};
+
+Resampler::Resampler()
+    : bufferFill(0), bufferStart(0), inputCount(0), nextOutput(0) {
+}
+
+Resampler::~Resampler() = default;
+
+void Resampler::reduceRatio(double inputRate, double outputRate, int& upFactor, int& downFactor) {
+    // Continued-fraction convergents of outputRate / inputRate, stopping before
+    // the numerator (the phase count) gets too large
+    const double ratio = outputRate / inputRate;
+    double remainder = ratio;
+    int64_t h0 = 0, h1 = 1, k0 = 1, k1 = 0;
+
+    upFactor = 1;
+    downFactor = 1;
+
+    for (int iteration = 0; iteration < 32; iteration++) {
+        const double whole = std::floor(remainder);
+        const int64_t h2 = (int64_t)whole * h1 + h0;
+        const int64_t k2 = (int64_t)whole * k1 + k0;
+
+        if (h2 > maxPhases || k2 > 1000000) {
+            break;
+        }
+
+        if (h2 >= 1) {
+            upFactor = (int)h2;
+            downFactor = (int)k2;
+        }
+        h0 = h1; h1 = h2;
+        k0 = k1; k1 = k2;
+
+        const double fraction = remainder - whole;
+        if (fraction < 1.0e-9 || std::abs((double)h2 / (double)k2 - ratio) < 1.0e-12 * ratio) {
+            break;
+        }
+        remainder = 1.0 / fraction;
+    }
+}
+
+std::shared_ptr<const Resampler::FilterTable> Resampler::buildTable(int upFactor, int downFactor) {
+    auto table = std::make_shared<FilterTable>();
+    table->upFactor = upFactor;
+    table->downFactor = downFactor;
+
+    // When downsampling the filter is longer in input samples, to keep the
+    // transition band the same width relative to the output rate
+    const double decimation = std::max(1.0, (double)downFactor / upFactor);
+    table->numTaps = ((int)std::ceil(baseTaps * decimation) + 3) & ~3;
+
+    const int numTaps = table->numTaps;
+    const double halfLength = numTaps / 2.0;
+    const double cutoff = 0.5 * (passbandEdge + stopbandEdge) / 2.0 / decimation; // Cycles per input sample
+    const double beta = 0.1102 * (stopbandAttenuationDb - 8.7);
+    const double windowNorm = besselI0(beta);
+    const double pi = 3.14159265358979323846;
+
+    table->coefficients.resize((size_t)upFactor * numTaps);
+
+    for (int phase = 0; phase < upFactor; phase++) {
+        float* coefficients = table->coefficients.data() + (size_t)phase * numTaps;
+        double sum = 0.0;
+
+        for (int tap = 0; tap < numTaps; tap++) {
+            // Distance from the output instant to this input sample
+            const double x = halfLength - 1.0 - tap + (double)phase / upFactor;
+            const double arg = 2.0 * cutoff * x;
+            const double sinc = (std::abs(arg) < 1.0e-12) ? 1.0 : std::sin(pi * arg) / (pi * arg);
+            const double position = x / halfLength;
+            const double window = (std::abs(position) < 1.0)
+                                ? besselI0(beta * std::sqrt(1.0 - position * position)) / windowNorm
+                                : 0.0;
+
+            const double value = 2.0 * cutoff * sinc * window;
+            coefficients[tap] = (float)value;
+            sum += value;
+        }
+
+        // Unity DC gain in every phase
+        if (sum != 0.0) {
+            for (int tap = 0; tap < numTaps; tap++) {
+                coefficients[tap] = (float)(coefficients[tap] / sum);
+            }
+        }
+    }
+
+    return table;
+}
+
+std::shared_ptr<const Resampler::FilterTable> Resampler::getTable(int upFactor, int downFactor) {
+    static std::mutex tablesLock;
+    static std::map<std::pair<int, int>, std::shared_ptr<const FilterTable>> tables;
+
+    std::lock_guard<std::mutex> guard(tablesLock);
+    auto& table = tables[{ upFactor, downFactor }];
+    if (table == nullptr) {
+        table = buildTable(upFactor, downFactor);
+    }
+    return table;
+}
+
+void Resampler::precomputeCommonTables() {
+    const double hostRates[] = { 44100.0, 48000.0, 88200.0, 96000.0 };
+    const double modelRates[] = { 16000.0, 32000.0, 40000.0, 44100.0, 48000.0 };
+
+    for (double hostRate : hostRates) {
+        for (double modelRate : modelRates) {
+            if (hostRate == modelRate) {
+                continue;
+            }
+
+            int up, down;
+            reduceRatio(hostRate, modelRate, up, down);
+            getTable(up, down);
+            reduceRatio(modelRate, hostRate, up, down);
+            getTable(up, down);
+        }
+    }
+}
+
+void Resampler::prepare(double inputRate, double outputRate, int maxInputBlock) {
+    int up, down;
+    reduceRatio(inputRate, outputRate, up, down);
+    table = (up == down) ? nullptr : getTable(up, down);
+
+    const int numTaps = (table != nullptr) ? table->numTaps : 0;
+    buffer.assign((size_t)numTaps + std::max(1, maxInputBlock), 0.0f);
+    reset();
+}
+
+void Resampler::reset() {
+    // Input before the stream started counts as silence
+    const int numTaps = (table != nullptr) ? table->numTaps : 0;
+    std::fill(buffer.begin(), buffer.end(), 0.0f);
+    bufferFill = numTaps;
+    bufferStart = -numTaps;
+    inputCount = 0;
+    nextOutput = 0;
+}
+
+bool Resampler::isPassThrough() const {
+    return table == nullptr;
+}
+
+int Resampler::getLookaheadSamples() const {
+    return (table != nullptr) ? table->numTaps / 2 : 0;
+}
+
+int Resampler::getMaxOutputSamples(int numInput) const {
+    if (table == nullptr) {
+        return numInput;
+    }
+    return (int)((int64_t)numInput * table->upFactor / table->downFactor) + 2;
+}
+
+int64_t Resampler::getAlignedOutputLength(int64_t numInput) const {
+    if (table == nullptr) {
+        return numInput;
+    }
+    return (numInput * table->upFactor + table->downFactor - 1) / table->downFactor;
+}
+
+int Resampler::produce(float* output, int maxOutput) {
+    const int up = table->upFactor;
+    const int down = table->downFactor;
+    const int numTaps = table->numTaps;
+    const int64_t delay = (int64_t)up * numTaps / 2;
+    const float* coefficients = table->coefficients.data();
+
+    int written = 0;
+    while (written < maxOutput) {
+        // Newest input sample this output needs, and the phase between it and the next
+        const int64_t position = nextOutput * down + delay;
+        const int64_t newest = position / up;
+        if (newest >= inputCount) {
+            break;
+        }
+
+        const int phase = (int)(position % up);
+        const float* samples = buffer.data() + (newest - numTaps + 1 - bufferStart);
+        output[written++] = dotProduct(coefficients + (size_t)phase * numTaps, samples, numTaps);
+        nextOutput++;
+    }
+
+    // Drop input no future output reaches back to
+    const int64_t oldestNeeded = (nextOutput * down + delay) / up - numTaps + 1;
+    const int discard = (int)std::min<int64_t>(bufferFill, std::max<int64_t>(0, oldestNeeded - bufferStart));
+    if (discard > 0) {
+        std::copy(buffer.begin() + discard, buffer.begin() + bufferFill, buffer.begin());
+        bufferFill -= discard;
+        bufferStart += discard;
+    }
+
+    return written;
+}
+
+int Resampler::process(const float* input, int numInput, float* output, int maxOutput) {
+    if (table == nullptr) {
+        const int count = std::min(numInput, maxOutput);
+        std::copy(input, input + count, output);
+        inputCount += count;
+        return count;
+    }
+
+    int consumed = 0;
+    int written = 0;
+
+    while (consumed < numInput) {
+        const int space = (int)buffer.size() - bufferFill;
+        const int count = std::min(numInput - consumed, space);
+
+        if (count == 0) {
+            break; // Output is full and the history can't be released
+        }
+
+        if (input != nullptr) {
+            std::copy(input + consumed, input + consumed + count, buffer.begin() + bufferFill);
+        } else {
+            std::fill(buffer.begin() + bufferFill, buffer.begin() + bufferFill + count, 0.0f);
+        }
+
+        bufferFill += count;
+        inputCount += count;
+        consumed += count;
+        written += produce(output + written, maxOutput - written);
+    }
+
+    return written;
+}
+
+int Resampler::flush(float* output, int maxOutput) {
+    if (table == nullptr) {
+        return 0;
+    }
+
+    // Only the outputs that line up with real input are wanted
+    const int64_t wanted = getAlignedOutputLength(inputCount) - nextOutput;
+    maxOutput = (int)std::min<int64_t>(maxOutput, std::max<int64_t>(0, wanted));
+
+    const int written = produce(output, maxOutput);
+    if (written >= maxOutput) {
+        return written;
+    }
+
+    // Silence (input == nullptr) completes the outstanding lookahead
+    return written + process(nullptr, getLookaheadSamples() + 1, output + written, maxOutput - written);
+}
+
+std::vector<float> Resampler::resample(const float* input, int numSamples,
+                                       double inputRate, double outputRate) {
+    Resampler resampler;
+    resampler.prepare(inputRate, outputRate, std::min(numSamples, 1 << 16));
+
+    std::vector<float> output((size_t)resampler.getAlignedOutputLength(numSamples), 0.0f);
+    const int size = (int)output.size();
+
+    int written = resampler.process(input, numSamples, output.data(), size);
+    written += resampler.flush(output.data() + written, size - written);
+    return output;
+}
+
+} // namespace blink
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace blink {
+
+/**
+ * Streaming polyphase sample-rate converter.
+ *
+ * The rate ratio is reduced to L/M (approximated when the exact fraction would
+ * need more than maxPhases phases) and converted with a Kaiser-windowed sinc
+ * split into L phases. Each output sample is one dot product between a phase's
+ * coefficients and the most recent input, both contiguous in memory.
+ *
+ * The passband runs to 88% of the lower rate's Nyquist frequency; images and
+ * aliases are attenuated by about 90 dB.
+ *
+ * Output is time-aligned with the input: output sample m sits at input time
+ * m * inRate / outRate. Producing it needs half a filter length of input
+ * beyond that point, so call flush() at the end of a stream to drain the tail.
+ *
+ * Filter tables are immutable and shared between instances for the same rate
+ * pair; precomputeCommonTables() builds the usual host/model pairs up front.
+ */
+class Resampler {
+public:
+    Resampler();
+    ~Resampler();
+
+    /**
+     * @param maxInputBlock Largest block process() is called with; buffers are
+     *                      sized for it so processing doesn't allocate
+     */
+    void prepare(double inputRate, double outputRate, int maxInputBlock);
+
+    /** Forget buffered input and restart the stream at time zero. */
+    void reset();
+
+    /**
+     * Convert a block.
+     * @param maxOutput Room in output; getMaxOutputSamples(numInput) is always enough
+     * @return Samples written
+     */
+    int process(const float* input, int numInput, float* output, int maxOutput);
+
+    /**
+     * Feed silence to drain the samples still waiting on lookahead.
+     * @return Samples written
+     */
+    int flush(float* output, int maxOutput);
+
+    /** Upper bound on the samples process() returns for numInput samples. */
+    int getMaxOutputSamples(int numInput) const;
+
+    /** Input samples needed past an output sample's time before it can be produced. */
+    int getLookaheadSamples() const;
+
+    /** Output length that lines up with numInput samples of input. */
+    int64_t getAlignedOutputLength(int64_t numInput) const;
+
+    /** True if the rates are equal and process() just copies. */
+    bool isPassThrough() const;
+
+    /**
+     * Resample a whole buffer; the result is getAlignedOutputLength(numSamples) long.
+     */
+    static std::vector<float> resample(const float* input, int numSamples,
+                                       double inputRate, double outputRate);
+
+    /** Build the filter tables for the common host and model rate pairs. */
+    static void precomputeCommonTables();
+
+    static constexpr int maxPhases = 1024;
+
+private:
+    struct FilterTable;
+
+    std::shared_ptr<const FilterTable> table;
+
+    // Input history; buffer[0] is input sample bufferStart
+    std::vector<float> buffer;
+    int bufferFill;
+    int64_t bufferStart;
+    int64_t inputCount;
+    int64_t nextOutput;
+
+    static std::shared_ptr<const FilterTable> getTable(int upFactor, int downFactor);
+    static std::shared_ptr<const FilterTable> buildTable(int upFactor, int downFactor);
+    static void reduceRatio(double inputRate, double outputRate, int& upFactor, int& downFactor);
+
+    int produce(float* output, int maxOutput);
+};
+
+} // namespace blink
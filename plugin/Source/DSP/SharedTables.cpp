@@ -0,0 +1,143 @@
+#include "SharedTables.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace blink {
+
+namespace {
+
+float hzToMel(float hz) {
+    return 2595.0f * log10f(1.0f + hz / 700.0f);
+}
+
+float melToHz(float mel) {
+    return 700.0f * (powf(10.0f, mel / 2595.0f) - 1.0f);
+}
+
+} // namespace
+
+struct SharedTables::Cache {
+    std::mutex lock;
+    std::map<Key, std::weak_ptr<const void>> tables;
+};
+
+SharedTables::Cache& SharedTables::getCache() {
+    static Cache cache;
+    return cache;
+}
+
+bool SharedTables::Key::operator<(const Key& other) const {
+    return std::tie(kind, size, param, sampleRate)
+         < std::tie(other.kind, other.size, other.param, other.sampleRate);
+}
+
+std::shared_ptr<const void> SharedTables::find(const Key& key,
+                                               const std::function<std::shared_ptr<const void>()>& build) {
+    Cache& cache = getCache();
+    std::lock_guard<std::mutex> guard(cache.lock);
+    auto& tables = cache.tables;
+
+    auto& entry = tables[key];
+    std::shared_ptr<const void> table = entry.lock();
+    if (table != nullptr) {
+        return table;
+    }
+
+    // Drop entries whose tables are gone
+    for (auto it = tables.begin(); it != tables.end();) {
+        it = (it->second.expired() && &it->second != &entry) ? tables.erase(it) : std::next(it);
+    }
+
+    table = build();
+    entry = table;
+    return table;
+}
+
+int SharedTables::getNumTables() {
+    Cache& cache = getCache();
+    std::lock_guard<std::mutex> guard(cache.lock);
+    const auto& tables = cache.tables;
+    return (int)std::count_if(tables.begin(), tables.end(),
+                              [](const auto& entry) { return !entry.second.expired(); });
+}
+
+std::shared_ptr<const std::vector<float>> SharedTables::getHannWindow(int size) {
+    auto table = find({ Kind::HannWindow, size, 0, 0.0 }, [size]() -> std::shared_ptr<const void> {
+        auto window = std::make_shared<std::vector<float>>((size_t)size);
+        for (int i = 0; i < size; i++) {
+            (*window)[i] = 0.5f * (1.0f - cosf(2.0f * juce::MathConstants<float>::pi * i / (size - 1)));
+        }
+        return window;
+    });
+    return std::static_pointer_cast<const std::vector<float>>(table);
+}
+
+std::shared_ptr<const juce::dsp::FFT> SharedTables::getFFT(int order) {
+    auto table = find({ Kind::FFT, order, 0, 0.0 }, [order]() -> std::shared_ptr<const void> {
+        return std::make_shared<juce::dsp::FFT>(order);
+    });
+    return std::static_pointer_cast<const juce::dsp::FFT>(table);
+}
+
+std::shared_ptr<const SharedTables::MelFilterbank> SharedTables::getMelFilterbank(int fftSize, int numBands,
+                                                                                  double sampleRate) {
+    auto table = find({ Kind::MelFilterbank, fftSize, numBands, sampleRate },
+                      [=]() -> std::shared_ptr<const void> {
+        return buildMelFilterbank(fftSize, numBands, sampleRate);
+    });
+    return std::static_pointer_cast<const MelFilterbank>(table);
+}
+
+std::shared_ptr<const SharedTables::MelFilterbank> SharedTables::buildMelFilterbank(int fftSize, int numBands,
+                                                                                    double sampleRate) {
+    auto filterbank = std::make_shared<MelFilterbank>();
+
+    // Frequency range: 0 Hz to Nyquist
+    const float minMel = hzToMel(0.0f);
+    const float maxMel = hzToMel((float)sampleRate / 2.0f);
+
+    // Mel-spaced band edges, as FFT bins
+    const int numBins = fftSize / 2 + 1;
+    std::vector<int> binPoints(numBands + 2);
+    for (int i = 0; i < numBands + 2; i++) {
+        const float hz = melToHz(minMel + (maxMel - minMel) * i / (numBands + 1));
+        binPoints[i] = std::min(numBins, (int)floorf((fftSize + 1) * hz / sampleRate));
+    }
+
+    // Triangular filters, keeping only the bins each one covers
+    const int alignment = 4; // floats per 16 bytes
+
+    for (int i = 0; i < numBands; i++) {
+        const int leftBin = binPoints[i];
+        const int centerBin = binPoints[i + 1];
+        const int rightBin = binPoints[i + 2];
+
+        MelFilterbank::Span span;
+        span.startBin = leftBin;
+        span.numBins = std::max(0, rightBin - leftBin);
+        span.offset = (int)filterbank->weights.size();
+        filterbank->spans.push_back(span);
+
+        // Left slope (rising)
+        for (int k = leftBin; k < centerBin; k++) {
+            filterbank->weights.push_back((float)(k - leftBin) / (centerBin - leftBin));
+        }
+
+        // Right slope (falling)
+        for (int k = centerBin; k < rightBin; k++) {
+            filterbank->weights.push_back((float)(rightBin - k) / (rightBin - centerBin));
+        }
+
+        // Pad so the next span starts aligned
+        while (filterbank->weights.size() % alignment != 0) {
+            filterbank->weights.push_back(0.0f);
+        }
+    }
+
+    return filterbank;
+}
+
+} // namespace blink
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace blink {
+
+/**
+ * Process-wide cache of immutable DSP tables: analysis windows, FFT plans and
+ * mel filterbanks.
+ *
+ * Tables are keyed by (type, size, sample rate) and shared read-only between
+ * every module and plugin instance that asks for the same one, so a session
+ * with dozens of instances holds one copy of each instead of dozens. The cache
+ * only keeps weak references: a table is freed when its last user lets go.
+ *
+ * Building a table allocates, so get them in constructors or prepare calls,
+ * never on the audio thread.
+ */
+class SharedTables {
+public:
+    /** Sparse triangular mel filterbank. */
+    struct MelFilterbank {
+        struct Span {
+            int startBin;
+            int numBins;
+            int offset;   // Index of the first weight in weights
+        };
+
+        // Each band's non-zero weights live in one contiguous buffer, with
+        // spans starting on 16-byte boundaries
+        std::vector<Span> spans;
+        std::vector<float> weights;
+    };
+
+    /** Symmetric Hann window, 0.5 * (1 - cos(2 pi n / (size - 1))). */
+    static std::shared_ptr<const std::vector<float>> getHannWindow(int size);
+
+    /**
+     * FFT plan for 2^order points. Its transforms are const and may run on
+     * several threads at once, each with its own buffer.
+     */
+    static std::shared_ptr<const juce::dsp::FFT> getFFT(int order);
+
+    /**
+     * Triangular filters evenly spaced on the mel scale from 0 Hz to Nyquist,
+     * over the fftSize / 2 + 1 bins of a real FFT.
+     */
+    static std::shared_ptr<const MelFilterbank> getMelFilterbank(int fftSize, int numBands, double sampleRate);
+
+    /** Tables currently alive, for diagnostics. */
+    static int getNumTables();
+
+private:
+    enum class Kind { HannWindow, FFT, MelFilterbank };
+
+    struct Key {
+        Kind kind;
+        int size;
+        int param;
+        double sampleRate;
+
+        bool operator<(const Key& other) const;
+    };
+
+    // Weak references to the live tables, under a lock
+    struct Cache;
+    static Cache& getCache();
+
+    // The cached table for key, built by build() if no one holds it now
+    static std::shared_ptr<const void> find(const Key& key,
+                                            const std::function<std::shared_ptr<const void>()>& build);
+
+    static std::shared_ptr<const MelFilterbank> buildMelFilterbank(int fftSize, int numBands, double sampleRate);
+};
+
+} // namespace blink
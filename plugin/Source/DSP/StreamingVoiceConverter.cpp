@@ -0,0 +1,424 @@
+#include "StreamingVoiceConverter.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace blink {
+
+StreamingVoiceConverter::StreamingVoiceConverter(ONNXInference& inference)
+    : inference(inference), sampleRate(44100.0), hopSize(512), fftSize(2048),
+      chunkSamples(0), windowFrames(0), windowSamples(0),
+      streamDelay(0), latencySamples(0), preparedModelRate(0),
+      pitchShiftSemitones(0.0f), lateChunks(0),
+      streamPosition(0), stagingStart(0), stagingFill(0), holdingOutput(false), outputIndex(0),
+      aiGain(0.0f), gainStep(0.0f), stopWorker(false),
+      modelRate(44100.0), crossfadeSamples(0), outputOffset(0),
+      pitchDetector(44100.0, 2048), f0Extractor(512), melSpec(2048, 512, 80),
+      modelCount(0), nextFrame(0), emittedEnd(0), ringHead(0),
+      outputPendingFill(0), nextInputStart(-1), nextOutputStart(0), hasFadeTail(false) {
+    Resampler::precomputeCommonTables();
+}
+
+StreamingVoiceConverter::~StreamingVoiceConverter() {
+    release();
+}
+
+void StreamingVoiceConverter::prepare(double newSampleRate, int maxBlockSize) {
+    release();
+
+    sampleRate = newSampleRate;
+
+    const int chunkFrames = std::max(1, settings.chunkFrames);
+    const int contextFrames = std::max(0, settings.contextFrames);
+    const int lookaheadFrames = std::max(1, settings.lookaheadFrames);
+
+    windowFrames = contextFrames + chunkFrames + lookaheadFrames;
+    windowSamples = (windowFrames - 1) * hopSize + fftSize;
+
+    // A run's converted span ends where its lookahead and last analysis frame begin
+    streamDelay = lookaheadFrames * hopSize + fftSize - hopSize;
+
+    // Chunks carry chunkFrames of the current model's frames, in host samples
+    preparedModelRate = inference.getModelSampleRate();
+    modelRate = (preparedModelRate > 0) ? (double)preparedModelRate : sampleRate;
+    chunkSamples = std::max(1, (int)std::lround(chunkFrames * hopSize * sampleRate / modelRate));
+    configureWorker();
+
+    // The chunk must fill, then the worker gets one chunk period to convert it; the
+    // host block adds a block of slack since output is read right after input is pushed
+    latencySamples = outputOffset + 2 * chunkSamples + maxBlockSize;
+
+    inputRing = std::make_unique<ChunkRing>(numRingChunks);
+    outputRing = std::make_unique<ChunkRing>(numRingChunks);
+    for (auto* ring : { inputRing.get(), outputRing.get() }) {
+        for (auto& chunk : ring->chunks) {
+            chunk.samples.assign((size_t)chunkSamples, 0.0f);
+        }
+    }
+
+    stagingChunk.assign((size_t)chunkSamples, 0.0f);
+    converted.assign((size_t)maxBlockSize, 0.0f);
+    convertedValid.assign((size_t)maxBlockSize, 0);
+
+    streamPosition = 0;
+    stagingStart = 0;
+    stagingFill = 0;
+    holdingOutput = false;
+    outputIndex = 0;
+    aiGain = 0.0f;
+    gainStep = 1.0f / (float)std::max(1.0, 0.005 * sampleRate); // 5 ms ramps
+    lateChunks.store(0);
+
+    history.assign((size_t)windowSamples, 0.0f);
+    modelOutput.assign((size_t)windowSamples, 0.0f);
+    nextInputStart = -1;
+
+    stopWorker.store(false);
+    worker = std::thread([this] { runWorker(); });
+}
+
+void StreamingVoiceConverter::release() {
+    if (worker.joinable()) {
+        stopWorker.store(true);
+        worker.join();
+    }
+
+    inputRing.reset();
+    outputRing.reset();
+}
+
+//==============================================================================
+// Audio thread
+
+void StreamingVoiceConverter::pushStagedChunk() {
+    int start1, size1, start2, size2;
+    inputRing->fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 > 0) {
+        Chunk& chunk = inputRing->chunks[(size_t)start1];
+        chunk.start = stagingStart;
+        std::copy(stagingChunk.begin(), stagingChunk.end(), chunk.samples.begin());
+        inputRing->fifo.finishedWrite(1);
+    }
+    // Otherwise the worker is far behind; it sees the gap and restarts its context
+
+    stagingFill = 0;
+}
+
+void StreamingVoiceConverter::readConverted(int64_t position, int numSamples) {
+    int i = 0;
+
+    while (i < numSamples) {
+        if (!holdingOutput) {
+            int start1, size1, start2, size2;
+            outputRing->fifo.prepareToRead(1, start1, size1, start2, size2);
+            if (size1 == 0) {
+                break; // Worker is late
+            }
+            outputIndex = start1;
+            holdingOutput = true;
+        }
+
+        const Chunk& chunk = outputRing->chunks[(size_t)outputIndex];
+        const int64_t wanted = position + i;
+
+        if (chunk.start + chunkSamples <= wanted) {
+            // Arrived after its time had passed
+            outputRing->fifo.finishedRead(1);
+            holdingOutput = false;
+            lateChunks.fetch_add(1);
+            continue;
+        }
+
+        if (chunk.start > wanted) {
+            // Gap before this chunk (dropped input or a failed run)
+            const int count = (int)std::min<int64_t>(numSamples - i, chunk.start - wanted);
+            std::fill(convertedValid.begin() + i, convertedValid.begin() + i + count, 0);
+            i += count;
+            continue;
+        }
+
+        const int offset = (int)(wanted - chunk.start);
+        const int count = std::min(numSamples - i, chunkSamples - offset);
+        std::copy(chunk.samples.begin() + offset, chunk.samples.begin() + offset + count,
+                  converted.begin() + i);
+        std::fill(convertedValid.begin() + i, convertedValid.begin() + i + count, 1);
+        i += count;
+
+        if (offset + count == chunkSamples) {
+            outputRing->fifo.finishedRead(1);
+            holdingOutput = false;
+        }
+    }
+
+    std::fill(convertedValid.begin() + i, convertedValid.begin() + numSamples, 0);
+}
+
+void StreamingVoiceConverter::process(const float* input, const float* fallback, float* output, int numSamples) {
+    if (inputRing == nullptr) {
+        std::copy(fallback, fallback + numSamples, output);
+        return;
+    }
+
+    numSamples = std::min(numSamples, (int)converted.size());
+
+    // Stage input into whole chunks
+    for (int i = 0; i < numSamples;) {
+        if (stagingFill == 0) {
+            stagingStart = streamPosition + i;
+        }
+
+        const int count = std::min(numSamples - i, chunkSamples - stagingFill);
+        std::copy(input + i, input + i + count, stagingChunk.begin() + stagingFill);
+        stagingFill += count;
+        i += count;
+
+        if (stagingFill == chunkSamples) {
+            pushStagedChunk();
+        }
+    }
+
+    readConverted(streamPosition - latencySamples, numSamples);
+
+    // Ramp between the conversion and the fallback wherever it comes and goes
+    for (int i = 0; i < numSamples; i++) {
+        const float target = convertedValid[(size_t)i] ? 1.0f : 0.0f;
+        aiGain = (aiGain < target) ? std::min(target, aiGain + gainStep)
+                                   : std::max(target, aiGain - gainStep);
+
+        const float ai = convertedValid[(size_t)i] ? converted[(size_t)i] : 0.0f;
+        output[i] = fallback[i] + aiGain * (ai - fallback[i]);
+    }
+
+    streamPosition += numSamples;
+}
+
+void StreamingVoiceConverter::advance(int numSamples) {
+    if (numSamples <= 0) {
+        return;
+    }
+
+    streamPosition += numSamples;
+
+    // A partial chunk can't be finished now; the worker will see the gap
+    stagingFill = 0;
+    aiGain = 0.0f;
+}
+
+//==============================================================================
+// Worker thread
+
+void StreamingVoiceConverter::configureWorker() {
+    const double ratio = sampleRate / modelRate;  // Host samples per model sample
+
+    pitchDetector.setSampleRate(modelRate);
+    pitchDetector.setBufferSize(fftSize);
+    f0Extractor.setSampleRate(modelRate);
+    melSpec.setSampleRate(modelRate);
+
+    inputResampler.prepare(sampleRate, modelRate, chunkSamples);
+    const int maxSpan = inputResampler.getMaxOutputSamples(chunkSamples);
+    outputResampler.prepare(modelRate, sampleRate, maxSpan + hopSize);
+    modelInput.assign((size_t)maxSpan, 0.0f);
+    spanOutput.assign((size_t)(maxSpan + hopSize), 0.0f);
+
+    const int numMelBands = melSpec.getNumMelBands();
+    f0Ring.assign((size_t)windowFrames, 0.0f);
+    melRing.assign((size_t)windowFrames * numMelBands, 0.0f);
+    f0Curve.assign((size_t)windowFrames, 0.0f);
+    melFrames.assign((size_t)windowFrames * numMelBands, 0.0f);
+
+    // Runs cover whole frames; when resampling, a chunk may complete one frame fewer
+    const bool resampling = !(inputResampler.isPassThrough() && outputResampler.isPassThrough());
+    const int chunkFrames = std::max(1, settings.chunkFrames);
+    const int minSpan = std::max(1, resampling ? chunkFrames - 1 : chunkFrames) * hopSize;
+
+    // The crossfade tail comes out of the lookahead, and must fit in the shortest span
+    crossfadeSamples = std::max(0, std::min({ std::max(0, settings.crossfadeFrames) * hopSize,
+                                              streamDelay, minSpan }));
+    fadeTail.assign((size_t)crossfadeSamples, 0.0f);
+
+    // Output sample m of a segment lines up with its input at m - streamDelay * ratio.
+    // Output is only whole once both resamplers have seen their lookahead and the
+    // stream has reached a frame boundary, so it is placed that much later again,
+    // keeping every chunk ready when its input chunk is
+    const int resamplingDelay = resampling
+        ? inputResampler.getLookaheadSamples()
+              + (int)std::ceil((outputResampler.getLookaheadSamples() + hopSize) * ratio) + 2
+        : 0;
+    outputOffset = (int)std::lround(streamDelay * ratio) + resamplingDelay;
+
+    outputPending.assign((size_t)(resamplingDelay + chunkSamples
+                                  + outputResampler.getMaxOutputSamples(maxSpan + hopSize)), 0.0f);
+}
+
+void StreamingVoiceConverter::restartSegment(int64_t start) {
+    inputResampler.reset();
+    outputResampler.reset();
+    hasFadeTail = false;
+
+    // The segment starts after a window of silence; its frames share one analysis
+    std::fill(history.begin(), history.end(), 0.0f);
+    const int numMelBands = melSpec.getNumMelBands();
+    f0Ring[0] = pitchDetector.getPitch(history.data(), fftSize);
+    melSpec.processFrames(history.data(), 1, melRing.data());
+    for (int frame = 1; frame < windowFrames; frame++) {
+        f0Ring[(size_t)frame] = f0Ring[0];
+        std::copy(melRing.begin(), melRing.begin() + numMelBands, melRing.begin() + (size_t)frame * numMelBands);
+    }
+    ringHead = 0;
+    modelCount = windowSamples;
+    nextFrame = windowFrames;
+    emittedEnd = windowSamples - streamDelay;
+
+    // Output before the resamplers' lookahead is padding
+    const int padding = outputOffset - (int)std::lround(streamDelay * sampleRate / modelRate);
+    std::fill(outputPending.begin(), outputPending.begin() + padding, 0.0f);
+    outputPendingFill = padding;
+
+    nextInputStart = start;
+    nextOutputStart = start - outputOffset;
+}
+
+void StreamingVoiceConverter::analyseNextFrame() {
+    const int numMelBands = melSpec.getNumMelBands();
+    const float* frame = history.data() + (nextFrame * hopSize - (modelCount - windowSamples));
+
+    f0Ring[(size_t)ringHead] = pitchDetector.getPitch(frame, fftSize);
+    melSpec.processFrames(frame, 1, melRing.data() + (size_t)ringHead * numMelBands);
+
+    ringHead = (ringHead + 1) % windowFrames;
+    nextFrame++;
+}
+
+void StreamingVoiceConverter::runWorker() {
+    const auto idleWait = std::chrono::microseconds(
+        std::max<int64_t>(500, (int64_t)(250000.0 * chunkSamples / sampleRate))); // A quarter chunk
+
+    while (!stopWorker.load()) {
+        int inStart1, inSize1, inStart2, inSize2;
+        inputRing->fifo.prepareToRead(1, inStart1, inSize1, inStart2, inSize2);
+
+        if (inSize1 == 0) {
+            std::this_thread::sleep_for(idleWait);
+            continue;
+        }
+
+        convertChunk(inputRing->chunks[(size_t)inStart1]);
+        inputRing->fifo.finishedRead(1);
+    }
+}
+
+void StreamingVoiceConverter::pushConverted() {
+    int sent = 0;
+
+    while (outputPendingFill - sent >= chunkSamples) {
+        int start1, size1, start2, size2;
+        outputRing->fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+        // A full ring means the audio thread isn't reading; the chunk is dropped
+        if (size1 > 0) {
+            Chunk& chunk = outputRing->chunks[(size_t)start1];
+            chunk.start = nextOutputStart;
+            std::copy(outputPending.begin() + sent, outputPending.begin() + sent + chunkSamples,
+                      chunk.samples.begin());
+            outputRing->fifo.finishedWrite(1);
+        }
+
+        sent += chunkSamples;
+        nextOutputStart += chunkSamples;
+    }
+
+    std::copy(outputPending.begin() + sent, outputPending.begin() + outputPendingFill, outputPending.begin());
+    outputPendingFill -= sent;
+}
+
+void StreamingVoiceConverter::convertChunk(const Chunk& input) {
+    // Chunk size and latency belong to the prepared rate; wait for prepare() to catch up
+    if (inference.getModelSampleRate() != preparedModelRate || !inference.isLoaded()) {
+        nextInputStart = -1;
+        return;
+    }
+
+    // After a gap the old context no longer belongs to this audio
+    if (input.start != nextInputStart) {
+        restartSegment(input.start);
+    }
+    nextInputStart = input.start + chunkSamples;
+
+    // Slide the stream on by however many model-rate samples this chunk gave
+    const int span = std::min(windowSamples - fftSize,
+                              inputResampler.process(input.samples.data(), chunkSamples,
+                                                     modelInput.data(), (int)modelInput.size()));
+    std::copy(history.begin() + span, history.end(), history.begin());
+    std::copy(modelInput.begin(), modelInput.begin() + span, history.end() - span);
+    modelCount += span;
+
+    // Only the frames this chunk completed are analysed; the rest are in the rings
+    const int64_t firstNewFrame = nextFrame;
+    while (nextFrame * hopSize + fftSize <= modelCount) {
+        analyseNextFrame();
+    }
+    if (nextFrame == firstNewFrame) {
+        return;
+    }
+
+    const int numMelBands = melSpec.getNumMelBands();
+    for (int frame = 0; frame < windowFrames; frame++) {
+        const int slot = (ringHead + frame) % windowFrames;
+        f0Curve[(size_t)frame] = f0Ring[(size_t)slot];
+        std::copy(melRing.begin() + (size_t)slot * numMelBands, melRing.begin() + (size_t)(slot + 1) * numMelBands,
+                  melFrames.begin() + (size_t)frame * numMelBands);
+    }
+    f0Extractor.smoothCurve(f0Curve.data(), windowFrames);
+
+    const float pitchRatio = std::pow(2.0f, pitchShiftSemitones.load() / 12.0f);
+    for (auto& f0 : f0Curve) {
+        if (f0 > 0.0f) {
+            f0 *= pitchRatio;
+        }
+    }
+
+    const int generated = inference.processOffline(f0Curve.data(), melFrames.data(),
+                                                   windowFrames, numMelBands,
+                                                   modelOutput.data(), windowSamples);
+    if (generated <= 0) {
+        nextInputStart = -1;
+        return;
+    }
+
+    // Model output lines up with the window's frames; keep what is new after the context
+    const int64_t windowStart = (nextFrame - windowFrames) * hopSize;
+    const int first = (int)(emittedEnd - windowStart);
+    const int runSpan = windowSamples - streamDelay - first;
+    auto sampleAt = [&](int index) {
+        return (index < generated) ? modelOutput[(size_t)index] : 0.0f;
+    };
+
+    for (int i = 0; i < runSpan; i++) {
+        spanOutput[(size_t)i] = sampleAt(first + i);
+    }
+    emittedEnd += runSpan;
+
+    // Overlap-add with the previous run's faded-out tail
+    if (hasFadeTail) {
+        for (int i = 0; i < crossfadeSamples; i++) {
+            const float fadeIn = (i + 0.5f) / crossfadeSamples;
+            spanOutput[(size_t)i] = fadeTail[(size_t)i] + spanOutput[(size_t)i] * fadeIn;
+        }
+    }
+
+    for (int i = 0; i < crossfadeSamples; i++) {
+        const float fadeOut = 1.0f - (i + 0.5f) / crossfadeSamples;
+        fadeTail[(size_t)i] = sampleAt(first + runSpan + i) * fadeOut;
+    }
+    hasFadeTail = true;
+
+    // Back to the host rate, then out in whole chunks
+    outputPendingFill += outputResampler.process(spanOutput.data(), runSpan,
+                                                 outputPending.data() + outputPendingFill,
+                                                 (int)outputPending.size() - outputPendingFill);
+    pushConverted();
+}
+
+} // namespace blink
@@ -0,0 +1,215 @@
+#pragma once
+
+#include "F0Extractor.h"
+#include "MelSpectrogram.h"
+#include "PitchDetector.h"
+#include "Resampler.h"
+#include "../AI/ONNXInference.h"
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace blink {
+
+/**
+ * Real-time AI voice conversion.
+ *
+ * The audio thread cuts its input into fixed chunks and hands them to a worker
+ * thread through a lock-free ring. The worker runs feature extraction and the
+ * model on each chunk plus some context and a fixed lookahead, crossfades it
+ * onto the previous one and returns it through a second ring, tagged with the
+ * stream position it belongs to.
+ *
+ * Features are computed once per frame as the frames complete and kept in
+ * rings spanning the model's window, so each run only analyses its new frames.
+ *
+ * The worker resamples its input to the model's native rate before feature
+ * extraction and the model's output back to the host rate, with the same
+ * Resampler the offline path and the dataset builder use. Chunk size and
+ * latency follow the model loaded at prepare(); while a model at another rate
+ * is loaded nothing is converted, until prepare() runs again.
+ *
+ * The audio thread never waits: output the worker hasn't delivered in time is
+ * replaced by the caller's fallback signal, with short ramps either side, and
+ * late chunks are dropped so the stream stays in sync.
+ */
+class StreamingVoiceConverter {
+public:
+    /**
+     * Chunk geometry, in feature frames of hopSize samples at the model rate.
+     */
+    struct Settings {
+        int chunkFrames = 4;      // Frames converted per model run
+        int contextFrames = 12;   // Past frames fed to the model for context
+        int lookaheadFrames = 2;  // Future frames fed to the model
+        int crossfadeFrames = 1;  // Overlap between consecutive chunks
+    };
+
+    explicit StreamingVoiceConverter(ONNXInference& inference);
+    ~StreamingVoiceConverter();
+
+    /**
+     * Allocate the rings and start the worker. Not real-time safe; call from
+     * prepareToPlay().
+     */
+    void prepare(double sampleRate, int maxBlockSize);
+
+    /**
+     * Stop the worker and free the rings.
+     */
+    void release();
+
+    void setSettings(const Settings& newSettings) { settings = newSettings; }
+    const Settings& getSettings() const { return settings; }
+
+    /**
+     * Transpose applied to the F0 curve before inference (semitones).
+     */
+    void setPitchShift(float semitones) { pitchShiftSemitones.store(semitones); }
+
+    /**
+     * Delay from an input sample to its converted output, including the time
+     * the worker is given to convert each chunk. Valid after prepare().
+     */
+    int getLatencySamples() const { return latencySamples; }
+
+    /**
+     * Model rate prepare() sized the stream for, 0 if the model gave none.
+     * When the loaded model's rate differs, call prepare() again.
+     */
+    int getModelRate() const { return preparedModelRate; }
+
+    /**
+     * Audio thread. Feed numSamples of input and get converted output delayed
+     * by getLatencySamples(); wherever no conversion is ready the output
+     * follows fallback instead.
+     * @param input Signal to convert
+     * @param fallback Signal to play when conversion is late (already delayed to match)
+     * @param output Converted signal (may alias fallback)
+     * @param numSamples At most the maxBlockSize given to prepare()
+     */
+    void process(const float* input, const float* fallback, float* output, int numSamples);
+
+    /**
+     * Audio thread. Let numSamples pass without converting them, e.g. while the
+     * AI blend is off, so the stream stays in step with the host. Does nothing
+     * for numSamples <= 0, so a partly staged chunk and the output ramp carry on.
+     */
+    void advance(int numSamples);
+
+    /**
+     * Chunks the worker delivered too late to be played, for diagnostics.
+     */
+    int getNumLateChunks() const { return lateChunks.load(); }
+
+private:
+    // One chunk of audio and the stream position of its first sample
+    struct Chunk {
+        int64_t start = 0;
+        std::vector<float> samples;
+    };
+
+    // Single-producer single-consumer ring of preallocated chunks
+    struct ChunkRing {
+        explicit ChunkRing(int numChunks) : fifo(numChunks), chunks((size_t)numChunks) {}
+
+        juce::AbstractFifo fifo;
+        std::vector<Chunk> chunks;
+    };
+
+    ONNXInference& inference;
+    Settings settings;
+
+    double sampleRate;
+    const int hopSize;   // Feature geometry, in model-rate samples
+    const int fftSize;
+
+    int chunkSamples;    // Host-rate samples per chunk
+    int windowFrames;
+    int windowSamples;
+    int streamDelay;     // Model output lags the newest model input by this much
+    int latencySamples;
+    int preparedModelRate;
+
+    std::atomic<float> pitchShiftSemitones;
+    std::atomic<int> lateChunks;
+
+    static constexpr int numRingChunks = 8;
+
+    std::unique_ptr<ChunkRing> inputRing;
+    std::unique_ptr<ChunkRing> outputRing;
+
+    // Audio thread state
+    int64_t streamPosition;  // Stream index of the next sample in or out
+    std::vector<float> stagingChunk;
+    int64_t stagingStart;
+    int stagingFill;
+    bool holdingOutput;      // An output chunk is open for reading
+    int outputIndex;
+    std::vector<float> converted;
+    std::vector<uint8_t> convertedValid;
+    float aiGain;
+    float gainStep;
+
+    // Worker state
+    std::thread worker;
+    std::atomic<bool> stopWorker;
+
+    double modelRate;            // Rate the features and the model run at
+    Resampler inputResampler;    // Host rate to model rate
+    Resampler outputResampler;   // Model rate back to host rate
+    int crossfadeSamples;
+    int outputOffset;            // Host output lags the segment's input by this much
+
+    PitchDetector pitchDetector;
+    F0Extractor f0Extractor;
+    MelSpectrogram melSpec;
+
+    std::vector<float> modelInput;     // One chunk at the model rate
+    std::vector<float> history;        // The last windowSamples of the model-rate stream
+    int64_t modelCount;                // Model-rate stream length, from the segment's silent preroll
+    int64_t nextFrame;                 // Frame (hopSize apart in the stream) to analyse next
+    int64_t emittedEnd;                // Stream position converted output has reached
+
+    // Features of the window's frames, oldest at ringHead
+    std::vector<float> f0Ring;
+    std::vector<float> melRing;
+    int ringHead;
+
+    std::vector<float> f0Curve;
+    std::vector<float> melFrames;
+    std::vector<float> modelOutput;
+    std::vector<float> spanOutput;     // One run's converted span, at the model rate
+    std::vector<float> fadeTail;       // Previous run's output past its span, faded out
+    std::vector<float> outputPending;  // Host-rate output not yet sent as a whole chunk
+    int outputPendingFill;
+    int64_t nextInputStart;            // -1 restarts the segment on the next chunk
+    int64_t nextOutputStart;
+    bool hasFadeTail;
+
+    void runWorker();
+
+    // Analysis and resamplers for the prepared model rate
+    void configureWorker();
+
+    // Start a segment at this input position: clear the context and the resamplers
+    void restartSegment(int64_t start);
+
+    // Features of frame nextFrame, into the oldest ring slot
+    void analyseNextFrame();
+
+    void convertChunk(const Chunk& input);
+
+    // Send every whole chunk of outputPending to the output ring
+    void pushConverted();
+
+    // Move the staged input chunk into the input ring (dropped if the ring is full)
+    void pushStagedChunk();
+
+    // Fill converted/convertedValid for numSamples starting at stream position
+    void readConverted(int64_t position, int numSamples);
+};
+
+} // namespace blink
@@ -0,0 +1,483 @@
+#include "WorldVocoder.h"
+#include <algorithm>
+#include <cmath>
+
+namespace blink {
+
+namespace {
+
+// CheapTrick's compensation lifter coefficient
+constexpr float q1 = -0.15f;
+
+constexpr float minPower = 1.0e-12f;
+constexpr float minAperiodicity = 0.001f;
+
+// Moving average of width bins (fractional) over a spectrum mirrored at DC and Nyquist
+void smoothSpectrum(const float* input, float* output, int numBins, float width,
+                    std::vector<double>& cumulative) {
+    const float halfWidth = std::max(0.5f, 0.5f * width);
+    const int margin = (int)std::ceil(halfWidth) + 2;
+    const int extended = numBins + 2 * margin;
+
+    auto valueAt = [&](int index) {
+        int bin = index - margin;
+        bin = std::abs(bin);
+        if (bin > numBins - 1) {
+            bin = 2 * (numBins - 1) - bin;
+        }
+        return input[juce::jlimit(0, numBins - 1, bin)];
+    };
+
+    cumulative.resize((size_t)extended + 1);
+    cumulative[0] = 0.0;
+    for (int i = 0; i < extended; i++) {
+        cumulative[(size_t)i + 1] = cumulative[(size_t)i] + valueAt(i);
+    }
+
+    // Area under the piecewise-constant spectrum up to a fractional bin position
+    auto areaTo = [&](float position) {
+        const double u = position + 0.5 + margin;
+        const int cell = juce::jlimit(0, extended - 1, (int)u);
+        return cumulative[(size_t)cell] + (u - cell) * valueAt(cell);
+    };
+
+    for (int k = 0; k < numBins; k++) {
+        output[k] = (float)((areaTo(k + halfWidth) - areaTo(k - halfWidth)) / (2.0 * halfWidth));
+    }
+}
+
+float interpolateBin(const float* values, int numBins, float position) {
+    position = juce::jlimit(0.0f, (float)(numBins - 1), position);
+    const int index = std::min((int)position, numBins - 2);
+    const float frac = position - index;
+    return values[index] + frac * (values[index + 1] - values[index]);
+}
+
+} // namespace
+
+WorldVocoder::WorldVocoder(int fftSize, int hopSize)
+    : fftSize(fftSize), hopSize(hopSize), numBins(fftSize / 2 + 1), sampleRate(44100.0),
+      f0Extractor(hopSize), fft(SharedTables::getFFT(calculateFFTOrder(fftSize))), noiseGenerator(1) {
+    envelopeFrame.resize((size_t)numBins);
+    aperiodicityFrame.resize((size_t)numBins);
+    magnitude.resize((size_t)numBins);
+    filterSpectrum.resize((size_t)fftSize * 2);
+    response.resize((size_t)fftSize * 2);
+    cepstrum.resize((size_t)fftSize * 2);
+}
+
+WorldVocoder::~WorldVocoder() = default;
+
+void WorldVocoder::setSampleRate(double newSampleRate) {
+    sampleRate = newSampleRate;
+    f0Extractor.setSampleRate(sampleRate);
+
+    // Analysers are rebuilt for the new rate on next use
+    analyzers.clear();
+}
+
+int WorldVocoder::calculateFFTOrder(int size) {
+    int order = 0;
+    int powerOfTwo = 1;
+    while (powerOfTwo < size) {
+        powerOfTwo *= 2;
+        order++;
+    }
+    return order;
+}
+
+//==============================================================================
+// Analysis
+
+WorldVocoder::FrameAnalyzer::FrameAnalyzer(double sampleRate, int fftSize)
+    : pitchDetector(sampleRate, fftSize), fft(SharedTables::getFFT(calculateFFTOrder(fftSize))) {
+    segment.resize((size_t)fftSize);
+    fftData.resize((size_t)fftSize * 2);
+    power.resize((size_t)fftSize / 2 + 1);
+    smoothed.resize((size_t)fftSize / 2 + 1);
+}
+
+void WorldVocoder::prepareAnalyzers() {
+    if (!analyzers.empty()) {
+        return;
+    }
+
+    // Threads are shared with the converters; analysers are this vocoder's own
+    if (analysisPool == nullptr) {
+        analysisPool = AnalysisPool::getShared();
+    }
+
+    const int numWorkers = analysisPool->getNumWorkers();
+    for (int i = 0; i < numWorkers; i++) {
+        analyzers.push_back(std::make_unique<FrameAnalyzer>(sampleRate, fftSize));
+    }
+}
+
+void WorldVocoder::forEachFrameRange(int numFrames,
+                                     const std::function<void(FrameAnalyzer&, int, int)>& fn) {
+    prepareAnalyzers();
+
+    const int numWorkers = (int)analyzers.size();
+    const int framesPerTask = std::max(minFramesPerTask, (numFrames + numWorkers - 1) / numWorkers);
+    const int numTasks = (numFrames + framesPerTask - 1) / framesPerTask;
+
+    // Each task owns a contiguous frame range and one analyser; outputs don't overlap
+    auto runTask = [&](int task) {
+        const int first = task * framesPerTask;
+        fn(*analyzers[(size_t)task], first, std::min(numFrames, first + framesPerTask));
+    };
+
+    analysisPool->run(numTasks, runTask);
+}
+
+bool WorldVocoder::analyse(const float* input, int numSamples, Analysis& analysis) {
+    if (input == nullptr || numSamples <= 0) {
+        return false;
+    }
+
+    const int numFrames = numSamples / hopSize + 1;
+    analysis.numFrames = numFrames;
+    analysis.numBins = numBins;
+    analysis.f0.assign((size_t)numFrames, 0.0f);
+    analysis.spectralEnvelope.assign((size_t)numFrames * numBins, 0.0f);
+    analysis.aperiodicity.assign((size_t)numFrames * numBins, 1.0f);
+
+    float* f0 = analysis.f0.data();
+    float* envelope = analysis.spectralEnvelope.data();
+    float* aperiodicity = analysis.aperiodicity.data();
+
+    // Pass 1: raw F0 per frame
+    forEachFrameRange(numFrames, [&](FrameAnalyzer& analyzer, int first, int last) {
+        for (int frame = first; frame < last; frame++) {
+            windowSegment(analyzer, input, numSamples, frame * hopSize, 0);
+            f0[frame] = analyzer.pitchDetector.getPitch(analyzer.segment.data(), fftSize);
+        }
+    });
+
+    // Smoothing depends on the previous frame, so it runs between the parallel passes
+    f0Extractor.smoothCurve(f0, numFrames);
+
+    // Pass 2: envelope and aperiodicity, which both need the final F0
+    forEachFrameRange(numFrames, [&](FrameAnalyzer& analyzer, int first, int last) {
+        for (int frame = first; frame < last; frame++) {
+            estimateEnvelope(analyzer, input, numSamples, frame, f0[frame],
+                             envelope + (size_t)frame * numBins);
+            estimateAperiodicity(analyzer, input, numSamples, frame, f0[frame],
+                                 aperiodicity + (size_t)frame * numBins);
+        }
+    });
+
+    return true;
+}
+
+void WorldVocoder::windowSegment(FrameAnalyzer& analyzer, const float* input, int numSamples,
+                                 int centre, int windowLength) const {
+    float* segment = analyzer.segment.data();
+    std::fill(segment, segment + fftSize, 0.0f);
+
+    // A length of 0 copies the raw fftSize samples around the centre
+    const bool raw = windowLength <= 0;
+    const int length = raw ? fftSize : std::min(windowLength, fftSize);
+    const int start = centre - length / 2;
+    const int offset = (fftSize - length) / 2;
+
+    double windowPower = 0.0;
+    for (int i = 0; i < length; i++) {
+        const float w = raw ? 1.0f
+                            : 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * (i + 0.5f) / length);
+        const int index = start + i;
+        const float sample = (index >= 0 && index < numSamples) ? input[index] : 0.0f;
+        segment[offset + i] = sample * w;
+        windowPower += (double)w * w;
+    }
+
+    // Unit-power window, so envelope levels don't depend on the pitch-adaptive length
+    if (!raw && windowPower > 0.0) {
+        juce::FloatVectorOperations::multiply(segment + offset, (float)(1.0 / std::sqrt(windowPower)), length);
+    }
+}
+
+void WorldVocoder::computePower(FrameAnalyzer& analyzer) const {
+    float* data = analyzer.fftData.data();
+    std::copy(analyzer.segment.begin(), analyzer.segment.end(), data);
+    std::fill(data + fftSize, data + fftSize * 2, 0.0f);
+    analyzer.fft->performRealOnlyForwardTransform(data);
+
+    for (int k = 0; k < numBins; k++) {
+        analyzer.power[(size_t)k] = data[2 * k] * data[2 * k] + data[2 * k + 1] * data[2 * k + 1];
+    }
+}
+
+void WorldVocoder::estimateEnvelope(FrameAnalyzer& analyzer, const float* input, int numSamples,
+                                    int frame, float f0, float* envelope) const {
+    if (f0 <= 0.0f) {
+        f0 = unvoicedF0;
+    }
+
+    // Pitch-adaptive window of three periods
+    const int windowLength = (int)std::lround(3.0 * sampleRate / f0);
+    windowSegment(analyzer, input, numSamples, frame * hopSize, windowLength);
+    computePower(analyzer);
+
+    float* power = analyzer.power.data();
+    float* smoothed = analyzer.smoothed.data();
+    const float binsPerF0 = (float)(f0 * fftSize / sampleRate);
+
+    // Fold the energy below F0 back up so DC doesn't dip
+    std::copy(power, power + numBins, smoothed);
+    for (int k = 0; k < numBins && k < binsPerF0; k++) {
+        power[k] += interpolateBin(smoothed, numBins, binsPerF0 - k);
+    }
+
+    // Linear smoothing across two thirds of a harmonic spacing
+    std::vector<double> cumulative;
+    smoothSpectrum(power, smoothed, numBins, binsPerF0 * 2.0f / 3.0f, cumulative);
+
+    // Cepstral liftering: sinc smoothing plus CheapTrick's compensation
+    float* data = analyzer.fftData.data();
+    for (int k = 0; k < numBins; k++) {
+        data[2 * k] = std::log(std::max(smoothed[k], minPower));
+        data[2 * k + 1] = 0.0f;
+    }
+    analyzer.fft->performRealOnlyInverseTransform(data);
+
+    for (int n = 1; n < fftSize; n++) {
+        const float quefrency = (float)(std::min(n, fftSize - n) / sampleRate);
+        const float x = juce::MathConstants<float>::pi * f0 * quefrency;
+        const float smoothing = std::sin(x) / x;
+        const float compensation = (1.0f - 2.0f * q1) + 2.0f * q1 * std::cos(2.0f * x);
+        data[n] *= smoothing * compensation;
+    }
+
+    std::fill(data + fftSize, data + fftSize * 2, 0.0f);
+    analyzer.fft->performRealOnlyForwardTransform(data);
+
+    for (int k = 0; k < numBins; k++) {
+        envelope[k] = std::exp(data[2 * k]);
+    }
+}
+
+void WorldVocoder::estimateAperiodicity(FrameAnalyzer& analyzer, const float* input, int numSamples,
+                                        int frame, float f0, float* aperiodicity) const {
+    if (f0 <= 0.0f) {
+        std::fill(aperiodicity, aperiodicity + numBins, 1.0f);
+        return;
+    }
+
+    // A longer window than the envelope's, so harmonics are resolved from the gaps between them
+    const int windowLength = (int)std::lround(6.0 * sampleRate / f0);
+    windowSegment(analyzer, input, numSamples, frame * hopSize, windowLength);
+    computePower(analyzer);
+
+    const float* power = analyzer.power.data();
+    const float binsPerF0 = (float)(f0 * fftSize / sampleRate);
+    const float halfBand = binsPerF0 * 0.25f;
+
+    auto bandMean = [&](float centre) {
+        const int low = juce::jlimit(0, numBins - 1, (int)std::lround(centre - halfBand));
+        const int high = juce::jlimit(low, numBins - 1, (int)std::lround(centre + halfBand));
+        double sum = 0.0;
+        for (int k = low; k <= high; k++) {
+            sum += power[k];
+        }
+        return sum / (high - low + 1);
+    };
+
+    // Noise-to-total power per harmonic: the valley after it against its peak
+    float previousCentre = 0.0f;
+    float previousValue = 1.0f;
+    int nextBin = 0;
+
+    for (int harmonic = 1; harmonic * binsPerF0 < numBins - 1; harmonic++) {
+        const float centre = harmonic * binsPerF0;
+        const double peak = bandMean(centre);
+        const double valley = bandMean(centre + 0.5f * binsPerF0);
+        const float value = (peak > 0.0) ? juce::jlimit(minAperiodicity, 1.0f, (float)(valley / peak)) : 1.0f;
+
+        if (harmonic == 1) {
+            previousValue = value;
+        }
+
+        for (; nextBin < numBins && nextBin <= centre; nextBin++) {
+            const float t = (centre > previousCentre) ? (nextBin - previousCentre) / (centre - previousCentre) : 1.0f;
+            aperiodicity[nextBin] = previousValue + juce::jlimit(0.0f, 1.0f, t) * (value - previousValue);
+        }
+
+        previousCentre = centre;
+        previousValue = value;
+    }
+
+    std::fill(aperiodicity + nextBin, aperiodicity + numBins, previousValue);
+}
+
+//==============================================================================
+// Modification
+
+void WorldVocoder::shiftPitch(Analysis& analysis, float semitones) {
+    if (semitones == 0.0f) {
+        return;
+    }
+
+    const float ratio = std::pow(2.0f, semitones / 12.0f);
+    for (auto& f0 : analysis.f0) {
+        if (f0 > 0.0f) {
+            f0 *= ratio;
+        }
+    }
+}
+
+void WorldVocoder::shiftFormants(Analysis& analysis, float semitones) {
+    if (semitones == 0.0f || analysis.numBins < 2) {
+        return;
+    }
+
+    const float ratio = std::pow(2.0f, semitones / 12.0f);
+    const int bins = analysis.numBins;
+    std::vector<float> source((size_t)bins);
+
+    for (auto* parameter : { &analysis.spectralEnvelope, &analysis.aperiodicity }) {
+        for (int frame = 0; frame < analysis.numFrames; frame++) {
+            float* values = parameter->data() + (size_t)frame * bins;
+            std::copy(values, values + bins, source.begin());
+
+            // Content at bin k / ratio moves up to bin k
+            for (int k = 0; k < bins; k++) {
+                values[k] = interpolateBin(source.data(), bins, k / ratio);
+            }
+        }
+    }
+}
+
+//==============================================================================
+// Synthesis
+
+void WorldVocoder::interpolateFrame(const Analysis& analysis, float position) {
+    const int frame0 = juce::jlimit(0, analysis.numFrames - 1, (int)position);
+    const int frame1 = std::min(frame0 + 1, analysis.numFrames - 1);
+    const float frac = juce::jlimit(0.0f, 1.0f, position - frame0);
+
+    const float* envelope0 = analysis.spectralEnvelope.data() + (size_t)frame0 * numBins;
+    const float* envelope1 = analysis.spectralEnvelope.data() + (size_t)frame1 * numBins;
+    const float* aperiodicity0 = analysis.aperiodicity.data() + (size_t)frame0 * numBins;
+    const float* aperiodicity1 = analysis.aperiodicity.data() + (size_t)frame1 * numBins;
+
+    juce::FloatVectorOperations::copy(envelopeFrame.data(), envelope0, numBins);
+    juce::FloatVectorOperations::multiply(envelopeFrame.data(), 1.0f - frac, numBins);
+    juce::FloatVectorOperations::addWithMultiply(envelopeFrame.data(), envelope1, frac, numBins);
+
+    juce::FloatVectorOperations::copy(aperiodicityFrame.data(), aperiodicity0, numBins);
+    juce::FloatVectorOperations::multiply(aperiodicityFrame.data(), 1.0f - frac, numBins);
+    juce::FloatVectorOperations::addWithMultiply(aperiodicityFrame.data(), aperiodicity1, frac, numBins);
+}
+
+void WorldVocoder::minimumPhaseSpectrum(const float* magnitudes, float* spectrum) {
+    float* data = cepstrum.data();
+
+    for (int k = 0; k < numBins; k++) {
+        data[2 * k] = std::log(std::max(magnitudes[k], 1.0e-10f));
+        data[2 * k + 1] = 0.0f;
+    }
+    fft->performRealOnlyInverseTransform(data);
+
+    // Fold the real cepstrum onto positive quefrencies
+    for (int n = 1; n < fftSize / 2; n++) {
+        data[n] *= 2.0f;
+    }
+    std::fill(data + fftSize / 2 + 1, data + fftSize * 2, 0.0f);
+    fft->performRealOnlyForwardTransform(data);
+
+    for (int k = 0; k < numBins; k++) {
+        const float gain = std::exp(data[2 * k]);
+        spectrum[2 * k] = gain * std::cos(data[2 * k + 1]);
+        spectrum[2 * k + 1] = gain * std::sin(data[2 * k + 1]);
+    }
+}
+
+void WorldVocoder::synthesise(const Analysis& analysis, float* output, int numSamples) {
+    std::fill(output, output + numSamples, 0.0f);
+
+    if (analysis.numFrames <= 0 || analysis.numBins != numBins) {
+        return;
+    }
+
+    // Same noise every render, so conversions are repeatable
+    noiseGenerator.setSeed(1);
+    const float noiseScale = std::sqrt(3.0f); // Unit variance from a uniform source
+
+    double time = 0.0;
+    while (time < numSamples) {
+        const float position = (float)(time / hopSize);
+        const int frame0 = juce::jlimit(0, analysis.numFrames - 1, (int)position);
+        const int frame1 = std::min(frame0 + 1, analysis.numFrames - 1);
+        const float frac = juce::jlimit(0.0f, 1.0f, position - frame0);
+
+        // Interpolate F0 inside voiced runs, take the nearer frame at voicing edges
+        const float f0a = analysis.f0[(size_t)frame0];
+        const float f0b = analysis.f0[(size_t)frame1];
+        const float f0 = (f0a > 0.0f && f0b > 0.0f) ? f0a + frac * (f0b - f0a)
+                                                    : (frac < 0.5f ? f0a : f0b);
+        const bool voiced = f0 > 0.0f;
+        const double period = sampleRate / (voiced ? f0 : unvoicedF0);
+
+        interpolateFrame(analysis, position);
+
+        const int pulse = (int)std::lround(time);
+        const int count = std::min(fftSize, numSamples - pulse);
+
+        if (count > 0) {
+            // Periodic part: one minimum-phase pulse carrying a period's worth of energy
+            if (voiced) {
+                for (int k = 0; k < numBins; k++) {
+                    magnitude[(size_t)k] = std::sqrt(envelopeFrame[(size_t)k]
+                                                     * (1.0f - aperiodicityFrame[(size_t)k]) * (float)period);
+                }
+                minimumPhaseSpectrum(magnitude.data(), response.data());
+                fft->performRealOnlyInverseTransform(response.data());
+                juce::FloatVectorOperations::add(output + pulse, response.data(), count);
+            }
+
+            // Aperiodic part: a period of white noise through the aperiodic envelope
+            for (int k = 0; k < numBins; k++) {
+                magnitude[(size_t)k] = std::sqrt(envelopeFrame[(size_t)k] * aperiodicityFrame[(size_t)k]);
+            }
+            minimumPhaseSpectrum(magnitude.data(), filterSpectrum.data());
+
+            const int noiseLength = std::min(fftSize, (int)std::ceil(period));
+            float* noise = response.data();
+            for (int i = 0; i < noiseLength; i++) {
+                noise[i] = (noiseGenerator.nextFloat() * 2.0f - 1.0f) * noiseScale;
+            }
+            std::fill(noise + noiseLength, noise + fftSize * 2, 0.0f);
+            fft->performRealOnlyForwardTransform(noise);
+
+            for (int k = 0; k < numBins; k++) {
+                const float re = noise[2 * k] * filterSpectrum[(size_t)(2 * k)]
+                               - noise[2 * k + 1] * filterSpectrum[(size_t)(2 * k + 1)];
+                const float im = noise[2 * k] * filterSpectrum[(size_t)(2 * k + 1)]
+                               + noise[2 * k + 1] * filterSpectrum[(size_t)(2 * k)];
+                noise[2 * k] = re;
+                noise[2 * k + 1] = im;
+            }
+            fft->performRealOnlyInverseTransform(noise);
+            juce::FloatVectorOperations::add(output + pulse, noise, count);
+        }
+
+        time += period;
+    }
+}
+
+bool WorldVocoder::convert(const float* input, float* output, int numSamples,
+                           float pitchSemitones, float formantSemitones) {
+    Analysis analysis;
+    if (!analyse(input, numSamples, analysis)) {
+        std::copy(input, input + numSamples, output);
+        return false;
+    }
+
+    shiftPitch(analysis, pitchSemitones);
+    shiftFormants(analysis, formantSemitones);
+    synthesise(analysis, output, numSamples);
+    return true;
+}
+
+} // namespace blink
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "AnalysisPool.h"
+#include "F0Extractor.h"
+#include "PitchDetector.h"
+#include "SharedTables.h"
+#include <juce_dsp/juce_dsp.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace blink {
+
+/**
+ * WORLD-style analysis/synthesis vocoder for offline pitch and formant changes.
+ *
+ * Analysis splits a take into three parameters per frame:
+ *   - F0, from the YIN pitch detector with F0Extractor's smoothing
+ *   - the spectral envelope, CheapTrick-style: a pitch-adaptive window, linear
+ *     smoothing across one harmonic spacing, then cepstral liftering
+ *   - aperiodicity, the noise-to-harmonic power ratio measured between
+ *     harmonics (in the spirit of D4C)
+ *
+ * Synthesis places one minimum-phase pulse per pitch period, shaped by the
+ * periodic part of the envelope, plus noise shaped by the aperiodic part.
+ * Pitch changes scale F0; formant changes warp the envelope's frequency axis.
+ *
+ * Frames are analysed in parallel on the process-wide AnalysisPool.
+ */
+class WorldVocoder {
+public:
+    /**
+     * Per-frame parameters. Frame i is centred on sample i * hopSize; spectra
+     * have fftSize / 2 + 1 bins per frame.
+     */
+    struct Analysis {
+        int numFrames = 0;
+        int numBins = 0;
+        std::vector<float> f0;                // Hz, 0 when unvoiced
+        std::vector<float> spectralEnvelope;  // Power, numFrames x numBins
+        std::vector<float> aperiodicity;      // 0 (periodic) to 1 (noise), numFrames x numBins
+    };
+
+    WorldVocoder(int fftSize = 2048, int hopSize = 256);
+    ~WorldVocoder();
+
+    void setSampleRate(double sampleRate);
+
+    int getFFTSize() const { return fftSize; }
+    int getHopSize() const { return hopSize; }
+
+    /**
+     * Analyse a whole take.
+     * @return false if the take is empty
+     */
+    bool analyse(const float* input, int numSamples, Analysis& analysis);
+
+    /**
+     * Resynthesise numSamples of audio from an analysis.
+     */
+    void synthesise(const Analysis& analysis, float* output, int numSamples);
+
+    /**
+     * Scale voiced F0 by a pitch shift in semitones.
+     */
+    static void shiftPitch(Analysis& analysis, float semitones);
+
+    /**
+     * Move the formants by a shift in semitones, warping each frame's envelope
+     * and aperiodicity along the frequency axis.
+     */
+    static void shiftFormants(Analysis& analysis, float semitones);
+
+    /**
+     * Analyse, shift and resynthesise in one go.
+     * @return false if the take could not be analysed (output is then a copy of the input)
+     */
+    bool convert(const float* input, float* output, int numSamples,
+                 float pitchSemitones, float formantSemitones);
+
+private:
+    // Scratch for one analysis thread
+    struct FrameAnalyzer {
+        FrameAnalyzer(double sampleRate, int fftSize);
+
+        PitchDetector pitchDetector;
+        std::shared_ptr<const juce::dsp::FFT> fft;
+        std::vector<float> segment;
+        std::vector<float> fftData;
+        std::vector<float> power;
+        std::vector<float> smoothed;
+    };
+
+    const int fftSize;
+    const int hopSize;
+    const int numBins;
+    double sampleRate;
+
+    F0Extractor f0Extractor;
+    std::shared_ptr<const juce::dsp::FFT> fft;
+
+    std::vector<std::unique_ptr<FrameAnalyzer>> analyzers;
+    std::shared_ptr<AnalysisPool> analysisPool;  // The process-wide pool, taken on first use
+
+    // Synthesis scratch
+    juce::Random noiseGenerator;
+    std::vector<float> envelopeFrame;
+    std::vector<float> aperiodicityFrame;
+    std::vector<float> magnitude;
+    std::vector<float> filterSpectrum;
+    std::vector<float> response;
+    std::vector<float> cepstrum;
+
+    static constexpr float unvoicedF0 = 500.0f;  // Pulse rate and smoothing width for unvoiced frames
+    static constexpr int minFramesPerTask = 16;
+
+    static int calculateFFTOrder(int size);
+
+    void prepareAnalyzers();
+
+    // Run fn(analyzer, firstFrame, lastFrame) over all frames, split across the pool
+    void forEachFrameRange(int numFrames, const std::function<void(FrameAnalyzer&, int, int)>& fn);
+
+    // Copy fftSize samples centred on a frame, zero-padded, with a Hann window of windowLength
+    void windowSegment(FrameAnalyzer& analyzer, const float* input, int numSamples,
+                       int centre, int windowLength) const;
+
+    // Power spectrum of analyzer.segment into analyzer.power
+    void computePower(FrameAnalyzer& analyzer) const;
+
+    void estimateEnvelope(FrameAnalyzer& analyzer, const float* input, int numSamples,
+                          int frame, float f0, float* envelope) const;
+
+    void estimateAperiodicity(FrameAnalyzer& analyzer, const float* input, int numSamples,
+                              int frame, float f0, float* aperiodicity) const;
+
+    // Interpolate a frame's envelope and aperiodicity at a fractional frame position
+    void interpolateFrame(const Analysis& analysis, float position);
+
+    // Interleaved minimum-phase spectrum (2 * fftSize floats) for numBins magnitudes
+    void minimumPhaseSpectrum(const float* magnitudes, float* spectrum);
+};
+
+} // namespace blink
@@ -21,16 +21,93 @@ VocalSuiteAudioProcessorEditor::VocalSuiteAudioProcessorEditor(VocalSuiteAudioPr
                 .withEventListener("loadModel", [this](const auto& object) { handleMessage(object); })
                 .withEventListener("startCapture", [this](const auto& object) { handleMessage(object); })
                 .withEventListener("stopCapture", [this](const auto& object) { handleMessage(object); })
-                .withEventListener("convertAudio", [this](const auto& object) { handleMessage(object); }))
+                .withEventListener("convertAudio", [this](const auto& object) { handleMessage(object); })
+                .withEventListener("convertFiles", [this](const auto& object) { handleMessage(object); })
+                .withEventListener("cancelRender", [this](const auto& object) { handleMessage(object); })
+                .withEventListener("listModels", [this](const auto& object) { handleMessage(object); }))
 {
     addAndMakeVisible(webView);
     
     webView.goToURL("http://localhost:5173");
     
     setSize(1000, 700);
+
+    startTimerHz(10);
+}
+
+VocalSuiteAudioProcessorEditor::~VocalSuiteAudioProcessorEditor() {
+    stopTimer();
 }
 
-VocalSuiteAudioProcessorEditor::~VocalSuiteAudioProcessorEditor() {}
+void VocalSuiteAudioProcessorEditor::timerCallback() {
+    static const char* const stateNames[] = { "queued", "running", "finished", "failed", "cancelled" };
+
+    for (const auto& status : audioProcessor.takeRenderUpdates()) {
+        auto* event = new juce::DynamicObject();
+        event->setProperty("id", status.id);
+        event->setProperty("name", juce::String(status.name));
+        event->setProperty("state", stateNames[(int) status.state]);
+        event->setProperty("progress", status.progress);
+        event->setProperty("message", juce::String(status.message));
+
+        webView.emitEventIfBrowserIsVisible("renderProgress", juce::var(event));
+    }
+
+    const int catalogGeneration = audioProcessor.getModelCatalog().getGeneration();
+    if (catalogGeneration != lastCatalogGeneration)
+        sendModelCatalog();
+
+    sendQualityStatus();
+}
+
+void VocalSuiteAudioProcessorEditor::sendQualityStatus() {
+    const auto& governor = audioProcessor.getQualityGovernor();
+    const int tier = governor.getTier();
+    const int loadPercent = juce::roundToInt(governor.getLoad() * 100.0f);
+    const int overruns = governor.getOverruns();
+
+    if (tier == lastQualityTier && loadPercent == lastLoadPercent && overruns == lastOverruns)
+        return;
+
+    lastQualityTier = tier;
+    lastLoadPercent = loadPercent;
+    lastOverruns = overruns;
+
+    auto* status = new juce::DynamicObject();
+    status->setProperty("tier", tier);
+    status->setProperty("tierName", juce::String(blink::QualityGovernor::getTierName(tier)));
+    status->setProperty("load", loadPercent / 100.0);
+    status->setProperty("overruns", overruns);
+
+    webView.emitEventIfBrowserIsVisible("qualityStatus", juce::var(status));
+}
+
+void VocalSuiteAudioProcessorEditor::sendModelCatalog() {
+    auto& catalog = audioProcessor.getModelCatalog();
+    lastCatalogGeneration = catalog.getGeneration();
+
+    juce::Array<juce::var> models;
+    for (const auto& info : catalog.getModels()) {
+        auto* model = new juce::DynamicObject();
+        model->setProperty("id", juce::String(info.id));
+        model->setProperty("file", juce::File(info.path).getFileName());
+        model->setProperty("format", juce::String(info.format));
+        model->setProperty("sampleRate", info.sampleRate);
+        model->setProperty("melBands", info.numMelBands);
+        model->setProperty("size", (juce::int64) info.sizeBytes);
+        model->setProperty("valid", info.valid);
+        model->setProperty("problem", juce::String(info.problem));
+
+        juce::Array<juce::var> variants;
+        for (const auto& variant : info.variants)
+            variants.add(juce::String(variant));
+        model->setProperty("variants", variants);
+
+        models.add(juce::var(model));
+    }
+
+    webView.emitEventIfBrowserIsVisible("modelCatalog", models);
+}
 
 void VocalSuiteAudioProcessorEditor::paint(juce::Graphics& g) {}
 
@@ -100,6 +177,59 @@ void VocalSuiteAudioProcessorEditor::handleMessage(const juce::var& message)
 
             audioProcessor.convertCapturedAudio(model.toStdString(), pitchShift, formantShift);
         }
+        else if (type == "convertFiles")
+        {
+            if (!obj->hasProperty("model"))
+                return;
+
+            const auto model = obj->getProperty("model").toString().toStdString();
+            const int pitchShift = obj->hasProperty("pitchShift") ? (int) obj->getProperty("pitchShift") : 0;
+            const float formantShift = obj->hasProperty("formantShift") ? (float) obj->getProperty("formantShift") : 0.0f;
+
+            juce::Array<juce::File> inputs;
+            if (auto* paths = obj->getProperty("paths").getArray())
+            {
+                for (const auto& path : *paths)
+                    if (juce::File::isAbsolutePath(path.toString()))
+                        inputs.add(juce::File(path.toString()));
+            }
+
+            if (!inputs.isEmpty())
+            {
+                audioProcessor.convertAudioFiles(inputs, model, pitchShift, formantShift);
+                return;
+            }
+
+            // The web view can't see file paths, so the files are picked natively
+            fileChooser = std::make_unique<juce::FileChooser>("Choose files or folders to convert",
+                                                              juce::File::getSpecialLocation(juce::File::userMusicDirectory),
+                                                              "*.wav;*.flac;*.aif;*.aiff");
+
+            const int flags = juce::FileBrowserComponent::openMode
+                            | juce::FileBrowserComponent::canSelectFiles
+                            | juce::FileBrowserComponent::canSelectDirectories
+                            | juce::FileBrowserComponent::canSelectMultipleItems;
+
+            fileChooser->launchAsync(flags, [this, model, pitchShift, formantShift](const juce::FileChooser& chooser)
+            {
+                const auto results = chooser.getResults();
+                if (!results.isEmpty())
+                    audioProcessor.convertAudioFiles(results, model, pitchShift, formantShift);
+            });
+        }
+        else if (type == "cancelRender")
+        {
+            if (!obj->hasProperty("jobId"))
+                return;
+
+            audioProcessor.cancelRender((int) obj->getProperty("jobId"));
+        }
+        else if (type == "listModels")
+        {
+            // Send what is indexed now; the timer sends the list again if the rescan changes it
+            audioProcessor.getModelCatalog().scanAsync();
+            sendModelCatalog();
+        }
     }
 }
 
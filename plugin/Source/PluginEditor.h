@@ -1,6 +1,6 @@
 #pragma once
 
-#include <JuceHeader.h>
+#include <juce_gui_extra/juce_gui_extra.h>
 #include "PluginProcessor.h"
 
 /**
@@ -8,7 +8,8 @@
  * This bridges the C++ Audio Processor parameters to the Web Frontend.
  */
 class VocalSuiteAudioProcessorEditor : public juce::AudioProcessorEditor,
-                                        public juce::WebBrowserComponent::ResourceProvider
+                                        public juce::WebBrowserComponent::ResourceProvider,
+                                        private juce::Timer
 {
 public:
     VocalSuiteAudioProcessorEditor(VocalSuiteAudioProcessor&);
@@ -23,8 +24,26 @@ public:
     std::optional<juce::WebBrowserComponent::Resource> getResource(const juce::String& url);
 
 private:
+    // Forwards render job progress to the UI as "renderProgress" events, the
+    // model list as a "modelCatalog" event and the real-time chain's load and
+    // quality tier as a "qualityStatus" event, each whenever it changes
+    void timerCallback() override;
+    void sendModelCatalog();
+    void sendQualityStatus();
+
     VocalSuiteAudioProcessor& audioProcessor;
     juce::WebBrowserComponent webView;
 
+    // Picks the inputs for a batch conversion
+    std::unique_ptr<juce::FileChooser> fileChooser;
+
+    // Catalog generation last sent to the UI
+    int lastCatalogGeneration = -1;
+
+    // Quality status last sent to the UI
+    int lastQualityTier = -1;
+    int lastLoadPercent = -1;
+    int lastOverruns = -1;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VocalSuiteAudioProcessorEditor)
 };
@@ -1,11 +1,233 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "Core/RealtimeSafety.h"
 
+#include <chrono>
 #include <cmath>
 #include <algorithm>
+#include <limits>
 
 #include <juce_audio_formats/juce_audio_formats.h>
 
+namespace {
+
+/**
+ * Reads any supported audio file folded to mono. WAV and AIFF are read through a
+ * memory-mapped reader, so a long take is paged in by the OS rather than
+ * streamed through a file buffer; other formats fall back to a streamed reader.
+ */
+bool readMonoAudio(const juce::File& file, juce::AudioBuffer<float>& buffer, double& sampleRate)
+{
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    if (auto* format = formats.findFormatForFileExtension(file.getFileExtension()))
+    {
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format->createMemoryMappedReader(file));
+        if (mapped != nullptr && mapped->mapEntireFile())
+            reader = std::move(mapped);
+    }
+
+    if (reader == nullptr)
+        reader.reset(formats.createReaderFor(file));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->lengthInSamples > std::numeric_limits<int>::max())
+    {
+        DBG("[SwindleVX] Cannot read " + file.getFullPathName());
+        return false;
+    }
+
+    const int numSamples = (int) reader->lengthInSamples;
+    const int numChannels = juce::jmax(1, (int) reader->numChannels);
+    sampleRate = reader->sampleRate;
+
+    juce::AudioBuffer<float> channels(numChannels, numSamples);
+    reader->read(&channels, 0, numSamples, 0, true, numChannels > 1);
+
+    buffer.setSize(1, numSamples);
+    buffer.copyFrom(0, 0, channels, 0, 0, numSamples);
+    for (int ch = 1; ch < numChannels; ++ch)
+        buffer.addFrom(0, 0, channels, ch, 0, numSamples);
+    buffer.applyGain(1.0f / (float) numChannels);
+    return true;
+}
+
+bool writeMonoWav(const juce::File& file, const juce::AudioBuffer<float>& buffer, double sampleRate)
+{
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::FileOutputStream> outStream(file.createOutputStream());
+    if (outStream == nullptr)
+        return false;
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(outStream.get(), sampleRate, 1, 24, {}, 0));
+    if (writer == nullptr)
+        return false;
+
+    outStream.release();
+    writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+    return true;
+}
+
+/** A file converted in-process, with its audio once read. */
+struct NativeTake
+{
+    juce::File inputFile;
+    juce::File outFile;
+    juce::AudioBuffer<float> input;
+    juce::AudioBuffer<float> output;
+    bool converted = false;
+};
+
+/**
+ * Converts takes in-process: audio in, OfflineVoiceProcessor (F0/mel -> ONNX,
+ * native pitch and formant shift), WAV out. The takes go through one
+ * processTakes call, so their chunks share batched inference runs; they must
+ * all be at sampleRate. Runs as a render job; the caller holds the converter's
+ * lock. Sets each take's converted flag once its file is written.
+ */
+bool convertNatively(blink::OfflineVoiceProcessor& converter,
+                     blink::RenderQueue::JobContext& context,
+                     std::vector<NativeTake>& takes, double sampleRate, const juce::File& modelFile,
+                     int pitchShift, float formantShift)
+{
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+
+    // Loading the model the converter already has is a no-op, so a batch pays for it once
+    converter.setSampleRate(sampleRate);
+    if (!converter.loadVoiceModel(modelFile.getFullPathName().toStdString()))
+    {
+        DBG("[SwindleVX] Native conversion: " + juce::String(converter.getStatusMessage()));
+        context.setMessage(converter.getStatusMessage());
+        return false;
+    }
+
+    // The UI sends formant shift as semitones / 100 (the Python backend's convention)
+    converter.setPitchShift((float) pitchShift);
+    converter.setFormantShift(formantShift * 100.0f);
+
+    std::vector<blink::OfflineVoiceProcessor::Take> jobs(takes.size());
+    for (size_t i = 0; i < takes.size(); ++i)
+    {
+        auto& take = takes[i];
+        take.output.setSize(1, take.input.getNumSamples());
+        jobs[i].input = take.input.getReadPointer(0);
+        jobs[i].output = take.output.getWritePointer(0);
+        jobs[i].numSamples = take.input.getNumSamples();
+    }
+
+    converter.setCancelCheck([&context] { return context.shouldCancel(); });
+    const bool converted = converter.processTakes(jobs, [&context](float progress) { context.setProgress(progress); });
+    converter.setCancelCheck(nullptr);
+
+    if (!converted)
+    {
+        DBG("[SwindleVX] Native conversion failed: " + juce::String(converter.getStatusMessage()));
+        context.setMessage(converter.getStatusMessage());
+    }
+
+    // Takes converted before a failed run are still written
+    bool allWritten = true;
+    for (size_t i = 0; i < takes.size(); ++i)
+    {
+        auto& take = takes[i];
+        take.converted = jobs[i].converted && writeMonoWav(take.outFile, take.output, sampleRate);
+        allWritten = allWritten && take.converted;
+
+        if (take.converted)
+            DBG("[SwindleVX] Converted file saved: " + take.outFile.getFullPathName());
+    }
+
+    DBG("[SwindleVX] Native conversion of " + juce::String((int) takes.size()) + " take(s): "
+        + juce::String(juce::Time::getMillisecondCounterHiRes() - startMs, 0) + " ms");
+    return allWritten;
+}
+
+/**
+ * Pitch and formant conversion without a neural model: audio in, WorldVocoder
+ * analysis, shift and resynthesis, WAV out. Runs as a render job.
+ */
+bool convertWithVocoder(std::mutex& lock, blink::WorldVocoder& vocoder,
+                        blink::RenderQueue::JobContext& context,
+                        const juce::File& inputFile, const juce::File& outFile,
+                        int pitchShift, float formantShift)
+{
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+
+    juce::AudioBuffer<float> input;
+    double sr = 44100.0;
+    if (!readMonoAudio(inputFile, input, sr))
+        return false;
+
+    const int numSamples = input.getNumSamples();
+    juce::AudioBuffer<float> output(1, numSamples);
+
+    {
+        const std::lock_guard<std::mutex> guard(lock);
+
+        vocoder.setSampleRate(sr);
+
+        blink::WorldVocoder::Analysis analysis;
+        if (!vocoder.analyse(input.getReadPointer(0), numSamples, analysis))
+        {
+            context.setMessage("Capture is empty");
+            return false;
+        }
+
+        // Analysis and synthesis take roughly the same time
+        context.setProgress(0.5f);
+        if (context.shouldCancel())
+            return false;
+
+        // Same units as the native path: formant arrives as semitones / 100
+        blink::WorldVocoder::shiftPitch(analysis, (float) pitchShift);
+        blink::WorldVocoder::shiftFormants(analysis, formantShift * 100.0f);
+        vocoder.synthesise(analysis, output.getWritePointer(0), numSamples);
+    }
+
+    if (!writeMonoWav(outFile, output, sr))
+        return false;
+
+    DBG("[SwindleVX] Vocoder conversion saved: " + outFile.getFullPathName()
+        + " (" + juce::String(juce::Time::getMillisecondCounterHiRes() - startMs, 0) + " ms)");
+    return true;
+}
+
+/**
+ * A model id from the UI: a full path, or a model id or file name in
+ * Documents/VocalSuitePro/Models. Models the catalog found unusable are
+ * rejected. Returns a nonexistent file if nothing usable matches.
+ */
+juce::File resolveModelFile(const blink::ModelCatalog& catalog, const std::string& modelId)
+{
+    if (juce::File::isAbsolutePath(modelId) && juce::File(modelId).existsAsFile())
+        return juce::File(modelId);
+
+    blink::ModelCatalog::ModelInfo info;
+    if (catalog.findModel(modelId, info))
+    {
+        if (!info.valid)
+        {
+            DBG("[SwindleVX] Model " + juce::String(modelId) + " can't be used: " + juce::String(info.problem));
+            return {};
+        }
+        return juce::File(info.path);
+    }
+
+    // Not indexed yet (e.g. the first scan is still running): probe by name
+    const juce::File modelsDir = catalog.getDirectory();
+
+    juce::File modelFile = modelsDir.getChildFile(modelId);
+    if (!modelFile.existsAsFile())
+        modelFile = modelsDir.getChildFile(modelId + ".onnx");
+    if (!modelFile.existsAsFile())
+        modelFile = modelsDir.getChildFile(modelId + ".pth");
+
+    return modelFile;
+}
+
+} // namespace
+
 VocalSuiteAudioProcessor::VocalSuiteAudioProcessor()
     : AudioProcessor(BusesProperties().withInput("Input", juce::AudioChannelSet::mono(), true)
                                      .withOutput("Output", juce::AudioChannelSet::mono(), true)),
@@ -27,10 +249,23 @@ VocalSuiteAudioProcessor::VocalSuiteAudioProcessor()
     keyParam = parameters.getRawParameterValue("key");
     scaleParam = parameters.getRawParameterValue("scale");
 
+    // Live conversion is interactive: it goes ahead of offline renders for the shared runtime
+    aiProcessor.setPriority(blink::InferenceRuntime::Priority::Interactive);
+
+    renderQueue.setStatusCallback([this](const blink::RenderQueue::JobStatus& status)
+    {
+        const std::lock_guard<std::mutex> guard(renderUpdatesLock);
+        renderUpdates[status.id] = status;
+    });
+
     resetPitchShiftState();
 }
 
-VocalSuiteAudioProcessor::~VocalSuiteAudioProcessor() {}
+VocalSuiteAudioProcessor::~VocalSuiteAudioProcessor() {
+    // Stop renders before anything they use goes away
+    renderQueue.shutdown();
+    cancelPendingUpdate();
+}
 
 juce::AudioProcessorValueTreeState::ParameterLayout VocalSuiteAudioProcessor::createParameterLayout() {
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
@@ -82,41 +317,112 @@ void VocalSuiteAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBl
     pitchFrame.assign(pitchShiftFrameSize, 0.0f);
     pitchFrameOut.assign(pitchShiftFrameSize, 0.0f);
 
-    pitchOlaWindow.resize(pitchShiftFrameSize);
-    for (int n = 0; n < pitchShiftFrameSize; n++) {
-        pitchOlaWindow[n] = 0.5f * (1.0f - std::cos(2.0f * (float)M_PI * (float)n / (float)(pitchShiftFrameSize - 1)));
-    }
+    // Same Hann window as the shifter's analysis, shared across instances
+    pitchOlaWindow = blink::SharedTables::getHannWindow(pitchShiftFrameSize);
 
     pitchDetectFrame.assign(pitchShiftFrameSize, 0.0f);
 
-    // Allocate working buffers
-    workingBuffer.resize(samplesPerBlock * 4); // Extra space for overlap-add
-    aiOutputBuffer.resize(samplesPerBlock);
+    qualityGovernor.prepare(sampleRate);
+    applyQualityTier(blink::QualityGovernor::FullQuality);
+
+    idle = false;
+    quietSamples = 0;
+    idleFadeSamples = std::min(pitchShiftFrameSize - pitchShiftHopSize, (int) (0.005 * sampleRate));
+
+    // The AI path is only built for instances with a model; the rest never pay for it
+    streamingActive.store(false);
+    aiPathPrepared = false;
+    if (aiProcessor.isLoaded())
+        prepareAIPath();
 
-    // Capture up to 2 minutes of mono audio by default
-    const int captureMaxSeconds = 120;
-    const int captureMaxSamples = (int) (sampleRate * (double) captureMaxSeconds);
-    captureBuffer.assign((size_t) captureMaxSamples, 0.0f);
-    captureWritePos = 0;
-    captureSamplesRecorded = 0;
-    isCapturing.store(false);
+    // A take in progress was recorded at the old rate; startCapture allocates afresh
+    {
+        const juce::SpinLock::ScopedLockType guard(captureLock);
+        isCapturing.store(false);
+        if (captureBuffer.size() != (size_t) (sampleRate * (double) captureMaxSeconds))
+            std::vector<float>().swap(captureBuffer);
+        captureWritePos = 0;
+        captureSamplesRecorded = 0;
+    }
 
-    setLatencySamples(pitchShiftFrameSize - pitchShiftHopSize);
+    updateLatency();
+}
+
+void VocalSuiteAudioProcessor::prepareAIPath() {
+    if (maxBlockSize <= 0)
+        return;
+
+    const juce::SpinLock::ScopedLockType guard(aiPathLock);
+
+    if (streamingConverter == nullptr)
+        streamingConverter = std::make_unique<blink::StreamingVoiceConverter>(aiProcessor);
+
+    aiOutputBuffer.assign((size_t) maxBlockSize, 0.0f);
+    aiInputBuffer.assign((size_t) maxBlockSize, 0.0f);
+
+    // Real-time AI path; the processed signal waits for the conversion so the blend lines up
+    streamingConverter->prepare(currentSampleRate, maxBlockSize);
+    dryDelaySamples = std::max(0, streamingConverter->getLatencySamples() - pitchShiftFrameSize);
+    dryDelayLine.assign((size_t) std::max(1, dryDelaySamples), 0.0f);
+    dryDelayPos = 0;
+
+    aiPathPrepared = true;
 }
 
 void VocalSuiteAudioProcessor::releaseResources() {
-    workingBuffer.clear();
+    streamingActive.store(false);
+    aiPathPrepared = false;
+    if (streamingConverter != nullptr)
+        streamingConverter->release();
+
     aiOutputBuffer.clear();
+    aiInputBuffer.clear();
+    dryDelayLine.clear();
 
     pitchInRing.clear();
     pitchOlaRing.clear();
     pitchOlaGainRing.clear();
     pitchFrame.clear();
     pitchFrameOut.clear();
-    pitchOlaWindow.clear();
+    pitchOlaWindow.reset();
     pitchDetectFrame.clear();
 }
 
+void VocalSuiteAudioProcessor::updateLatency() {
+    const bool active = aiProcessor.isLoaded() && aiPathPrepared;
+    streamingActive.store(active);
+
+    // The pitch OLA ring delays by one full frame, whatever hop the governor picks
+    const int latency = pitchShiftFrameSize + (active ? dryDelaySamples : 0);
+    setLatencySamples(latency);
+
+    // Going idle waits out the OLA frame, the delay lines and 50 ms of filter ring
+    idleHoldSamples.store(latency + pitchShiftFrameSize + (int) (0.05 * currentSampleRate));
+}
+
+void VocalSuiteAudioProcessor::handleAsyncUpdate() {
+    // First model since prepareToPlay, or one at another rate: the AI path's chunk
+    // size and latency follow the model rate, so it is rebuilt and the latency re-reported
+    if (aiProcessor.isLoaded()
+        && (!aiPathPrepared || streamingConverter->getModelRate() != aiProcessor.getModelSampleRate()))
+        prepareAIPath();
+
+    updateLatency();
+}
+
+void VocalSuiteAudioProcessor::applyQualityTier(int tier) {
+    using Governor = blink::QualityGovernor;
+
+    pitchShifter.setUseLPCFormants(tier < Governor::EnvelopeFormants);
+    pitchDetector.setDecimation(tier >= Governor::DecimatedDetection ? 2 : 1);
+
+    // The OLA below normalises by the accumulated window, so any hop sums to unity
+    pitchHopSize = (tier >= Governor::ReducedOverlap) ? 2 * pitchShiftHopSize : pitchShiftHopSize;
+    pitchShifter.setHopSize(pitchHopSize);
+
+    appliedQualityTier = tier;
+}
+
 void VocalSuiteAudioProcessor::resetPitchShiftState() {
     pitchRingPos = 0;
     pitchSamplesFilled = 0;
@@ -125,29 +431,61 @@ void VocalSuiteAudioProcessor::resetPitchShiftState() {
 
 void VocalSuiteAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) {
     juce::ScopedNoDenormals noDenormals;
+    blink::RealtimeSafety::ScopedAudioThread audioThreadScope; // No-op unless VOCALSUITE_RT_SAFETY_CHECKS
     
     auto* channelData = buffer.getWritePointer(0);
     int numSamples = buffer.getNumSamples();
 
+    // Every block, idle ones included, counts towards the governor's load
+    blink::QualityGovernor::ScopedMeasurement loadMeasurement(qualityGovernor, numSamples);
+
     // Capture input (mono) if armed
-    if (isCapturing.load() && !captureBuffer.empty())
     {
-        const int capSize = (int) captureBuffer.size();
-        int remaining = capSize - captureWritePos;
-        int toCopy = std::min(numSamples, remaining);
+        const juce::SpinLock::ScopedTryLockType captureGuard(captureLock);
+        if (captureGuard.isLocked() && isCapturing.load() && !captureBuffer.empty())
+        {
+            const int capSize = (int) captureBuffer.size();
+            int remaining = capSize - captureWritePos;
+            int toCopy = std::min(numSamples, remaining);
+
+            if (toCopy > 0)
+            {
+                std::copy(channelData, channelData + toCopy, captureBuffer.begin() + captureWritePos);
+                captureWritePos += toCopy;
+                captureSamplesRecorded = std::min(capSize, captureSamplesRecorded + toCopy);
+            }
+
+            if (captureWritePos >= capSize)
+                isCapturing.store(false);
+        }
+    }
+
+    // Idle: a silent track costs a peak scan and a clear
+    const auto inputRange = juce::FloatVectorOperations::findMinAndMax(channelData, numSamples);
+    const float inputPeak = std::max(-inputRange.getStart(), inputRange.getEnd());
+    bool resuming = false;
 
-        if (toCopy > 0)
+    if (idle)
+    {
+        if (inputPeak < idleOpenLevel)
         {
-            std::copy(channelData, channelData + toCopy, captureBuffer.begin() + captureWritePos);
-            captureWritePos += toCopy;
-            captureSamplesRecorded = std::min(capSize, captureSamplesRecorded + toCopy);
+            buffer.clear();
+            currentPitch = 0.0f;
+            return;
         }
 
-        if (captureWritePos >= capSize)
-            isCapturing.store(false);
+        idle = false;
+        resuming = true;
+        quietSamples = 0;
     }
 
-    const int aiProcessSamples = std::min(numSamples, (int) aiOutputBuffer.size());
+    quietSamples = (inputPeak < idleCloseLevel) ? quietSamples + numSamples : 0;
+
+    // The AI path converts the unprocessed input; it sits out blocks while it is rebuilt
+    const juce::SpinLock::ScopedTryLockType aiPathGuard(aiPathLock);
+    const bool aiActive = aiPathGuard.isLocked() && streamingActive.load();
+    const int aiProcessSamples = aiActive ? std::min(numSamples, (int) aiInputBuffer.size()) : 0;
+    std::copy(channelData, channelData + aiProcessSamples, aiInputBuffer.begin());
     
     float correction = (correctionAmount != nullptr) ? correctionAmount->load() : 0.5f;
     float speed = (correctionSpeed != nullptr) ? correctionSpeed->load() : 0.2f;
@@ -174,6 +512,7 @@ void VocalSuiteAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
         detectedPitch = pitchDetector.getPitch(pitchDetectFrame.data(), pitchShiftFrameSize);
     }
     currentPitch = detectedPitch; // Store for UI visualization
+    pitchShifter.setVoicingConfidence(pitchDetector.getVoicingConfidence());
     
     // 2. PITCH CORRECTION
     float totalPitchRatio = 1.0f;
@@ -203,6 +542,12 @@ void VocalSuiteAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
     totalPitchRatio = juce::jlimit(0.25f, 4.0f, totalPitchRatio);
     formantRatio = juce::jlimit(0.25f, 4.0f, formantRatio);
 
+    // Quality changes land between frames, so the overlap-add crossfades them;
+    // with the shifter off there are no frames in flight
+    const int qualityTier = qualityGovernor.getTier();
+    if (!pitchShiftEnabled && qualityTier != appliedQualityTier)
+        applyQualityTier(qualityTier);
+
     if (pitchShiftEnabled && !pitchInRing.empty() && !pitchOlaRing.empty()) {
         for (int i = 0; i < numSamples; i++) {
             const float inSample = channelData[i];
@@ -224,7 +569,7 @@ void VocalSuiteAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
             pitchSamplesFilled = std::min(pitchShiftFrameSize, pitchSamplesFilled + 1);
             pitchSamplesSinceProcess++;
 
-            if (pitchSamplesFilled == pitchShiftFrameSize && pitchSamplesSinceProcess >= pitchShiftHopSize) {
+            if (pitchSamplesFilled == pitchShiftFrameSize && pitchSamplesSinceProcess >= pitchHopSize) {
                 pitchSamplesSinceProcess = 0;
 
                 const int start = pitchRingPos;
@@ -234,15 +579,21 @@ void VocalSuiteAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
                 if (start > 0)
                     std::copy(pitchInRing.begin(), pitchInRing.begin() + start, pitchFrame.begin() + len1);
 
-                pitchShifter.process(pitchFrame.data(), pitchFrameOut.data(), totalPitchRatio, formantRatio);
+                pitchShifter.processFrame(pitchFrame.data(), pitchFrameOut.data(), totalPitchRatio, formantRatio);
 
+                // The frame comes back windowed by hann^2 * windowNorm; accumulating
+                // that same weight keeps the sum at unity across hop changes
+                const float windowNorm = pitchShifter.getWindowNorm();
                 for (int n = 0; n < pitchShiftFrameSize; n++) {
                     const int idx = (start + n) % pitchShiftFrameSize;
-                    const float w = pitchOlaWindow.empty() ? 1.0f : pitchOlaWindow[n];
-                    pitchOlaRing[idx] += pitchFrameOut[n] * w;
+                    const float w = (pitchOlaWindow == nullptr) ? 1.0f : (*pitchOlaWindow)[n];
+                    pitchOlaRing[idx] += pitchFrameOut[n];
                     if (!pitchOlaGainRing.empty())
-                        pitchOlaGainRing[idx] += w;
+                        pitchOlaGainRing[idx] += w * w * windowNorm;
                 }
+
+                if (qualityTier != appliedQualityTier)
+                    applyQualityTier(qualityTier);
             }
         }
     }
@@ -251,14 +602,51 @@ void VocalSuiteAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
     float resonanceFreq = 2500.0f; // Default resonance frequency (can be made adjustable)
     voiceCharacter.process(channelData, numSamples, breath, resonance, resonanceFreq);
     
-    // AI voice conversion is now offline-only (use OfflineVoiceProcessor)
-    // Real-time AI processing would require too much latency
-    // For now, skip AI processing in real-time mode
+    // 4. AI VOICE CONVERSION (streamed through a worker thread, blended with the processed signal)
+    if (aiActive) {
+        if (dryDelaySamples > 0) {
+            for (int i = 0; i < numSamples; i++) {
+                const float delayed = dryDelayLine[dryDelayPos];
+                dryDelayLine[dryDelayPos] = channelData[i];
+                channelData[i] = delayed;
+                if (++dryDelayPos >= dryDelaySamples)
+                    dryDelayPos = 0;
+            }
+        }
+
+        if (blend > 0.001f) {
+            streamingConverter->setPitchShift(pitchSemitones);
+
+            // Falls back to the processed signal wherever the worker hasn't delivered
+            streamingConverter->process(aiInputBuffer.data(), channelData, aiOutputBuffer.data(), aiProcessSamples);
+            for (int i = 0; i < aiProcessSamples; i++) {
+                channelData[i] += blend * (aiOutputBuffer[i] - channelData[i]);
+            }
+            streamingConverter->advance(numSamples - aiProcessSamples);
+        } else {
+            streamingConverter->advance(numSamples);
+        }
+    }
     
+
     // 5. SOFT CLIPPING (prevent harsh clipping)
     for (int i = 0; i < numSamples; i++) {
         channelData[i] = std::tanh(channelData[i]);
     }
+
+    // Ramp breath noise and filter residue in and out of idle. With the shifter
+    // running, the fades end before delayed signal arrives; otherwise they only
+    // touch the first 5 ms of an onset that has just crossed -70 dBFS
+    const int fadeSamples = std::min(numSamples, idleFadeSamples);
+    if (resuming && fadeSamples > 0)
+        buffer.applyGainRamp(0, 0, fadeSamples, 0.0f, 1.0f);
+
+    if (quietSamples > 0 && quietSamples >= idleHoldSamples.load())
+    {
+        if (fadeSamples > 0)
+            buffer.applyGainRamp(0, numSamples - fadeSamples, fadeSamples, 1.0f, 0.0f);
+        idle = true;
+    }
 }
 
 bool VocalSuiteAudioProcessor::hasEditor() const {
@@ -290,14 +678,26 @@ void VocalSuiteAudioProcessor::loadVoiceModel(const std::string& modelId, const
             return;
         }
         
-        juce::File modelsDir = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
-            .getChildFile("VocalSuitePro")
-            .getChildFile("Models");
+        const juce::File modelFile = resolveModelFile(*modelCatalog, modelId);
         
-        juce::File modelFile = modelsDir.getChildFile(modelId + ".onnx");
+        // Only ONNX models run live; .pth models are for offline conversion
+        if (modelFile.existsAsFile() && !modelFile.hasFileExtension("onnx")) {
+            return;
+        }
         
+        // Session creation takes seconds on large models; keep it off the message thread
         if (modelFile.existsAsFile()) {
-            aiProcessor.loadModel(modelFile.getFullPathName().toStdString());
+            aiProcessor.loadModelAsync(modelFile.getFullPathName().toStdString(),
+                                       [this](bool success, const std::string& path)
+                                       {
+                                           juce::ignoreUnused(path);
+                                           DBG("[SwindleVX] Model " + juce::String(path)
+                                               + (success ? " ready" : " not loaded (failed or superseded)"));
+
+                                           // The AI path's latency is reported once it can run
+                                           if (success)
+                                               triggerAsyncUpdate();
+                                       });
         }
     }
     else if (modelType == "fish") {
@@ -306,20 +706,35 @@ void VocalSuiteAudioProcessor::loadVoiceModel(const std::string& modelId, const
 
 void VocalSuiteAudioProcessor::startCapture()
 {
-    if (captureBuffer.empty())
-        return;
+    // Allocated here rather than in prepareToPlay, so instances that never capture don't hold it
+    const size_t captureMaxSamples = (size_t) (currentSampleRate * (double) captureMaxSeconds);
+    std::vector<float> newBuffer;
+    if (captureBuffer.size() != captureMaxSamples)
+        newBuffer.assign(captureMaxSamples, 0.0f);
+
+    {
+        const juce::SpinLock::ScopedLockType guard(captureLock);
+        if (!newBuffer.empty())
+            captureBuffer.swap(newBuffer);
+
+        captureWritePos = 0;
+        captureSamplesRecorded = 0;
+        isCapturing.store(true);
+    }
 
-    captureWritePos = 0;
-    captureSamplesRecorded = 0;
     lastCapturedFile = juce::File();
-    isCapturing.store(true);
 }
 
 void VocalSuiteAudioProcessor::stopCapture()
 {
-    isCapturing.store(false);
+    int samplesToWrite;
+    {
+        const juce::SpinLock::ScopedLockType guard(captureLock);
+        isCapturing.store(false);
+        samplesToWrite = captureSamplesRecorded;
+    }
 
-    if (captureSamplesRecorded <= 0 || captureBuffer.empty())
+    if (samplesToWrite <= 0 || captureBuffer.empty())
         return;
 
     juce::File rendersDir = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
@@ -331,7 +746,6 @@ void VocalSuiteAudioProcessor::stopCapture()
     const auto timestamp = juce::Time::getCurrentTime().formatted("%Y%m%d_%H%M%S");
     lastCapturedFile = rendersDir.getChildFile("capture_" + timestamp + ".wav");
 
-    const int samplesToWrite = captureSamplesRecorded;
     const double sr = currentSampleRate;
     const std::vector<float> bufferCopy(captureBuffer.begin(), captureBuffer.begin() + samplesToWrite);
     const juce::File outFileCopy = lastCapturedFile;
@@ -339,26 +753,27 @@ void VocalSuiteAudioProcessor::stopCapture()
     captureWriteInProgress.store(true);
     captureWriteFinished.reset();
 
-    std::thread([this, bufferCopy, outFileCopy, sr]() {
+    // Ahead of any queued conversions, which wait for the file
+    renderQueue.addJob("Save capture", blink::RenderQueue::Priority::High,
+                       [this, bufferCopy, outFileCopy, sr](blink::RenderQueue::JobContext& context) {
+        auto finished = [this](bool written)
+        {
+            captureWriteInProgress.store(false);
+            captureWriteFinished.signal();
+            return written;
+        };
+
         juce::WavAudioFormat wav;
 
         std::unique_ptr<juce::FileOutputStream> outStream(outFileCopy.createOutputStream());
         if (outStream == nullptr)
-        {
-            captureWriteInProgress.store(false);
-            captureWriteFinished.signal();
-            return;
-        }
+            return finished(false);
 
         std::unique_ptr<juce::AudioFormatWriter> writer(
             wav.createWriterFor(outStream.get(), sr, 1, 16, {}, 0));
 
         if (writer == nullptr)
-        {
-            captureWriteInProgress.store(false);
-            captureWriteFinished.signal();
-            return;
-        }
+            return finished(false);
 
         outStream.release();
 
@@ -366,9 +781,34 @@ void VocalSuiteAudioProcessor::stopCapture()
         tmp.copyFrom(0, 0, bufferCopy.data(), (int) bufferCopy.size());
         writer->writeFromAudioSampleBuffer(tmp, 0, tmp.getNumSamples());
 
-        captureWriteInProgress.store(false);
-        captureWriteFinished.signal();
-    }).detach();
+        context.setMessage(outFileCopy.getFullPathName().toStdString());
+        return finished(true);
+    });
+}
+
+bool VocalSuiteAudioProcessor::waitForCapture(const juce::File& captureFile)
+{
+    if (captureWriteInProgress.load())
+        captureWriteFinished.wait(5000);
+
+    return captureFile.existsAsFile();
+}
+
+std::vector<blink::RenderQueue::JobStatus> VocalSuiteAudioProcessor::takeRenderUpdates()
+{
+    std::vector<blink::RenderQueue::JobStatus> updates;
+
+    const std::lock_guard<std::mutex> guard(renderUpdatesLock);
+    for (auto& entry : renderUpdates)
+        updates.push_back(std::move(entry.second));
+    renderUpdates.clear();
+
+    return updates;
+}
+
+void VocalSuiteAudioProcessor::cancelRender(int jobId)
+{
+    renderQueue.cancelJob(jobId);
 }
 
 void VocalSuiteAudioProcessor::convertCapturedAudio(const std::string& modelId, int pitchShift, float formantShift)
@@ -376,32 +816,14 @@ void VocalSuiteAudioProcessor::convertCapturedAudio(const std::string& modelId,
     if (isCapturing.load())
         stopCapture();
 
-    if (captureWriteInProgress.load())
-        captureWriteFinished.wait(5000);
-
-    if (!lastCapturedFile.existsAsFile())
+    // The take may still be being written; the job waits for it
+    if (lastCapturedFile == juce::File())
     {
         DBG("[SwindleVX] convertCapturedAudio: no capture file available");
         return;
     }
 
-    juce::File modelsDir = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
-        .getChildFile("VocalSuitePro")
-        .getChildFile("Models");
-
-    juce::File modelFile;
-    {
-        const juce::File candidate(modelId);
-        if (candidate.existsAsFile())
-            modelFile = candidate;
-        else
-        {
-            modelFile = modelsDir.getChildFile(modelId);
-            if (!modelFile.existsAsFile())
-                modelFile = modelsDir.getChildFile(modelId + ".pth");
-        }
-    }
-
+    const juce::File modelFile = resolveModelFile(*modelCatalog, modelId);
     if (!modelFile.existsAsFile())
     {
         DBG("[SwindleVX] convertCapturedAudio: model not found: " + modelFile.getFullPathName());
@@ -417,73 +839,335 @@ void VocalSuiteAudioProcessor::convertCapturedAudio(const std::string& modelId,
     const auto safeModel = juce::File::createLegalFileName(modelFile.getFileNameWithoutExtension());
     const juce::File outFile = rendersDir.getChildFile("converted_" + safeModel + "_" + timestamp + ".wav");
 
-    const juce::File inputFile = lastCapturedFile;
-    const juce::File modelFileCopy = modelFile;
-    const int pitchShiftCopy = pitchShift;
-    const float formantShiftCopy = formantShift;
+    addConversionJob("Convert with " + safeModel.toStdString(), blink::RenderQueue::Priority::Normal,
+                     lastCapturedFile, outFile, modelFile, pitchShift, formantShift, true);
+}
+
+int VocalSuiteAudioProcessor::convertAudioFiles(const juce::Array<juce::File>& inputs, const std::string& modelId,
+                                                int pitchShift, float formantShift)
+{
+    const juce::File modelFile = resolveModelFile(*modelCatalog, modelId);
+    if (!modelFile.existsAsFile())
+    {
+        DBG("[SwindleVX] convertAudioFiles: model not found: " + modelFile.getFullPathName());
+        return 0;
+    }
+
+    // Folders contribute every audio file inside them
+    juce::Array<juce::File> files;
+    for (const auto& input : inputs)
+    {
+        if (input.isDirectory())
+        {
+            for (const auto& entry : juce::RangedDirectoryIterator(input, true, "*.wav;*.flac;*.aif;*.aiff"))
+                files.addIfNotAlreadyThere(entry.getFile());
+        }
+        else if (input.existsAsFile())
+        {
+            files.addIfNotAlreadyThere(input);
+        }
+    }
+
+    if (files.isEmpty())
+    {
+        DBG("[SwindleVX] convertAudioFiles: no audio files in the selection");
+        return 0;
+    }
+
+    files.sort();
 
-    // Use the lightweight WORLD-based converter by default.
-    const juce::File scriptFile = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+    const auto timestamp = juce::Time::getCurrentTime().formatted("%Y%m%d_%H%M%S");
+    const auto safeModel = juce::File::createLegalFileName(modelFile.getFileNameWithoutExtension());
+    const juce::File batchDir = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
         .getChildFile("VocalSuitePro")
-        .getChildFile("RVC")
-        .getChildFile("voice_convert.py");
+        .getChildFile("Renders")
+        .getChildFile("batch_" + safeModel + "_" + timestamp);
 
-    if (!scriptFile.existsAsFile())
+    if (!batchDir.createDirectory())
     {
-        DBG("[SwindleVX] convertCapturedAudio: backend script not found: " + scriptFile.getFullPathName());
-        return;
+        DBG("[SwindleVX] convertAudioFiles: cannot create " + batchDir.getFullPathName());
+        return 0;
     }
 
-    std::thread([inputFile, outFile, modelFileCopy, scriptFile, pitchShiftCopy, formantShiftCopy]() {
-        DBG("[SwindleVX] Converting captured audio via Python backend...");
-
-        const juce::String args = " run -n rvc310 python "
-            + scriptFile.getFullPathName().quoted()
-            + " " + inputFile.getFullPathName().quoted()
-            + " " + outFile.getFullPathName().quoted()
-            + " --model " + modelFileCopy.getFullPathName().quoted()
-            + " --pitch " + juce::String(pitchShiftCopy)
-            + " --formant " + juce::String(formantShiftCopy);
-
-        const juce::File home = juce::File::getSpecialLocation(juce::File::userHomeDirectory);
-        const std::vector<juce::String> condaCandidates = {
-            "conda",
-            (home.getChildFile("miniconda3/bin/conda").getFullPathName()),
-            (home.getChildFile("mambaforge/bin/conda").getFullPathName()),
-            "/opt/homebrew/Caskroom/miniconda/base/bin/conda",
-            "/usr/local/Caskroom/miniconda/base/bin/conda",
-            "/opt/homebrew/bin/conda",
-            "/usr/local/bin/conda"
-        };
+    auto batch = std::make_shared<ConversionBatch>();
+    batch->modelFile = modelFile;
+    batch->pitchShift = pitchShift;
+    batch->formantShift = formantShift;
 
-        juce::ChildProcess proc;
-        bool started = false;
-        for (const auto& condaPath : condaCandidates)
+    for (const auto& file : files)
+    {
+        const juce::File outFile = batchDir.getNonexistentChildFile(file.getFileNameWithoutExtension() + "_" + safeModel,
+                                                                    ".wav", false);
+        outFile.create();
+
+        batch->files.push_back({ file, outFile });
+    }
+
+    // One job per file so each reports its own status; the render workers take
+    // them in order, behind any capture conversion
+    for (size_t i = 0; i < batch->files.size(); ++i)
+    {
+        const auto name = "Convert " + batch->files[i].input.getFileName().toStdString();
+
+        if (modelFile.hasFileExtension("onnx"))
         {
-            const juce::String cmd = condaPath.quoted() + args;
-            if (proc.start(cmd))
+            renderQueue.addJob(name, blink::RenderQueue::Priority::Low,
+                               [this, batch, i](blink::RenderQueue::JobContext& context) {
+                return convertFromBatch(*batch, i, context);
+            });
+        }
+        else
+        {
+            addConversionJob(name, blink::RenderQueue::Priority::Low, batch->files[i].input, batch->files[i].output,
+                             modelFile, pitchShift, formantShift, false);
+        }
+    }
+
+    DBG("[SwindleVX] Queued " + juce::String(files.size()) + " file(s) for conversion into " + batchDir.getFullPathName());
+    return files.size();
+}
+
+int VocalSuiteAudioProcessor::addConversionJob(const std::string& name, blink::RenderQueue::Priority priority,
+                                               const juce::File& inputFile, const juce::File& outFile,
+                                               const juce::File& modelFile, int pitchShift, float formantShift,
+                                               bool isCapture)
+{
+    // ONNX models convert in-process: no interpreter start-up, no extra disk round-trip
+    if (modelFile.hasFileExtension("onnx"))
+    {
+        return renderQueue.addJob(name, priority,
+                                  [this, inputFile, outFile, modelFile, pitchShift, formantShift, isCapture](blink::RenderQueue::JobContext& context) {
+            if (isCapture && !waitForCapture(inputFile))
             {
-                started = true;
-                break;
+                context.setMessage("Capture file missing");
+                return false;
             }
+
+            std::vector<NativeTake> takes(1);
+            takes[0].inputFile = inputFile;
+            takes[0].outFile = outFile;
+
+            double sampleRate = 44100.0;
+            if (!readMonoAudio(inputFile, takes[0].input, sampleRate))
+            {
+                context.setMessage("Cannot read " + inputFile.getFullPathName().toStdString());
+                return false;
+            }
+
+            std::unique_lock<std::mutex> engineLock;
+            auto& engine = getOfflineConversion().acquireEngine(engineLock);
+
+            if (!convertNatively(engine.processor, context, takes, sampleRate, modelFile, pitchShift, formantShift))
+                return false;
+
+            context.setMessage(outFile.getFullPathName().toStdString());
+            return true;
+        });
+    }
+
+    // Other model types (.pth) have no native runtime; they get the WORLD-style
+    // vocoder's pitch and formant shift, still in-process.
+    return renderQueue.addJob(name, priority,
+                              [this, inputFile, outFile, pitchShift, formantShift, isCapture](blink::RenderQueue::JobContext& context) {
+        if (isCapture && !waitForCapture(inputFile))
+        {
+            context.setMessage("Capture file missing");
+            return false;
         }
 
-        if (!started)
+        auto& conversion = getOfflineConversion();
+        if (!convertWithVocoder(conversion.vocoderLock, conversion.vocoder, context,
+                                inputFile, outFile, pitchShift, formantShift))
+            return false;
+
+        context.setMessage(outFile.getFullPathName().toStdString());
+        return true;
+    });
+}
+
+struct VocalSuiteAudioProcessor::ConversionBatch
+{
+    enum class State { Pending, Converting, Done };
+
+    struct File
+    {
+        juce::File input;
+        juce::File output;
+        State state = State::Pending;
+        bool ok = false;
+        std::string message;
+    };
+
+    juce::File modelFile;
+    int pitchShift = 0;
+    float formantShift = 0.0f;
+    std::vector<File> files;
+
+    std::mutex lock;
+    std::condition_variable changed;
+};
+
+bool VocalSuiteAudioProcessor::convertFromBatch(ConversionBatch& batch, size_t index,
+                                                blink::RenderQueue::JobContext& context)
+{
+    using State = ConversionBatch::State;
+
+    std::vector<size_t> claimed;
+    {
+        std::unique_lock<std::mutex> guard(batch.lock);
+
+        // Another job may already be converting this file along with its own
+        while (batch.files[index].state == State::Converting)
         {
-            DBG("[SwindleVX] Failed to start backend process (conda not found on PATH?)");
-            return;
+            if (context.shouldCancel())
+                return false;
+            batch.changed.wait_for(guard, std::chrono::milliseconds(100));
         }
 
-        proc.waitForProcessToFinish(-1);
-        const auto outText = proc.readAllProcessOutput();
-        if (outText.isNotEmpty())
-            DBG("[SwindleVX] Backend output: " + outText);
+        if (batch.files[index].state == State::Done)
+        {
+            context.setMessage(batch.files[index].message);
+            return batch.files[index].ok;
+        }
 
-        if (outFile.existsAsFile())
-            DBG("[SwindleVX] Converted file saved: " + outFile.getFullPathName());
-        else
-            DBG("[SwindleVX] Backend finished but output file missing: " + outFile.getFullPathName());
-    }).detach();
+        // Pending files have no running job yet. Companions come from the back of
+        // the list, leaving the next files to the other render worker.
+        claimed.push_back(index);
+        for (size_t i = batch.files.size(); i-- > index + 1 && claimed.size() < (size_t) maxTakesPerConversion;)
+            if (batch.files[i].state == State::Pending)
+                claimed.push_back(i);
+
+        for (auto i : claimed)
+            batch.files[i].state = State::Converting;
+    }
+
+    // Read the takes; companions at another rate, or past the memory budget, go back
+    std::vector<NativeTake> takes;
+    std::vector<size_t> converting;
+    std::vector<std::pair<size_t, std::string>> unreadable;
+    std::vector<size_t> released;
+    double sampleRate = 0.0;
+    int64_t totalSamples = 0;
+
+    for (auto i : claimed)
+    {
+        NativeTake take;
+        take.inputFile = batch.files[i].input;
+        take.outFile = batch.files[i].output;
+
+        double rate = 44100.0;
+        if (!readMonoAudio(take.inputFile, take.input, rate))
+        {
+            unreadable.emplace_back(i, "Cannot read " + take.inputFile.getFullPathName().toStdString());
+            continue;
+        }
+
+        const bool isOwn = (i == index);
+        if (!isOwn && (rate != sampleRate
+                       || totalSamples + take.input.getNumSamples() > (int64_t) (maxConversionSeconds * rate)))
+        {
+            released.push_back(i);
+            continue;
+        }
+
+        if (isOwn)
+            sampleRate = rate;
+
+        totalSamples += take.input.getNumSamples();
+        takes.push_back(std::move(take));
+        converting.push_back(i);
+    }
+
+    std::string failure = "Conversion failed";
+    if (!takes.empty())
+    {
+        std::unique_lock<std::mutex> engineLock;
+        auto& engine = getOfflineConversion().acquireEngine(engineLock);
+
+        if (!convertNatively(engine.processor, context, takes, sampleRate, batch.modelFile,
+                             batch.pitchShift, batch.formantShift))
+            failure = engine.processor.getStatusMessage();
+    }
+
+    // Publish every claimed file. Companions not converted because this job was
+    // cancelled go back to their own jobs; other failures are final.
+    const bool cancelled = context.shouldCancel();
+    bool ok = false;
+    {
+        const std::lock_guard<std::mutex> guard(batch.lock);
+
+        for (size_t t = 0; t < takes.size(); ++t)
+        {
+            auto& file = batch.files[converting[t]];
+
+            if (cancelled && !takes[t].converted && converting[t] != index)
+            {
+                file.state = State::Pending;
+                continue;
+            }
+
+            file.state = State::Done;
+            file.ok = takes[t].converted;
+            file.message = file.ok ? file.output.getFullPathName().toStdString()
+                                   : (cancelled ? "Cancelled" : failure);
+        }
+
+        for (const auto& [i, message] : unreadable)
+        {
+            batch.files[i].state = State::Done;
+            batch.files[i].ok = false;
+            batch.files[i].message = message;
+        }
+
+        for (auto i : released)
+            batch.files[i].state = State::Pending;
+
+        ok = batch.files[index].ok;
+        context.setMessage(batch.files[index].message);
+    }
+    batch.changed.notify_all();
+
+    return ok;
+}
+
+VocalSuiteAudioProcessor::OfflineConversion::OfflineConversion(const std::shared_ptr<blink::ModelCatalog>& catalog)
+{
+    // Re-converting a capture with other settings reuses its features; repeats come from disk
+    auto conversionCache = std::make_shared<blink::ConversionCache>(blink::ConversionCache::getDefaultDirectory());
+    for (auto& engine : engines)
+    {
+        engine.processor.setCache(conversionCache);
+        engine.processor.setModelCatalog(catalog);
+    }
+}
+
+VocalSuiteAudioProcessor::OfflineConversion& VocalSuiteAudioProcessor::getOfflineConversion()
+{
+    const std::lock_guard<std::mutex> guard(offlineConversionLock);
+
+    if (offlineConversion == nullptr)
+        offlineConversion = std::make_unique<OfflineConversion>(modelCatalog);
+
+    return *offlineConversion;
+}
+
+VocalSuiteAudioProcessor::OfflineConversion::Engine&
+VocalSuiteAudioProcessor::OfflineConversion::acquireEngine(std::unique_lock<std::mutex>& engineLock)
+{
+    // Prefer an idle engine; if every one is busy, wait on the next in turn
+    for (auto& engine : engines)
+    {
+        std::unique_lock<std::mutex> attempt(engine.lock, std::try_to_lock);
+        if (attempt.owns_lock())
+        {
+            engineLock = std::move(attempt);
+            return engine;
+        }
+    }
+
+    auto& engine = engines[(size_t) (nextEngine++ % (int) engines.size())];
+    engineLock = std::unique_lock<std::mutex>(engine.lock);
+    return engine;
 }
 
 // JUCE Entry point
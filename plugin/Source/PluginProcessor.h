@@ -5,9 +5,23 @@
 #include "DSP/PitchShifter.h"
 #include "DSP/PitchCorrector.h"
 #include "DSP/VoiceCharacter.h"
+#include "DSP/OfflineVoiceProcessor.h"
+#include "DSP/StreamingVoiceConverter.h"
+#include "DSP/WorldVocoder.h"
 #include "AI/ONNXInference.h"
-
-class VocalSuiteAudioProcessor : public juce::AudioProcessor {
+#include "Core/ModelCatalog.h"
+#include "Core/QualityGovernor.h"
+#include "Core/RenderQueue.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+
+class VocalSuiteAudioProcessor : public juce::AudioProcessor,
+                                 private juce::AsyncUpdater {
 public:
     VocalSuiteAudioProcessor();
     ~VocalSuiteAudioProcessor() override;
@@ -47,6 +61,27 @@ public:
     void stopCapture();
     void convertCapturedAudio(const std::string& modelId, int pitchShift, float formantShift);
 
+    /**
+     * Convert a list of audio files and folders (searched recursively) with one
+     * model and settings, into a new Renders/batch_<model>_<time> folder. Each
+     * file is its own render job with its own status; with an ONNX model a job
+     * converts other queued files of the batch along with its own.
+     * @return Number of files queued
+     */
+    int convertAudioFiles(const juce::Array<juce::File>& inputs, const std::string& modelId,
+                          int pitchShift, float formantShift);
+
+    /** The voice models in Documents/VocalSuitePro/Models, scanned in the background. */
+    blink::ModelCatalog& getModelCatalog() { return *modelCatalog; }
+
+    /** Render job changes since the last call, the latest one per job. */
+    std::vector<blink::RenderQueue::JobStatus> takeRenderUpdates();
+
+    void cancelRender(int jobId);
+
+    /** Load and quality tier of the real-time chain, for telemetry. */
+    const blink::QualityGovernor& getQualityGovernor() const { return qualityGovernor; }
+
 private:
     // DSP Modules
     blink::PitchDetector pitchDetector;
@@ -55,7 +90,24 @@ private:
     blink::VoiceCharacter voiceCharacter;
     blink::ONNXInference aiProcessor;
 
+    // Created with the AI path, once a model has loaded
+    std::unique_ptr<blink::StreamingVoiceConverter> streamingConverter;
+
     void resetPitchShiftState();
+
+    // Report the pitch shifter's latency, plus the AI path's once a model is live
+    void updateLatency();
+
+    // Allocate the streaming converter and AI buffers; only while the AI path is inactive
+    void prepareAIPath();
+    void handleAsyncUpdate() override;
+
+    // Steps DSP quality down when processBlock nears its deadline
+    blink::QualityGovernor qualityGovernor;
+    int appliedQualityTier = blink::QualityGovernor::FullQuality;
+
+    // Set the shifter, detector and hop for a governor tier; at a hop boundary only
+    void applyQualityTier(int tier);
     
     // Parameters
     std::atomic<float>* correctionAmount = nullptr;
@@ -75,8 +127,19 @@ private:
     float targetPitch = 0.0f;
     
     // Working buffers
-    std::vector<float> workingBuffer;
     std::vector<float> aiOutputBuffer;
+    std::vector<float> aiInputBuffer;
+
+    // Real-time AI: the processed signal is delayed to line up with the conversion
+    std::atomic<bool> streamingActive { false };
+    bool aiPathPrepared = false;
+
+    // Held while the AI path is (re)built; the audio thread only try-locks it,
+    // leaving the AI path out of a block rather than waiting
+    juce::SpinLock aiPathLock;
+    std::vector<float> dryDelayLine;
+    int dryDelaySamples = 0;
+    int dryDelayPos = 0;
 
     static constexpr int pitchShiftFrameSize = 2048;
     static constexpr int pitchShiftHopSize = 512;
@@ -86,22 +149,94 @@ private:
     std::vector<float> pitchOlaGainRing;
     std::vector<float> pitchFrame;
     std::vector<float> pitchFrameOut;
-    std::vector<float> pitchOlaWindow;
+    std::shared_ptr<const std::vector<float>> pitchOlaWindow;
     std::vector<float> pitchDetectFrame;
     int pitchRingPos = 0;
     int pitchSamplesFilled = 0;
     int pitchSamplesSinceProcess = 0;
-
+    int pitchHopSize = pitchShiftHopSize;  // Doubled by the governor's reduced-overlap tier
+
+    // Idle gate: once the input has stayed below idleCloseLevel long enough for
+    // every tail to play out, the chain is skipped until it rises above
+    // idleOpenLevel. State (OLA rings, delay lines) is left as it was, so
+    // processing resumes exactly where it stopped.
+    static constexpr float idleOpenLevel = 3.16e-4f;  // -70 dBFS peak
+    static constexpr float idleCloseLevel = 1.0e-4f;  // -80 dBFS peak
+    bool idle = false;
+    int quietSamples = 0;
+    std::atomic<int> idleHoldSamples { 0 };
+    int idleFadeSamples = 0;
+
+    // Allocated by startCapture; the audio thread only try-locks captureLock,
+    // skipping a block rather than waiting while the buffer is swapped
+    juce::SpinLock captureLock;
+    static constexpr int captureMaxSeconds = 120; // Mono
     std::vector<float> captureBuffer;
     std::atomic<bool> isCapturing { false };
     int captureWritePos = 0;
     int captureSamplesRecorded = 0;
     juce::File lastCapturedFile;
     std::atomic<bool> captureWriteInProgress { false };
-    juce::WaitableEvent captureWriteFinished;
+    juce::WaitableEvent captureWriteFinished { true };
+
+    // Wait for a take being saved; false if it never appeared
+    bool waitForCapture(const juce::File& captureFile);
+
+    static constexpr int numRenderWorkers = 2;
+
+    // In-process conversion engines; each mutex serialises renders on its engine
+    struct OfflineConversion {
+        // One native converter per render worker, so conversions run side by
+        // side and each keeps its model loaded from job to job
+        struct Engine {
+            std::mutex lock;
+            blink::OfflineVoiceProcessor processor;
+        };
+        std::array<Engine, numRenderWorkers> engines;
+
+        // Engines share one conversion cache, and record variant choices in the catalog
+        explicit OfflineConversion(const std::shared_ptr<blink::ModelCatalog>& catalog);
+        std::atomic<int> nextEngine { 0 };
+
+        // Lock an idle engine, or wait for a busy one if there is none
+        Engine& acquireEngine(std::unique_lock<std::mutex>& engineLock);
+
+        std::mutex vocoderLock;
+        blink::WorldVocoder vocoder;
+    };
+    std::mutex offlineConversionLock;
+    std::unique_ptr<OfflineConversion> offlineConversion;
+
+    // The converters, built by the first render job that needs them
+    OfflineConversion& getOfflineConversion();
+
+    // Queue a conversion of inputFile with modelFile; capture jobs first wait for the take to be saved
+    int addConversionJob(const std::string& name, blink::RenderQueue::Priority priority,
+                         const juce::File& inputFile, const juce::File& outFile,
+                         const juce::File& modelFile, int pitchShift, float formantShift,
+                         bool isCapture);
+
+    // Files queued together by convertAudioFiles. The first of their jobs to run
+    // converts its file plus up to maxTakesPerConversion - 1 others whose jobs
+    // have not started, in one processTakes call, so short takes share inference
+    // runs; those jobs then only report the result.
+    struct ConversionBatch;
+    static constexpr int maxTakesPerConversion = 8;
+    static constexpr double maxConversionSeconds = 600.0; // Audio read at once per conversion
+
+    bool convertFromBatch(ConversionBatch& batch, size_t index, blink::RenderQueue::JobContext& context);
+
+    std::shared_ptr<blink::ModelCatalog> modelCatalog { blink::ModelCatalog::getShared() };
+
+    std::mutex renderUpdatesLock;
+    std::map<int, blink::RenderQueue::JobStatus> renderUpdates;
 
     // Parameter layout
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
+    // Capture saves and conversions. Declared last so its jobs stop before the
+    // members they use are destroyed.
+    blink::RenderQueue renderQueue { numRenderWorkers };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VocalSuiteAudioProcessor)
 };
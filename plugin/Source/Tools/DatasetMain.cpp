@@ -0,0 +1,121 @@
+/**
+ * VocalSuiteDataset - builds a voice-model training set from capture WAVs.
+ *
+ * Slices takes on silence, normalises loudness, resamples to the model rate and
+ * writes audio with F0 and mel features to memory-mappable shards (see
+ * blink::DatasetBuilder), spreading files over all cores.
+ *
+ *   VocalSuiteDataset [options] [file or folder]...
+ *
+ * With no inputs, every capture in Documents/VocalSuitePro/Renders is used.
+ */
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "../Core/DatasetBuilder.h"
+
+#include <iostream>
+
+namespace {
+
+void printUsage() {
+    std::cout
+        << "Usage: VocalSuiteDataset [options] [file or folder]...\n"
+        << "\n"
+        << "Inputs default to the capture_*.wav takes in Documents/VocalSuitePro/Renders.\n"
+        << "\n"
+        << "Options:\n"
+        << "  --output <dir>        Dataset folder (default: Documents/VocalSuitePro/Datasets/dataset_<time>)\n"
+        << "  --rate <hz>           Model sample rate (default: 40000)\n"
+        << "  --threshold <db>      Silence threshold below the loudest window (default: -40)\n"
+        << "  --min-silence <s>     Shortest pause that splits a take (default: 0.3)\n"
+        << "  --min-slice <s>       Shortest slice kept (default: 1.0)\n"
+        << "  --max-slice <s>       Longest slice before it is cut up (default: 4.0)\n"
+        << "  --loudness <db>       Target RMS loudness (default: -20)\n"
+        << "  --threads <n>         Worker threads (default: all cores)\n";
+}
+
+void collectInputs(const juce::File& path, juce::Array<juce::File>& inputs) {
+    if (path.isDirectory()) {
+        for (const auto& entry : juce::RangedDirectoryIterator(path, true, "*.wav;*.flac;*.aif;*.aiff"))
+            inputs.add(entry.getFile());
+    } else if (path.existsAsFile()) {
+        inputs.add(path);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    juce::ArgumentList args(argc, argv);
+    blink::DatasetBuilder::Settings settings;
+    juce::File outputDir;
+    juce::Array<juce::File> inputs;
+
+    for (int i = 0; i < args.size(); i++) {
+        const auto arg = args[i].text;
+        const bool hasValue = i + 1 < args.size();
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else if (arg == "--output" && hasValue) {
+            outputDir = args[++i].resolveAsFile();
+        } else if (arg == "--rate" && hasValue) {
+            settings.sampleRate = juce::jlimit(8000.0, 96000.0, args[++i].text.getDoubleValue());
+        } else if (arg == "--threshold" && hasValue) {
+            settings.silenceThresholdDb = args[++i].text.getFloatValue();
+        } else if (arg == "--min-silence" && hasValue) {
+            settings.minSilenceSeconds = args[++i].text.getFloatValue();
+        } else if (arg == "--min-slice" && hasValue) {
+            settings.minSliceSeconds = args[++i].text.getFloatValue();
+        } else if (arg == "--max-slice" && hasValue) {
+            settings.maxSliceSeconds = juce::jmax(0.5f, args[++i].text.getFloatValue());
+        } else if (arg == "--loudness" && hasValue) {
+            settings.targetLoudnessDb = args[++i].text.getFloatValue();
+        } else if (arg == "--threads" && hasValue) {
+            settings.numThreads = args[++i].text.getIntValue();
+        } else if (arg.startsWith("--")) {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage();
+            return 1;
+        } else {
+            collectInputs(args[i].resolveAsFile(), inputs);
+        }
+    }
+
+    if (inputs.isEmpty())
+        inputs = blink::DatasetBuilder::findCaptures(blink::DatasetBuilder::getCaptureDirectory());
+
+    if (inputs.isEmpty()) {
+        std::cerr << "No captures found in " << blink::DatasetBuilder::getCaptureDirectory().getFullPathName() << std::endl;
+        return 1;
+    }
+
+    if (outputDir == juce::File()) {
+        const auto timestamp = juce::Time::getCurrentTime().formatted("%Y%m%d_%H%M%S");
+        outputDir = blink::DatasetBuilder::getDefaultOutputDirectory().getChildFile("dataset_" + timestamp);
+    }
+
+    blink::DatasetBuilder builder;
+    builder.setSettings(settings);
+
+    blink::DatasetBuilder::Summary summary;
+    const bool ok = builder.build(inputs, outputDir, summary);
+
+    for (const auto& error : summary.errors)
+        std::cerr << error << std::endl;
+
+    std::cout << "Processed " << (summary.numFiles - summary.numFailedFiles) << "/" << summary.numFiles
+              << " files (" << juce::String(summary.sourceSeconds, 1) << " s of audio) into "
+              << summary.numSlices << " slices (" << juce::String(summary.sliceSeconds, 1) << " s, "
+              << summary.numFrames << " frames) in " << summary.numShards << " shard(s)\n"
+              << "Time: " << juce::String(summary.wallSeconds, 2) << " s wall, "
+              << juce::String(summary.cpuSeconds, 2) << " s across workers ("
+              << juce::String(summary.sourceSeconds / juce::jmax(1.0e-9, summary.cpuSeconds), 0)
+              << "x realtime per core)\n"
+              << "Output: " << outputDir.getFullPathName() << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+/**
+ * VocalSuiteInstanceBench - measures what each plugin instance costs a session.
+ *
+ * Creates a session's worth of VocalSuiteAudioProcessor instances the way a
+ * host loading a project would (construct, prepareToPlay, a first block) and
+ * reports the time and resident memory each stage adds per instance.
+ *
+ *   VocalSuiteInstanceBench [options]
+ *
+ * With --max-ms or --max-mb it exits with 1 when an instance costs more, so it
+ * can guard against startup regressions.
+ */
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "../PluginProcessor.h"
+
+#include <chrono>
+#include <iostream>
+
+#if JUCE_MAC
+ #include <mach/mach.h>
+#elif JUCE_WINDOWS
+ #include <windows.h>
+ #include <psapi.h>
+ #pragma comment(lib, "psapi.lib")
+#else
+ #include <unistd.h>
+#endif
+
+namespace {
+
+struct BenchSettings {
+    int numInstances = 60;
+    double sampleRate = 48000.0;
+    int blockSize = 512;
+    double maxMilliseconds = 0.0;  // Per instance, 0 = no limit
+    double maxMegabytes = 0.0;     // Per instance, 0 = no limit
+};
+
+void printUsage() {
+    std::cout
+        << "Usage: VocalSuiteInstanceBench [options]\n"
+        << "\n"
+        << "Options:\n"
+        << "  --instances <n>       Instances to create, like tracks in a session (default: 60)\n"
+        << "  --rate <hz>           Sample rate passed to prepareToPlay (default: 48000)\n"
+        << "  --block <n>           Block size (default: 512)\n"
+        << "  --max-ms <ms>         Fail if an instance takes longer to set up, on average\n"
+        << "  --max-mb <mb>         Fail if an instance adds more resident memory, on average\n";
+}
+
+// Resident set size of this process in bytes, 0 if it can't be read
+int64_t getResidentBytes() {
+   #if JUCE_MAC
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) != KERN_SUCCESS)
+        return 0;
+    return (int64_t) info.resident_size;
+   #elif JUCE_WINDOWS
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return (int64_t) counters.WorkingSetSize;
+   #else
+    // Second field of statm: resident pages
+    const auto fields = juce::StringArray::fromTokens(juce::File("/proc/self/statm").loadFileAsString(), false);
+    if (fields.size() < 2)
+        return 0;
+    return fields[1].getLargeIntValue() * (int64_t) sysconf(_SC_PAGESIZE);
+   #endif
+}
+
+struct Stage {
+    const char* name;
+    double seconds = 0.0;
+    int64_t residentBytes = 0;
+};
+
+template <typename Function>
+Stage measure(const char* name, Function&& function) {
+    Stage stage { name };
+    const int64_t residentBefore = getResidentBytes();
+    const auto start = std::chrono::steady_clock::now();
+
+    function();
+
+    stage.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stage.residentBytes = getResidentBytes() - residentBefore;
+    return stage;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    juce::ArgumentList args(argc, argv);
+    BenchSettings settings;
+
+    for (int i = 0; i < args.size(); i++) {
+        const auto arg = args[i].text;
+        const bool hasValue = i + 1 < args.size();
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else if (arg == "--instances" && hasValue) {
+            settings.numInstances = juce::jmax(1, args[++i].text.getIntValue());
+        } else if (arg == "--rate" && hasValue) {
+            settings.sampleRate = juce::jlimit(8000.0, 192000.0, args[++i].text.getDoubleValue());
+        } else if (arg == "--block" && hasValue) {
+            settings.blockSize = juce::jlimit(16, 8192, args[++i].text.getIntValue());
+        } else if (arg == "--max-ms" && hasValue) {
+            settings.maxMilliseconds = args[++i].text.getDoubleValue();
+        } else if (arg == "--max-mb" && hasValue) {
+            settings.maxMegabytes = args[++i].text.getDoubleValue();
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::vector<std::unique_ptr<VocalSuiteAudioProcessor>> processors;
+    processors.reserve((size_t) settings.numInstances);
+
+    juce::AudioBuffer<float> block(1, settings.blockSize);
+    juce::MidiBuffer midi;
+
+    const Stage stages[] = {
+        measure("construct", [&] {
+            for (int i = 0; i < settings.numInstances; i++)
+                processors.push_back(std::make_unique<VocalSuiteAudioProcessor>());
+        }),
+        measure("prepareToPlay", [&] {
+            for (auto& processor : processors)
+                processor->prepareToPlay(settings.sampleRate, settings.blockSize);
+        }),
+        measure("first block", [&] {
+            for (auto& processor : processors) {
+                block.clear();
+                processor->processBlock(block, midi);
+            }
+        }),
+    };
+
+    double totalSeconds = 0.0;
+    int64_t totalBytes = 0;
+    const double perInstance = 1.0 / settings.numInstances;
+
+    std::cout << settings.numInstances << " instances at " << settings.sampleRate << " Hz, "
+              << settings.blockSize << "-sample blocks\n";
+
+    for (const auto& stage : stages) {
+        totalSeconds += stage.seconds;
+        totalBytes += stage.residentBytes;
+
+        std::cout << "  " << juce::String(stage.name).paddedRight(' ', 14)
+                  << juce::String(stage.seconds * 1000.0 * perInstance, 3) << " ms, "
+                  << juce::String(stage.residentBytes * perInstance / 1024.0, 1) << " KB per instance\n";
+    }
+
+    const double instanceMilliseconds = totalSeconds * 1000.0 * perInstance;
+    const double instanceMegabytes = totalBytes * perInstance / (1024.0 * 1024.0);
+
+    std::cout << "Total: " << juce::String(instanceMilliseconds, 3) << " ms, "
+              << juce::String(instanceMegabytes, 2) << " MB resident per instance ("
+              << juce::String(totalSeconds * 1000.0, 1) << " ms, "
+              << juce::String(totalBytes / (1024.0 * 1024.0), 1) << " MB for the session)" << std::endl;
+
+    processors.clear();
+
+    bool ok = true;
+    if (settings.maxMilliseconds > 0.0 && instanceMilliseconds > settings.maxMilliseconds) {
+        std::cerr << "Setup time per instance exceeds " << settings.maxMilliseconds << " ms" << std::endl;
+        ok = false;
+    }
+    if (settings.maxMegabytes > 0.0 && instanceMegabytes > settings.maxMegabytes) {
+        std::cerr << "Resident memory per instance exceeds " << settings.maxMegabytes << " MB" << std::endl;
+        ok = false;
+    }
+
+    return ok ? 0 : 1;
+}
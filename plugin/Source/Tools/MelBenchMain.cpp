@@ -0,0 +1,229 @@
+/**
+ * VocalSuiteMelBench - checks and times the sparse mel spectrogram.
+ *
+ * Computes a reference mel spectrogram the straightforward way (a dense
+ * bands x bins filterbank matrix and std::log10, per frame) and compares
+ * MelSpectrogram::processFrame and the batched processFrames against it. Reports
+ * the largest difference in log10 units and frames per second for each.
+ *
+ *   VocalSuiteMelBench [options]
+ *
+ * Exits with 1 if either path differs from the reference by more than the
+ * tolerance.
+ */
+
+#include <juce_dsp/juce_dsp.h>
+#include "../DSP/MelSpectrogram.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+struct BenchSettings {
+    double sampleRate = 48000.0;
+    int fftSize = 2048;
+    int hopSize = 512;
+    int numMelBands = 80;
+    double seconds = 30.0;       // Audio analysed per timed run
+    double tolerance = 1.0e-3;   // Largest allowed difference, log10 units (0.01 dB)
+};
+
+void printUsage() {
+    std::cout
+        << "Usage: VocalSuiteMelBench [options]\n"
+        << "\n"
+        << "Options:\n"
+        << "  --rate <hz>           Sample rate (default: 48000)\n"
+        << "  --fft <n>             FFT size, a power of two (default: 2048)\n"
+        << "  --hop <n>             Hop size (default: 512)\n"
+        << "  --bands <n>           Mel bands (default: 80)\n"
+        << "  --seconds <s>         Audio analysed per timed run (default: 30)\n"
+        << "  --tolerance <x>       Largest allowed difference from the dense reference,\n"
+        << "                        in log10 units (default: 0.001)\n";
+}
+
+// Sung vowel with vibrato over a little noise, so every band sees energy
+std::vector<float> makeVoice(double sampleRate, int numSamples) {
+    std::vector<float> signal((size_t)numSamples);
+    juce::Random random(1);
+    double phase = 0.0;
+    for (int i = 0; i < numSamples; i++) {
+        const double t = i / sampleRate;
+        const double f0 = 200.0 * (1.0 + 0.02 * std::sin(juce::MathConstants<double>::twoPi * 5.5 * t));
+        phase += juce::MathConstants<double>::twoPi * f0 / sampleRate;
+
+        float sample = 0.0f;
+        for (int harmonic = 1; harmonic * f0 < sampleRate / 2.0; harmonic++) {
+            sample += 0.3f / harmonic * (float)std::sin(phase * harmonic);
+        }
+        signal[(size_t)i] = sample + 0.01f * (random.nextFloat() - 0.5f);
+    }
+    return signal;
+}
+
+/**
+ * The textbook computation: the same triangular filters as the shared table,
+ * but as a full matrix, applied bin by bin with double accumulation.
+ */
+class DenseMel {
+public:
+    DenseMel(const BenchSettings& settings)
+        : fftSize(settings.fftSize), numBins(settings.fftSize / 2 + 1), numBands(settings.numMelBands),
+          fft(juce::roundToInt(std::log2(settings.fftSize))),
+          window((size_t)settings.fftSize), fftData((size_t)settings.fftSize * 2), power((size_t)numBins),
+          matrix((size_t)numBands * numBins, 0.0f) {
+        for (int i = 0; i < fftSize; i++) {
+            window[(size_t)i] = 0.5f * (1.0f - std::cos(juce::MathConstants<float>::twoPi * i / (fftSize - 1)));
+        }
+
+        auto hzToMel = [](double hz) { return 2595.0 * std::log10(1.0 + hz / 700.0); };
+        auto melToHz = [](double mel) { return 700.0 * (std::pow(10.0, mel / 2595.0) - 1.0); };
+
+        const double maxMel = hzToMel(settings.sampleRate / 2.0);
+        std::vector<int> edges((size_t)numBands + 2);
+        for (int i = 0; i < numBands + 2; i++) {
+            const double hz = melToHz(maxMel * i / (numBands + 1));
+            edges[(size_t)i] = std::min(numBins, (int)std::floor((fftSize + 1) * hz / settings.sampleRate));
+        }
+
+        for (int band = 0; band < numBands; band++) {
+            const int left = edges[(size_t)band], centre = edges[(size_t)band + 1], right = edges[(size_t)band + 2];
+            for (int k = left; k < right; k++) {
+                matrix[(size_t)band * numBins + k] = (k < centre) ? (float)(k - left) / (centre - left)
+                                                                  : (float)(right - k) / (right - centre);
+            }
+        }
+    }
+
+    void processFrame(const float* input, float* output) {
+        for (int i = 0; i < fftSize; i++) {
+            fftData[(size_t)i] = input[i] * window[(size_t)i];
+        }
+        std::fill(fftData.begin() + fftSize, fftData.end(), 0.0f);
+        fft.performRealOnlyForwardTransform(fftData.data(), true);
+
+        for (int k = 0; k < numBins; k++) {
+            power[(size_t)k] = fftData[(size_t)k * 2] * fftData[(size_t)k * 2] + fftData[(size_t)k * 2 + 1] * fftData[(size_t)k * 2 + 1];
+        }
+
+        for (int band = 0; band < numBands; band++) {
+            const float* row = matrix.data() + (size_t)band * numBins;
+            double energy = 0.0;
+            for (int k = 0; k < numBins; k++) {
+                energy += (double)row[k] * power[(size_t)k];
+            }
+            output[band] = (float)std::log10(energy + 1.0e-10);
+        }
+    }
+
+private:
+    const int fftSize;
+    const int numBins;
+    const int numBands;
+    juce::dsp::FFT fft;
+    std::vector<float> window;
+    std::vector<float> fftData;
+    std::vector<float> power;
+    std::vector<float> matrix;  // Band-major, numBands x numBins
+};
+
+template <typename Function>
+double framesPerSecond(int numFrames, Function&& analyse) {
+    analyse(); // Warm up caches and plans
+
+    const auto start = std::chrono::steady_clock::now();
+    analyse();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return numFrames / juce::jmax(1.0e-9, seconds);
+}
+
+double maxDifference(const std::vector<float>& a, const std::vector<float>& b) {
+    double largest = 0.0;
+    for (size_t i = 0; i < a.size(); i++) {
+        largest = juce::jmax(largest, (double)std::abs(a[i] - b[i]));
+    }
+    return largest;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    juce::ArgumentList args(argc, argv);
+    BenchSettings settings;
+
+    for (int i = 0; i < args.size(); i++) {
+        const auto arg = args[i].text;
+        const bool hasValue = i + 1 < args.size();
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else if (arg == "--rate" && hasValue) {
+            settings.sampleRate = juce::jlimit(8000.0, 192000.0, args[++i].text.getDoubleValue());
+        } else if (arg == "--fft" && hasValue) {
+            settings.fftSize = juce::nextPowerOfTwo(juce::jlimit(256, 16384, args[++i].text.getIntValue()));
+        } else if (arg == "--hop" && hasValue) {
+            settings.hopSize = juce::jmax(16, args[++i].text.getIntValue());
+        } else if (arg == "--bands" && hasValue) {
+            settings.numMelBands = juce::jlimit(8, 256, args[++i].text.getIntValue());
+        } else if (arg == "--seconds" && hasValue) {
+            settings.seconds = juce::jlimit(0.5, 600.0, args[++i].text.getDoubleValue());
+        } else if (arg == "--tolerance" && hasValue) {
+            settings.tolerance = args[++i].text.getDoubleValue();
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    const int numFrames = juce::jmax(1, (int)(settings.seconds * settings.sampleRate / settings.hopSize));
+    const int numSamples = (numFrames - 1) * settings.hopSize + settings.fftSize;
+    const auto voice = makeVoice(settings.sampleRate, numSamples);
+    const int numBands = settings.numMelBands;
+
+    std::vector<float> reference((size_t)numFrames * numBands);
+    std::vector<float> single(reference.size());
+    std::vector<float> batched(reference.size());
+
+    DenseMel dense(settings);
+    blink::MelSpectrogram mel(settings.fftSize, settings.hopSize, numBands);
+    mel.setSampleRate(settings.sampleRate);
+
+    const double denseRate = framesPerSecond(numFrames, [&] {
+        for (int frame = 0; frame < numFrames; frame++) {
+            dense.processFrame(voice.data() + (size_t)frame * settings.hopSize, reference.data() + (size_t)frame * numBands);
+        }
+    });
+
+    const double singleRate = framesPerSecond(numFrames, [&] {
+        for (int frame = 0; frame < numFrames; frame++) {
+            mel.processFrame(voice.data() + (size_t)frame * settings.hopSize, settings.fftSize,
+                             single.data() + (size_t)frame * numBands);
+        }
+    });
+
+    const double batchedRate = framesPerSecond(numFrames, [&] {
+        mel.processFrames(voice.data(), numFrames, batched.data());
+    });
+
+    const double singleError = maxDifference(reference, single);
+    const double batchedError = maxDifference(reference, batched);
+
+    std::cout << numFrames << " frames, " << settings.fftSize << "-point FFT, hop " << settings.hopSize << ", "
+              << numBands << " bands at " << settings.sampleRate << " Hz\n"
+              << "  dense reference   " << juce::String(denseRate, 0).paddedLeft(' ', 10) << " frames/s\n"
+              << "  processFrame      " << juce::String(singleRate, 0).paddedLeft(' ', 10) << " frames/s  ("
+              << juce::String(singleRate / denseRate, 1) << "x), max difference " << singleError << "\n"
+              << "  processFrames     " << juce::String(batchedRate, 0).paddedLeft(' ', 10) << " frames/s  ("
+              << juce::String(batchedRate / denseRate, 1) << "x), max difference " << batchedError << std::endl;
+
+    if (singleError > settings.tolerance || batchedError > settings.tolerance) {
+        std::cerr << "Sparse output differs from the dense reference by more than " << settings.tolerance << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
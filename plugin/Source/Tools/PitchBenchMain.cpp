@@ -0,0 +1,135 @@
+/**
+ * VocalSuitePitchBench - times the PitchShifter kernels for each supported
+ * frame/hop configuration.
+ *
+ * Runs a synthetic voiced signal (a harmonic series plus a little noise)
+ * through every configuration, with LPC and with smoothed-spectrum formants,
+ * and reports the time per frame and the share of one core a real-time
+ * channel needs.
+ *
+ *   VocalSuitePitchBench [options]
+ */
+
+#include <juce_dsp/juce_dsp.h>
+#include "../DSP/PitchShifter.h"
+
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+struct BenchSettings {
+    double sampleRate = 48000.0;
+    double seconds = 10.0;      // Audio processed per configuration
+    float pitchRatio = 1.12f;   // About two semitones up
+    float formantRatio = 1.06f;
+};
+
+void printUsage() {
+    std::cout
+        << "Usage: VocalSuitePitchBench [options]\n"
+        << "\n"
+        << "Options:\n"
+        << "  --rate <hz>           Sample rate (default: 48000)\n"
+        << "  --seconds <s>         Audio to process per configuration (default: 10)\n"
+        << "  --pitch <ratio>       Pitch ratio (default: 1.12)\n"
+        << "  --formant <ratio>     Formant ratio, 1 skips formant work (default: 1.06)\n";
+}
+
+// Vowel-like test signal: 180 Hz harmonic series with a falling spectrum, plus noise
+std::vector<float> makeVoice(double sampleRate, int numSamples) {
+    std::vector<float> signal((size_t)numSamples);
+    juce::Random random(1);
+    for (int i = 0; i < numSamples; i++) {
+        float sample = 0.0f;
+        for (int harmonic = 1; harmonic <= 12; harmonic++) {
+            sample += 0.3f / harmonic
+                    * std::sin(juce::MathConstants<float>::twoPi * 180.0f * harmonic * (float)(i / sampleRate));
+        }
+        signal[(size_t)i] = sample + 0.02f * (random.nextFloat() - 0.5f);
+    }
+    return signal;
+}
+
+// Microseconds per frame over `seconds` of audio
+double timeConfiguration(int fftSize, int hopSize, bool useLPC, const BenchSettings& settings,
+                         const std::vector<float>& voice) {
+    blink::PitchShifter shifter(fftSize, hopSize);
+    shifter.setSampleRate(settings.sampleRate);
+    shifter.setUseLPCFormants(useLPC);
+
+    std::vector<float> output((size_t)fftSize);
+    const int numStarts = (int)voice.size() - fftSize;
+    const int numFrames = juce::jmax(1, (int)(settings.seconds * settings.sampleRate / hopSize));
+
+    // Warm up caches and the FFT plan
+    for (int frame = 0; frame < 32; frame++) {
+        shifter.processFrame(voice.data() + (frame * hopSize) % numStarts, output.data(),
+                             settings.pitchRatio, settings.formantRatio);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < numFrames; frame++) {
+        shifter.processFrame(voice.data() + (frame * hopSize) % numStarts, output.data(),
+                             settings.pitchRatio, settings.formantRatio);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds * 1.0e6 / numFrames;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    juce::ArgumentList args(argc, argv);
+    BenchSettings settings;
+
+    for (int i = 0; i < args.size(); i++) {
+        const auto arg = args[i].text;
+        const bool hasValue = i + 1 < args.size();
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else if (arg == "--rate" && hasValue) {
+            settings.sampleRate = juce::jlimit(8000.0, 192000.0, args[++i].text.getDoubleValue());
+        } else if (arg == "--seconds" && hasValue) {
+            settings.seconds = juce::jlimit(0.1, 600.0, args[++i].text.getDoubleValue());
+        } else if (arg == "--pitch" && hasValue) {
+            settings.pitchRatio = juce::jlimit(0.25f, 4.0f, args[++i].text.getFloatValue());
+        } else if (arg == "--formant" && hasValue) {
+            settings.formantRatio = juce::jlimit(0.25f, 4.0f, args[++i].text.getFloatValue());
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    const auto voice = makeVoice(settings.sampleRate, (int)settings.sampleRate);
+
+    std::cout << "Pitch ratio " << settings.pitchRatio << ", formant ratio " << settings.formantRatio
+              << ", " << settings.sampleRate << " Hz\n"
+              << "  frame   hop    LPC us/frame  (CPU)     envelope us/frame  (CPU)\n";
+
+    for (int fftSize : { 1024, 2048, 4096 }) {
+        for (int overlap : { 2, 4, 8 }) {
+            const int hopSize = fftSize / overlap;
+            jassert(blink::PitchShifter::isSupported(fftSize, hopSize));
+
+            // Share of one core a real-time channel needs: frame time over hop duration
+            const double hopMicroseconds = hopSize * 1.0e6 / settings.sampleRate;
+            const double lpc = timeConfiguration(fftSize, hopSize, true, settings, voice);
+            const double envelope = timeConfiguration(fftSize, hopSize, false, settings, voice);
+
+            std::cout << "  " << juce::String(fftSize).paddedLeft(' ', 5)
+                      << "  " << juce::String(hopSize).paddedLeft(' ', 4)
+                      << "  " << juce::String(lpc, 1).paddedLeft(' ', 13)
+                      << "  (" << juce::String(100.0 * lpc / hopMicroseconds, 2) << "%)"
+                      << "  " << juce::String(envelope, 1).paddedLeft(' ', 17)
+                      << "  (" << juce::String(100.0 * envelope / hopMicroseconds, 2) << "%)\n";
+        }
+    }
+
+    std::cout << std::flush;
+    return 0;
+}
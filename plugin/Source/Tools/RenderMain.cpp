@@ -0,0 +1,395 @@
+/**
+ * VocalSuiteRender - headless, faster-than-realtime renderer for the full vocal chain.
+ *
+ * Runs VocalSuiteAudioProcessor in non-realtime mode over WAV/FLAC/AIFF files,
+ * one processor instance per worker thread, and reports throughput as a multiple
+ * of real time per core.
+ *
+ *   VocalSuiteRender [options] <file or folder>...
+ */
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "../PluginProcessor.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <thread>
+
+namespace {
+
+struct RenderSettings {
+    juce::File outputDir;
+    juce::NamedValueSet parameters; // APVTS parameter id -> plain (unnormalised) value
+    int numThreads = 0;
+    int blockSize = 512;
+};
+
+struct FileResult {
+    juce::File input;
+    bool ok = false;
+    juce::String error;
+    double audioSeconds = 0.0;
+    double renderSeconds = 0.0;
+};
+
+void printUsage() {
+    std::cout
+        << "Usage: VocalSuiteRender [options] <file or folder>...\n"
+        << "\n"
+        << "Options:\n"
+        << "  --output <dir>        Output folder (default: next to each input, suffixed _vsp)\n"
+        << "  --preset <file.json>  Parameter preset; keys as below\n"
+        << "  --key <0-11|C..B>     Root key\n"
+        << "  --scale <0-8>         0=Major 1=Minor 2=HarmonicMinor 3=MelodicMinor 4=Dorian\n"
+        << "                        5=Phrygian 6=Lydian 7=Mixolydian 8=Chromatic\n"
+        << "  --correction <0-1>    Correction amount\n"
+        << "  --speed <0-1>         Correction speed\n"
+        << "  --pitch <-24..24>     Pitch shift in semitones\n"
+        << "  --formant <-12..12>   Formant shift in semitones\n"
+        << "  --breath <0-1>        Breath amount\n"
+        << "  --resonance <0-1>     Resonance amount\n"
+        << "  --threads <n>         Worker threads (default: all cores)\n"
+        << "  --block <n>           Processing block size (default: 512)\n";
+}
+
+const char* const presetParameterIds[] = {
+    "key", "scale", "correction", "speed", "pitch", "formant", "breath", "resonance"
+};
+
+float parseKey(const juce::String& text) {
+    static const char* const names[] = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
+
+    for (int i = 0; i < 12; i++)
+        if (text.equalsIgnoreCase(names[i]))
+            return (float) i;
+
+    return (float) text.getIntValue();
+}
+
+bool loadPreset(const juce::File& presetFile, juce::NamedValueSet& parameters, juce::String& error) {
+    const auto json = juce::JSON::parse(presetFile);
+    auto* obj = json.getDynamicObject();
+
+    if (obj == nullptr) {
+        error = "Preset is not a JSON object: " + presetFile.getFullPathName();
+        return false;
+    }
+
+    for (auto* id : presetParameterIds) {
+        if (!obj->hasProperty(id))
+            continue;
+
+        const auto value = obj->getProperty(id);
+        if (juce::String(id) == "key" && value.isString())
+            parameters.set(id, parseKey(value.toString()));
+        else
+            parameters.set(id, (float) value);
+    }
+
+    return true;
+}
+
+void applyParameters(VocalSuiteAudioProcessor& processor, const juce::NamedValueSet& parameters) {
+    for (const auto& entry : parameters) {
+        if (auto* param = processor.parameters.getParameter(entry.name.toString())) {
+            const float value = (float) entry.value;
+            if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(param))
+                param->setValueNotifyingHost(ranged->convertTo0to1(value));
+            else
+                param->setValueNotifyingHost(juce::jlimit(0.0f, 1.0f, value));
+        }
+    }
+}
+
+/**
+ * Opens a reader, memory-mapping the file when the format supports it
+ * (WAV, AIFF) and falling back to a streaming reader otherwise (FLAC).
+ * Blocks are read from it as they are rendered, so a mapped file is never
+ * copied whole.
+ */
+std::unique_ptr<juce::AudioFormatReader> openReader(juce::AudioFormatManager& formats, const juce::File& file) {
+    for (int i = 0; i < formats.getNumKnownFormats(); i++) {
+        auto* format = formats.getKnownFormat(i);
+        if (!format->canHandleFile(file))
+            continue;
+
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format->createMemoryMappedReader(file));
+        if (mapped != nullptr && mapped->mapEntireFile())
+            return mapped;
+    }
+
+    return std::unique_ptr<juce::AudioFormatReader>(formats.createReaderFor(file));
+}
+
+juce::File getOutputFile(const juce::File& input, const RenderSettings& settings) {
+    const bool flac = input.hasFileExtension("flac");
+    const auto extension = flac ? ".flac" : ".wav";
+
+    if (settings.outputDir != juce::File())
+        return settings.outputDir.getChildFile(input.getFileNameWithoutExtension() + extension);
+
+    return input.getSiblingFile(input.getFileNameWithoutExtension() + "_vsp" + extension);
+}
+
+FileResult renderFile(VocalSuiteAudioProcessor& processor, juce::AudioFormatManager& formats,
+                      const juce::File& input, const juce::File& outFile, const RenderSettings& settings) {
+    FileResult result;
+    result.input = input;
+
+    auto reader = openReader(formats, input);
+    if (reader == nullptr) {
+        result.error = "Unsupported or unreadable file";
+        return result;
+    }
+
+    // Unknown (negative) lengths and files past INT_MAX samples can't be rendered in one pass
+    if (reader->lengthInSamples <= 0 || reader->lengthInSamples > std::numeric_limits<int>::max()) {
+        result.error = reader->lengthInSamples <= 0 ? "Empty file or unknown length"
+                                                    : "File too long (more than 2^31 samples)";
+        return result;
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+
+    const int numSamples = (int) reader->lengthInSamples;
+    const int numChannels = (int) reader->numChannels;
+    const double sampleRate = reader->sampleRate;
+    const int blockSize = settings.blockSize;
+
+    outFile.deleteFile();
+
+    std::unique_ptr<juce::FileOutputStream> outStream(outFile.createOutputStream());
+    if (outStream == nullptr) {
+        result.error = "Cannot write " + outFile.getFullPathName();
+        return result;
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    if (outFile.hasFileExtension("flac")) {
+        juce::FlacAudioFormat flac;
+        writer.reset(flac.createWriterFor(outStream.get(), sampleRate, 1, 24, {}, 0));
+    } else {
+        juce::WavAudioFormat wav;
+        writer.reset(wav.createWriterFor(outStream.get(), sampleRate, 1, 24, {}, 0));
+    }
+
+    if (writer == nullptr) {
+        result.error = "Cannot create writer for " + outFile.getFullPathName();
+        return result;
+    }
+
+    outStream.release();
+
+    // Offline render: the processor may take as long as it needs per block
+    processor.setNonRealtime(true);
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    // Run past the end by the reported latency so the output lines up with the input
+    const int latency = processor.getLatencySamples();
+    const int totalSamples = numSamples + latency;
+
+    juce::AudioBuffer<float> source(numChannels, blockSize);
+    juce::AudioBuffer<float> block(1, blockSize);
+    juce::MidiBuffer midi;
+
+    for (int pos = 0; pos < totalSamples; pos += blockSize) {
+        const int len = std::min(blockSize, totalSamples - pos);
+        const int fromSource = juce::jlimit(0, len, numSamples - pos);
+
+        block.setSize(1, len, false, false, true);
+        block.clear();
+
+        // The processor is mono; fold multichannel input down as it is read
+        if (fromSource > 0) {
+            reader->read(source.getArrayOfWritePointers(), numChannels, pos, fromSource);
+            for (int ch = 0; ch < numChannels; ch++)
+                block.addFrom(0, 0, source, ch, 0, fromSource, 1.0f / (float) numChannels);
+        }
+
+        processor.processBlock(block, midi);
+
+        // Drop the first `latency` output samples
+        const int outStart = pos - latency;
+        const int skip = std::max(0, -outStart);
+        const int toWrite = std::min(len - skip, numSamples - std::max(0, outStart));
+        if (toWrite > 0)
+            writer->writeFromAudioSampleBuffer(block, skip, toWrite);
+    }
+
+    processor.releaseResources();
+    writer.reset();
+
+    result.ok = true;
+    result.audioSeconds = (double) numSamples / sampleRate;
+    result.renderSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return result;
+}
+
+void collectInputs(const juce::File& path, juce::Array<juce::File>& inputs) {
+    if (path.isDirectory()) {
+        for (const auto& entry : juce::RangedDirectoryIterator(path, true, "*.wav;*.flac;*.aif;*.aiff"))
+            inputs.addIfNotAlreadyThere(entry.getFile());
+    } else if (path.existsAsFile()) {
+        inputs.addIfNotAlreadyThere(path);
+    }
+}
+
+/**
+ * Picks every input's output file before rendering starts. Workers run in
+ * parallel, so two inputs sharing an output (same file name in different
+ * folders, with --output) would overwrite each other; that is an error.
+ */
+bool assignOutputs(const juce::Array<juce::File>& inputs, const RenderSettings& settings,
+                   juce::Array<juce::File>& outputs, juce::String& error) {
+    // Compared case-insensitively, as the file system may be
+    std::map<juce::String, int> claimed;
+
+    for (int i = 0; i < inputs.size(); i++) {
+        const auto output = getOutputFile(inputs[i], settings);
+        const auto key = output.getFullPathName().toLowerCase();
+
+        const auto existing = claimed.find(key);
+        if (existing != claimed.end()) {
+            error = inputs[existing->second].getFullPathName() + " and " + inputs[i].getFullPathName()
+                  + " would both render to " + output.getFullPathName()
+                  + "; rename one or render them to separate folders";
+            return false;
+        }
+
+        claimed[key] = i;
+        outputs.add(output);
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    juce::ArgumentList args(argc, argv);
+    RenderSettings settings;
+    juce::Array<juce::File> inputs;
+
+    for (int i = 0; i < args.size(); i++) {
+        const auto arg = args[i].text;
+        const bool hasValue = i + 1 < args.size();
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else if (arg == "--output" && hasValue) {
+            settings.outputDir = args[++i].resolveAsFile();
+        } else if (arg == "--preset" && hasValue) {
+            juce::String error;
+            if (!loadPreset(args[++i].resolveAsFile(), settings.parameters, error)) {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+        } else if (arg == "--threads" && hasValue) {
+            settings.numThreads = args[++i].text.getIntValue();
+        } else if (arg == "--block" && hasValue) {
+            settings.blockSize = juce::jlimit(32, 8192, args[++i].text.getIntValue());
+        } else if (arg == "--key" && hasValue) {
+            settings.parameters.set("key", parseKey(args[++i].text));
+        } else if (arg.startsWith("--") && hasValue) {
+            const auto id = arg.substring(2);
+            bool known = false;
+            for (auto* presetId : presetParameterIds)
+                known = known || id == presetId;
+
+            if (!known) {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                printUsage();
+                return 1;
+            }
+
+            settings.parameters.set(id, args[++i].text.getFloatValue());
+        } else {
+            collectInputs(args[i].resolveAsFile(), inputs);
+        }
+    }
+
+    if (inputs.isEmpty()) {
+        printUsage();
+        return 1;
+    }
+
+    juce::Array<juce::File> outputs;
+    juce::String outputError;
+    if (!assignOutputs(inputs, settings, outputs, outputError)) {
+        std::cerr << outputError << std::endl;
+        return 1;
+    }
+
+    if (settings.outputDir != juce::File())
+        settings.outputDir.createDirectory();
+
+    const int numThreads = juce::jlimit(1, inputs.size(),
+        settings.numThreads > 0 ? settings.numThreads : juce::SystemStats::getNumCpus());
+
+    // Processors are created up front on the main thread (the parameter tree
+    // wants the message manager); each worker then owns one for every file it takes.
+    std::vector<std::unique_ptr<VocalSuiteAudioProcessor>> processors;
+    for (int t = 0; t < numThreads; t++) {
+        auto processor = std::make_unique<VocalSuiteAudioProcessor>();
+        applyParameters(*processor, settings.parameters);
+        processors.push_back(std::move(processor));
+    }
+
+    std::vector<FileResult> results((size_t) inputs.size());
+    std::atomic<int> nextInput { 0 };
+
+    const auto wallStart = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; t++) {
+        workers.emplace_back([&, t] {
+            juce::AudioFormatManager formats;
+            formats.registerBasicFormats();
+
+            for (int index = nextInput++; index < inputs.size(); index = nextInput++)
+                results[(size_t) index] = renderFile(*processors[(size_t) t], formats,
+                                                     inputs[index], outputs[index], settings);
+        });
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+
+    const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    double totalAudio = 0.0;
+    double totalRender = 0.0;
+    int failures = 0;
+
+    for (const auto& result : results) {
+        if (result.ok) {
+            totalAudio += result.audioSeconds;
+            totalRender += result.renderSeconds;
+            std::cout << result.input.getFileName() << ": "
+                      << juce::String(result.audioSeconds, 2) << " s audio in "
+                      << juce::String(result.renderSeconds, 2) << " s ("
+                      << juce::String(result.audioSeconds / juce::jmax(1.0e-9, result.renderSeconds), 1)
+                      << "x realtime)" << std::endl;
+        } else {
+            failures++;
+            std::cerr << result.input.getFileName() << ": FAILED - " << result.error << std::endl;
+        }
+    }
+
+    std::cout << "\nRendered " << (results.size() - (size_t) failures) << "/" << results.size()
+              << " files, " << juce::String(totalAudio, 1) << " s of audio in "
+              << juce::String(wallSeconds, 2) << " s on " << numThreads << " thread(s)\n"
+              << "Throughput: " << juce::String(totalAudio / juce::jmax(1.0e-9, totalRender), 1)
+              << "x realtime per core, "
+              << juce::String(totalAudio / juce::jmax(1.0e-9, wallSeconds), 1)
+              << "x realtime overall" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
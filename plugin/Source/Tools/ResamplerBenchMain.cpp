@@ -0,0 +1,270 @@
+/**
+ * VocalSuiteResamplerBench - checks the Resampler's quality and times it.
+ *
+ * For each host/model rate pair the plugin converts between (or one pair given
+ * with --in and --out) it reports:
+ *   - THD+N of pure tones inside the passband: what remains after removing the
+ *     best-fitting sine at the tone's frequency, relative to that sine
+ *   - alias rejection when downsampling: the output level of tones above the
+ *     output Nyquist frequency, which the filter should remove
+ *   - throughput of the streaming path (process() in host-sized blocks, then
+ *     flush()), as a multiple of real time on one core
+ *
+ *   VocalSuiteResamplerBench [options]
+ *
+ * Exits with 1 if any pair misses the THD+N or alias rejection limit.
+ */
+
+#include <juce_core/juce_core.h>
+#include "../DSP/Resampler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+struct BenchSettings {
+    double inputRate = 0.0;      // 0 = every common pair
+    double outputRate = 0.0;
+    double seconds = 5.0;        // Test signal length
+    int blockSize = 512;         // Streaming block, as a host would call it
+    double maxThdNDb = -80.0;    // Highest allowed THD+N
+    double minRejectionDb = 80.0; // Lowest allowed alias rejection
+};
+
+void printUsage() {
+    std::cout
+        << "Usage: VocalSuiteResamplerBench [options]\n"
+        << "\n"
+        << "Options:\n"
+        << "  --in <hz> --out <hz>  Measure only this rate pair (default: every common pair)\n"
+        << "  --seconds <s>         Test signal length (default: 5)\n"
+        << "  --block <n>           Streaming block size (default: 512)\n"
+        << "  --max-thdn <db>       Highest allowed THD+N (default: -80)\n"
+        << "  --min-rejection <db>  Lowest allowed alias rejection (default: 80)\n";
+}
+
+// The rates Resampler::precomputeCommonTables() prepares, in both directions
+std::vector<std::pair<double, double>> commonRatePairs() {
+    const double hostRates[] = { 44100.0, 48000.0, 88200.0, 96000.0 };
+    const double modelRates[] = { 16000.0, 32000.0, 40000.0, 44100.0, 48000.0 };
+
+    std::vector<std::pair<double, double>> pairs;
+    for (double hostRate : hostRates) {
+        for (double modelRate : modelRates) {
+            // 44.1 and 48 kHz are both host and model rates; list that pair once
+            if (hostRate != modelRate && std::find(pairs.begin(), pairs.end(), std::make_pair(modelRate, hostRate)) == pairs.end()) {
+                pairs.push_back({ hostRate, modelRate });
+                pairs.push_back({ modelRate, hostRate });
+            }
+        }
+    }
+    return pairs;
+}
+
+std::vector<float> makeSine(double frequency, double sampleRate, int numSamples) {
+    std::vector<float> signal((size_t)numSamples);
+    for (int i = 0; i < numSamples; i++) {
+        signal[(size_t)i] = 0.5f * (float)std::sin(juce::MathConstants<double>::twoPi * frequency * i / sampleRate);
+    }
+    return signal;
+}
+
+double toDb(double powerRatio) {
+    return 10.0 * std::log10(juce::jmax(1.0e-30, powerRatio));
+}
+
+// Output samples at each end where the filter still overlaps the signal's edges
+int settleSamples(const std::vector<float>& output) {
+    return (int)output.size() / 10;
+}
+
+/**
+ * Least-squares fit of a sine and cosine at the tone's frequency over the
+ * settled part of the output; returns residual power over fitted power in dB.
+ */
+double measureThdN(const std::vector<float>& output, double frequency, double sampleRate) {
+    const int start = settleSamples(output);
+    const int end = (int)output.size() - start;
+    const double omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+
+    double ss = 0.0, sc = 0.0, cc = 0.0, ys = 0.0, yc = 0.0;
+    for (int i = start; i < end; i++) {
+        const double s = std::sin(omega * i), c = std::cos(omega * i), y = output[(size_t)i];
+        ss += s * s;
+        sc += s * c;
+        cc += c * c;
+        ys += y * s;
+        yc += y * c;
+    }
+
+    const double determinant = ss * cc - sc * sc;
+    const double a = (ys * cc - yc * sc) / determinant;
+    const double b = (yc * ss - ys * sc) / determinant;
+
+    double signalPower = 0.0, residualPower = 0.0;
+    for (int i = start; i < end; i++) {
+        const double fit = a * std::sin(omega * i) + b * std::cos(omega * i);
+        const double residual = output[(size_t)i] - fit;
+        signalPower += fit * fit;
+        residualPower += residual * residual;
+    }
+
+    return toDb(residualPower / juce::jmax(1.0e-30, signalPower));
+}
+
+// Input tone power over what is left of it in the settled output, in dB
+double measureRejection(const std::vector<float>& input, const std::vector<float>& output) {
+    double inputPower = 0.0;
+    for (float sample : input) {
+        inputPower += (double)sample * sample;
+    }
+    inputPower /= (double)input.size();
+
+    const int start = settleSamples(output);
+    const int end = (int)output.size() - start;
+    double outputPower = 0.0;
+    for (int i = start; i < end; i++) {
+        outputPower += (double)output[(size_t)i] * output[(size_t)i];
+    }
+    outputPower /= (double)juce::jmax(1, end - start);
+
+    return -toDb(outputPower / inputPower);
+}
+
+struct PairResult {
+    double thdNDb = 0.0;       // Worst of the passband tones
+    double rejectionDb = 0.0;  // Worst of the stopband tones; only when downsampling
+    bool downsampling = false;
+    double realtimeFactor = 0.0;
+};
+
+/** Streaming run over the whole input; returns seconds of input per second of processing. */
+double measureThroughput(const std::vector<float>& input, double inputRate, double outputRate, int blockSize) {
+    blink::Resampler resampler;
+    resampler.prepare(inputRate, outputRate, blockSize);
+    std::vector<float> output((size_t)resampler.getMaxOutputSamples(blockSize) + resampler.getLookaheadSamples() + 1);
+    const int numInput = (int)input.size();
+    const int capacity = (int)output.size();
+
+    auto run = [&] {
+        resampler.reset();
+        for (int pos = 0; pos < numInput; pos += blockSize) {
+            resampler.process(input.data() + pos, juce::jmin(blockSize, numInput - pos), output.data(), capacity);
+        }
+        resampler.flush(output.data(), capacity);
+    };
+
+    run(); // Warm up caches
+
+    const auto start = std::chrono::steady_clock::now();
+    run();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return (numInput / inputRate) / juce::jmax(1.0e-9, seconds);
+}
+
+PairResult measurePair(double inputRate, double outputRate, const BenchSettings& settings) {
+    PairResult result;
+    const int numInput = (int)(settings.seconds * inputRate);
+    const double outputNyquist = outputRate / 2.0;
+    const double lowerNyquist = juce::jmin(inputRate, outputRate) / 2.0;
+
+    // A low tone, and one near the top of the passband (which ends at 88% of the lower Nyquist)
+    result.thdNDb = -1000.0;
+    for (double frequency : { 1000.0, 0.8 * lowerNyquist }) {
+        const auto input = makeSine(frequency, inputRate, numInput);
+        const auto output = blink::Resampler::resample(input.data(), numInput, inputRate, outputRate);
+        result.thdNDb = juce::jmax(result.thdNDb, measureThdN(output, frequency, outputRate));
+    }
+
+    // Tones just past the output Nyquist, where the stopband starts, and well past it
+    result.downsampling = outputRate < inputRate;
+    if (result.downsampling) {
+        result.rejectionDb = 1000.0;
+        const double inputLimit = 0.95 * inputRate / 2.0;
+        for (double frequency : { juce::jmin(1.1 * outputNyquist, inputLimit), juce::jmin(1.5 * outputNyquist, inputLimit) }) {
+            const auto input = makeSine(frequency, inputRate, numInput);
+            const auto output = blink::Resampler::resample(input.data(), numInput, inputRate, outputRate);
+            result.rejectionDb = juce::jmin(result.rejectionDb, measureRejection(input, output));
+        }
+    }
+
+    const auto voiceBand = makeSine(220.0, inputRate, numInput);
+    result.realtimeFactor = measureThroughput(voiceBand, inputRate, outputRate, settings.blockSize);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    juce::ArgumentList args(argc, argv);
+    BenchSettings settings;
+
+    for (int i = 0; i < args.size(); i++) {
+        const auto arg = args[i].text;
+        const bool hasValue = i + 1 < args.size();
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else if (arg == "--in" && hasValue) {
+            settings.inputRate = juce::jlimit(8000.0, 192000.0, args[++i].text.getDoubleValue());
+        } else if (arg == "--out" && hasValue) {
+            settings.outputRate = juce::jlimit(8000.0, 192000.0, args[++i].text.getDoubleValue());
+        } else if (arg == "--seconds" && hasValue) {
+            settings.seconds = juce::jlimit(0.5, 600.0, args[++i].text.getDoubleValue());
+        } else if (arg == "--block" && hasValue) {
+            settings.blockSize = juce::jlimit(16, 65536, args[++i].text.getIntValue());
+        } else if (arg == "--max-thdn" && hasValue) {
+            settings.maxThdNDb = args[++i].text.getDoubleValue();
+        } else if (arg == "--min-rejection" && hasValue) {
+            settings.minRejectionDb = args[++i].text.getDoubleValue();
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    if ((settings.inputRate > 0.0) != (settings.outputRate > 0.0)) {
+        std::cerr << "--in and --out must be given together" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::pair<double, double>> pairs;
+    if (settings.inputRate > 0.0) {
+        pairs.push_back({ settings.inputRate, settings.outputRate });
+    } else {
+        pairs = commonRatePairs();
+    }
+
+    std::cout << "THD+N of passband tones, alias rejection past the output Nyquist, streaming in "
+              << settings.blockSize << "-sample blocks\n\n"
+              << "   input ->  output     THD+N    rejection    speed\n";
+
+    int failures = 0;
+    for (const auto& pair : pairs) {
+        const auto result = measurePair(pair.first, pair.second, settings);
+        const bool thdNFailed = result.thdNDb > settings.maxThdNDb;
+        const bool rejectionFailed = result.downsampling && result.rejectionDb < settings.minRejectionDb;
+        failures += (thdNFailed || rejectionFailed) ? 1 : 0;
+
+        std::cout << juce::String(pair.first, 0).paddedLeft(' ', 8) << " -> "
+                  << juce::String(pair.second, 0).paddedLeft(' ', 7)
+                  << juce::String(result.thdNDb, 1).paddedLeft(' ', 8) << " dB"
+                  << (result.downsampling ? juce::String(result.rejectionDb, 1).paddedLeft(' ', 9) + " dB"
+                                          : juce::String("-").paddedLeft(' ', 12))
+                  << juce::String(result.realtimeFactor, 0).paddedLeft(' ', 8) << "x real time"
+                  << (thdNFailed || rejectionFailed ? "  FAIL" : "") << std::endl;
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " rate pair" << (failures == 1 ? "" : "s") << " outside the limits (THD+N "
+                  << settings.maxThdNDb << " dB, rejection " << settings.minRejectionDb << " dB)" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,194 @@
+/**
+ * VocalSuiteRtStress - drives processBlock under the real-time safety checks.
+ *
+ * Runs VocalSuiteAudioProcessor on its own audio thread with a synthetic voice,
+ * varying block sizes like a host does, while the message thread automates every
+ * parameter and (with --model) loads a voice model part way through, so the AI
+ * path is built and swapped in under load. Each allocation or mutex lock inside
+ * processBlock is reported by blink::RealtimeSafety.
+ *
+ *   VocalSuiteRtStress [options]
+ *
+ * Exits with 1 if any violation was seen. Only meaningful when built with
+ * -DVOCALSUITE_RT_SAFETY_CHECKS=ON.
+ */
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "../PluginProcessor.h"
+#include "../Core/RealtimeSafety.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+struct StressSettings {
+    int numBlocks = 20000;
+    double sampleRate = 48000.0;
+    int maxBlockSize = 512;
+    bool varyBlockSize = true;
+    juce::String modelId;  // Empty = no model, pitch chain only
+    bool abortOnViolation = false;
+};
+
+void printUsage() {
+    std::cout
+        << "Usage: VocalSuiteRtStress [options]\n"
+        << "\n"
+        << "Options:\n"
+        << "  --blocks <n>          Blocks to process (default: 20000)\n"
+        << "  --rate <hz>           Sample rate passed to prepareToPlay (default: 48000)\n"
+        << "  --block <n>           Maximum block size (default: 512)\n"
+        << "  --fixed               Always use the maximum block size\n"
+        << "  --model <id>          Load this ONNX voice model a quarter of the way through\n"
+        << "  --abort               Abort with a stack trace on the first violation\n";
+}
+
+const char* const automatedParameterIds[] = {
+    "correction", "speed", "pitch", "key", "scale", "formant", "breath", "resonance", "blend"
+};
+
+// Message-thread side: parameter automation, and the model load once the audio
+// thread is a quarter of the way in
+class MessageThreadLoad : private juce::Timer {
+public:
+    MessageThreadLoad(VocalSuiteAudioProcessor& p, const StressSettings& s, const std::atomic<int>& done)
+        : processor(p), settings(s), blocksDone(done) {
+        startTimer(5);
+    }
+
+    ~MessageThreadLoad() override { stopTimer(); }
+
+private:
+    void timerCallback() override {
+        for (auto* id : automatedParameterIds)
+            if (auto* param = processor.parameters.getParameter(id))
+                param->setValueNotifyingHost(random.nextFloat());
+
+        if (!modelRequested && settings.modelId.isNotEmpty() && blocksDone.load() >= settings.numBlocks / 4) {
+            modelRequested = true;
+            std::cout << "Loading model " << settings.modelId << " at block " << blocksDone.load() << std::endl;
+            processor.loadVoiceModel(settings.modelId.toStdString(), "onnx");
+        }
+    }
+
+    VocalSuiteAudioProcessor& processor;
+    const StressSettings& settings;
+    const std::atomic<int>& blocksDone;
+    juce::Random random;
+    bool modelRequested = false;
+};
+
+// Sawtooth voice with vibrato and breath noise, written in place (no allocation)
+struct SyntheticVoice {
+    double sampleRate;
+    double phase = 0.0;
+    double vibratoPhase = 0.0;
+    juce::Random random;
+
+    void render(float* out, int numSamples) {
+        for (int i = 0; i < numSamples; i++) {
+            const double frequency = 220.0 * std::pow(2.0, 0.3 * std::sin(vibratoPhase) / 12.0);
+            vibratoPhase += juce::MathConstants<double>::twoPi * 5.5 / sampleRate;
+            phase += frequency / sampleRate;
+            phase -= std::floor(phase);
+
+            out[i] = 0.3f * (float) (2.0 * phase - 1.0) + 0.01f * (random.nextFloat() - 0.5f);
+        }
+    }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    juce::ArgumentList args(argc, argv);
+    StressSettings settings;
+
+    for (int i = 0; i < args.size(); i++) {
+        const auto arg = args[i].text;
+        const bool hasValue = i + 1 < args.size();
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else if (arg == "--blocks" && hasValue) {
+            settings.numBlocks = juce::jmax(1, args[++i].text.getIntValue());
+        } else if (arg == "--rate" && hasValue) {
+            settings.sampleRate = juce::jlimit(8000.0, 192000.0, args[++i].text.getDoubleValue());
+        } else if (arg == "--block" && hasValue) {
+            settings.maxBlockSize = juce::jlimit(16, 8192, args[++i].text.getIntValue());
+        } else if (arg == "--fixed") {
+            settings.varyBlockSize = false;
+        } else if (arg == "--model" && hasValue) {
+            settings.modelId = args[++i].text;
+        } else if (arg == "--abort") {
+            settings.abortOnViolation = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+   #if ! VOCALSUITE_RT_SAFETY_CHECKS
+    std::cerr << "Built without VOCALSUITE_RT_SAFETY_CHECKS: violations cannot be detected. "
+              << "Reconfigure with -DVOCALSUITE_RT_SAFETY_CHECKS=ON." << std::endl;
+    return 1;
+   #endif
+
+    blink::RealtimeSafety::setMode(settings.abortOnViolation ? blink::RealtimeSafety::Mode::Abort
+                                                             : blink::RealtimeSafety::Mode::Report);
+
+    VocalSuiteAudioProcessor processor;
+    processor.prepareToPlay(settings.sampleRate, settings.maxBlockSize);
+
+    std::atomic<int> blocksDone { 0 };
+    MessageThreadLoad messageThreadLoad(processor, settings, blocksDone);
+
+    // Only what processBlock does is checked; the harness sets up outside the scope
+    blink::RealtimeSafety::resetViolationCount();
+
+    int64_t samplesProcessed = 0;
+    double processSeconds = 0.0;
+
+    std::thread audioThread([&] {
+        juce::AudioBuffer<float> block(1, settings.maxBlockSize);
+        juce::MidiBuffer midi;
+        SyntheticVoice voice { settings.sampleRate };
+        juce::Random random;
+
+        for (int i = 0; i < settings.numBlocks; i++) {
+            const int numSamples = settings.varyBlockSize ? 1 + random.nextInt(settings.maxBlockSize)
+                                                          : settings.maxBlockSize;
+
+            block.setSize(1, numSamples, false, false, true);
+            voice.render(block.getWritePointer(0), numSamples);
+
+            const auto start = std::chrono::steady_clock::now();
+            processor.processBlock(block, midi);
+            processSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            samplesProcessed += numSamples;
+            blocksDone.store(i + 1);
+        }
+
+        juce::MessageManager::callAsync([] { juce::MessageManager::getInstance()->stopDispatchLoop(); });
+    });
+
+    juce::MessageManager::getInstance()->runDispatchLoop();
+    audioThread.join();
+
+    const int violations = blink::RealtimeSafety::getViolationCount();
+    const double audioSeconds = (double) samplesProcessed / settings.sampleRate;
+
+    std::cout << settings.numBlocks << " blocks (" << juce::String(audioSeconds, 1) << " s of audio at "
+              << settings.sampleRate << " Hz) in " << juce::String(processSeconds, 2) << " s of processBlock, "
+              << violations << " real-time violation" << (violations == 1 ? "" : "s") << std::endl;
+
+    return violations == 0 ? 0 : 1;
+}
@@ -24,7 +24,7 @@ import {
 } from "../ui/dialog";
 import { audioEngine } from '../../lib/AudioEngine';
 import { PresetManager, Preset } from '../../lib/Presets';
-import { juceBridge } from '../../lib/juce-bridge';
+import { juceBridge, type QualityStatus } from '../../lib/juce-bridge';
 import { fishAudio, VoiceModel } from '../../lib/fish-audio';
 import { VoiceSettings } from './VoiceSettings';
 
@@ -67,8 +67,9 @@ export const SwindlVX: React.FC = () => {
   const [isCloning, setIsCloning] = useState(false);
   const [clonedVoices, setClonedVoices] = useState<{id: string, name: string}[]>([]);
   const [fishVoices, setFishVoices] = useState<VoiceModel[]>([]);
-  const [localOnnxModels, setLocalOnnxModels] = useState<{id: string, name: string}[]>([]);
+  const [localOnnxModels, setLocalOnnxModels] = useState<{id: string, name: string, problem?: string}[]>([]);
   const [showVoiceSettings, setShowVoiceSettings] = useState(false);
+  const [qualityStatus, setQualityStatus] = useState<QualityStatus | null>(null);
   
   // Preset States
   const [presets, setPresets] = useState<Preset[]>([]);
@@ -77,6 +78,51 @@ export const SwindlVX: React.FC = () => {
   const [isSavingPreset, setIsSavingPreset] = useState(false);
 
   // Sync parameters to C++ backend
+  // Render jobs (capture saves, conversions) report progress from the plugin
+  useEffect(() => {
+    return juceBridge.onRenderProgress((update) => {
+      const toastId = `render-${update.id}`;
+
+      if (update.state === 'queued') {
+        toast.loading(update.name, {
+          id: toastId,
+          description: 'Queued',
+          action: { label: 'Cancel', onClick: () => juceBridge.cancelRender(update.id) }
+        });
+      } else if (update.state === 'running') {
+        toast.loading(update.name, {
+          id: toastId,
+          description: `${Math.round(update.progress * 100)}%`,
+          action: { label: 'Cancel', onClick: () => juceBridge.cancelRender(update.id) }
+        });
+      } else if (update.state === 'finished') {
+        toast.success(update.name, { id: toastId, description: update.message || 'Done', action: undefined });
+      } else if (update.state === 'failed') {
+        toast.error(update.name, { id: toastId, description: update.message || 'Failed', action: undefined });
+      } else {
+        toast.dismiss(toastId);
+      }
+    });
+  }, []);
+
+  // Load and quality tier of the real-time chain
+  useEffect(() => {
+    return juceBridge.onQualityStatus(setQualityStatus);
+  }, []);
+
+  // Models in Documents/VocalSuitePro/Models, from the plugin's catalog
+  useEffect(() => {
+    const unsubscribe = juceBridge.onModelCatalog((models) => {
+      setLocalOnnxModels(models.map(m => ({
+        id: m.file,
+        name: `${m.id} (.${m.format})${m.sampleRate ? ` · ${m.sampleRate / 1000} kHz` : ''}`,
+        problem: m.valid ? undefined : m.problem
+      })));
+    });
+    juceBridge.listModels();
+    return unsubscribe;
+  }, []);
+
   useEffect(() => {
     juceBridge.sendParameterChange('correction', pitchCorrection / 100);
   }, [pitchCorrection]);
@@ -535,6 +581,14 @@ export const SwindlVX: React.FC = () => {
                 <span className="text-[10px] font-bold text-accent tracking-widest uppercase">Processing</span>
               </div>
               <span className="text-[12px] font-mono text-white/60 uppercase">{pitchKey} {pitchScale}</span>
+              {qualityStatus && qualityStatus.tier > 0 && (
+                <span
+                  className="text-[10px] font-mono text-amber-400/80 uppercase"
+                  title={`CPU load ${Math.round(qualityStatus.load * 100)}% of the block deadline`}
+                >
+                  Reduced quality: {qualityStatus.tierName}
+                </span>
+              )}
             </div>
           </>
         ) : (
@@ -656,7 +710,9 @@ export const SwindlVX: React.FC = () => {
                   <SelectItem value="custom_model_a">Custom Model A (.pth)</SelectItem>
                   <SelectItem value="custom_model_b">Custom Model B (.pth)</SelectItem>
                   {localOnnxModels.map(m => (
-                    <SelectItem key={m.id} value={m.id}>{m.name}</SelectItem>
+                    <SelectItem key={m.id} value={m.id} disabled={!!m.problem}>
+                      {m.problem ? `${m.name} — ${m.problem}` : m.name}
+                    </SelectItem>
                   ))}
                   
                   {fishVoices.length > 0 && (
@@ -701,9 +757,6 @@ export const SwindlVX: React.FC = () => {
               <Button 
                 onClick={() => {
                   juceBridge.convertAudio(voiceModel, pitchShift, formant / 100);
-                  toast.success('Conversion started', {
-                    description: `Model: ${voiceModel}`
-                  });
                 }}
                 disabled={voiceModel === 'none'}
                 className="h-10 text-[10px] uppercase font-black tracking-widest gap-2 bg-accent/20 hover:bg-accent/30 border border-accent/30"
@@ -711,6 +764,17 @@ export const SwindlVX: React.FC = () => {
                 <FileAudio size={14} className="text-accent" />
                 Convert
               </Button>
+
+              <Button 
+                onClick={() => {
+                  juceBridge.convertFiles(voiceModel, pitchShift, formant / 100);
+                }}
+                disabled={voiceModel === 'none'}
+                className="h-10 text-[10px] uppercase font-black tracking-widest gap-2 bg-accent/20 hover:bg-accent/30 border border-accent/30"
+              >
+                <FolderOpen size={14} className="text-accent" />
+                Batch
+              </Button>
               
               <Dialog>
                 <DialogTrigger asChild>
@@ -1,5 +1,40 @@
 type ParameterChangeCallback = (name: string, value: number) => void;
 
+export type RenderState = 'queued' | 'running' | 'finished' | 'failed' | 'cancelled';
+
+export interface RenderProgress {
+  id: number;
+  name: string;
+  state: RenderState;
+  progress: number;
+  message: string;
+}
+
+type RenderProgressCallback = (update: RenderProgress) => void;
+
+export interface CatalogModel {
+  id: string;
+  file: string;
+  format: 'onnx' | 'pth';
+  sampleRate: number;
+  melBands: number;
+  size: number;
+  variants: string[];
+  valid: boolean;
+  problem: string;
+}
+
+type ModelCatalogCallback = (models: CatalogModel[]) => void;
+
+export interface QualityStatus {
+  tier: number;      // 0 = full quality; higher tiers shed more DSP work
+  tierName: string;
+  load: number;      // 95th percentile block time, as a fraction of the deadline
+  overruns: number;  // Blocks that missed their deadline since playback started
+}
+
+type QualityStatusCallback = (status: QualityStatus) => void;
+
 class JUCEBridge {
   private listeners: Set<ParameterChangeCallback> = new Set();
 
@@ -34,6 +69,19 @@ class JUCEBridge {
     }
   }
 
+  /** Convert many files with one model; without paths the plugin opens a file picker. */
+  convertFiles(model: string, pitchShift: number, formantShift: number, paths: string[] = []) {
+    if (typeof window !== 'undefined' && (window as any).__JUCE__) {
+      (window as any).__JUCE__.backend.emitEvent('convertFiles', {
+        type: 'convertFiles',
+        model,
+        pitchShift,
+        formantShift,
+        paths
+      });
+    }
+  }
+
   startCapture() {
     if (typeof window !== 'undefined' && (window as any).__JUCE__) {
       (window as any).__JUCE__.backend.emitEvent('startCapture', {
@@ -50,6 +98,53 @@ class JUCEBridge {
     }
   }
 
+  cancelRender(jobId: number) {
+    if (typeof window !== 'undefined' && (window as any).__JUCE__) {
+      (window as any).__JUCE__.backend.emitEvent('cancelRender', {
+        type: 'cancelRender',
+        jobId
+      });
+    }
+  }
+
+  onRenderProgress(callback: RenderProgressCallback) {
+    if (typeof window === 'undefined' || !(window as any).__JUCE__) {
+      return () => {};
+    }
+
+    const backend = (window as any).__JUCE__.backend;
+    const token = backend.addEventListener('renderProgress', callback);
+    return () => backend.removeEventListener(token);
+  }
+
+  listModels() {
+    if (typeof window !== 'undefined' && (window as any).__JUCE__) {
+      (window as any).__JUCE__.backend.emitEvent('listModels', {
+        type: 'listModels'
+      });
+    }
+  }
+
+  onModelCatalog(callback: ModelCatalogCallback) {
+    if (typeof window === 'undefined' || !(window as any).__JUCE__) {
+      return () => {};
+    }
+
+    const backend = (window as any).__JUCE__.backend;
+    const token = backend.addEventListener('modelCatalog', callback);
+    return () => backend.removeEventListener(token);
+  }
+
+  onQualityStatus(callback: QualityStatusCallback) {
+    if (typeof window === 'undefined' || !(window as any).__JUCE__) {
+      return () => {};
+    }
+
+    const backend = (window as any).__JUCE__.backend;
+    const token = backend.addEventListener('qualityStatus', callback);
+    return () => backend.removeEventListener(token);
+  }
+
   onParameterChange(callback: ParameterChangeCallback) {
     this.listeners.add(callback);
     return () => this.listeners.delete(callback);